@@ -1,4 +1,5 @@
 #include <GraphicsExplorer/GraphicsExplorer.h>
+#include <SampleShared/SampleInput.h>
 
 #include <Foundation/Communication/Telemetry.h>
 #include <Foundation/Configuration/Startup.h>
@@ -38,6 +39,8 @@ xiiVec3U32 GetMipLevelSize(xiiUInt32 uiMipLevelSize, const xiiGALTextureCreation
   return size;
 }
 
+static xiiSampleInput<xiiSampleCameraAction::Count> g_Input("Main", g_SampleCameraActions);
+
 class xiiGraphicsExplorerWindow : public xiiWindow
 {
 public:
@@ -78,7 +81,8 @@ xiiApplication::Execution xiiGraphicsExplorerWindowApp::Run()
     UpdateSwapChain();
   }
 
-  if (m_pWindow->m_bCloseRequested || xiiInputManager::GetInputActionState("Main", "CloseApp") == xiiKeyState::Pressed)
+  // The states are from the last frame, since the input is only updated below
+  if (m_pWindow->m_bCloseRequested || g_Input.GetState(xiiSampleCameraAction::CloseApp) == xiiKeyState::Pressed)
     return Execution::Quit;
 
   // Make sure time goes on
@@ -86,26 +90,22 @@ xiiApplication::Execution xiiGraphicsExplorerWindowApp::Run()
 
   // Update all input state
   xiiInputManager::Update(xiiClock::GetGlobalClock()->GetTimeDiff());
+  g_Input.BeginFrame();
 
   // Engage mouse look
-  if (xiiInputManager::GetInputActionState("Main", "Look") == xiiKeyState::Down)
+  if (g_Input.GetState(xiiSampleCameraAction::Look) == xiiKeyState::Down)
   {
     m_pWindow->GetInputDevice()->SetShowMouseCursor(false);
     m_pWindow->GetInputDevice()->SetClipMouseCursor(xiiMouseCursorClipMode::ClipToPosition);
 
-    float       fInputValue = 0.0f;
     const float fMouseSpeed = 0.01f;
 
     xiiVec3 mouseMotion(0.0f);
 
-    if (xiiInputManager::GetInputActionState("Main", "LookPosX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x += fInputValue * fMouseSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "LookNegX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x -= fInputValue * fMouseSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "LookPosY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y -= fInputValue * fMouseSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "LookNegY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y += fInputValue * fMouseSpeed;
+    mouseMotion.x += g_Input.GetValue(xiiSampleCameraAction::LookPosX) * fMouseSpeed;
+    mouseMotion.x -= g_Input.GetValue(xiiSampleCameraAction::LookNegX) * fMouseSpeed;
+    mouseMotion.y -= g_Input.GetValue(xiiSampleCameraAction::LookPosY) * fMouseSpeed;
+    mouseMotion.y += g_Input.GetValue(xiiSampleCameraAction::LookNegY) * fMouseSpeed;
   }
   else
   {
@@ -115,34 +115,24 @@ xiiApplication::Execution xiiGraphicsExplorerWindowApp::Run()
 
   // Turn camera with arrow keys
   {
-    float       fInputValue = 0.0f;
-    const float fTurnSpeed  = 1.0f;
+    const float fTurnSpeed = 1.0f;
 
     xiiVec3 mouseMotion(0.0f);
 
-    if (xiiInputManager::GetInputActionState("Main", "TurnPosX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x += fInputValue * fTurnSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "TurnNegX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x -= fInputValue * fTurnSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "TurnPosY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y += fInputValue * fTurnSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "TurnNegY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y -= fInputValue * fTurnSpeed;
+    mouseMotion.x += g_Input.GetValue(xiiSampleCameraAction::TurnPosX) * fTurnSpeed;
+    mouseMotion.x -= g_Input.GetValue(xiiSampleCameraAction::TurnNegX) * fTurnSpeed;
+    mouseMotion.y += g_Input.GetValue(xiiSampleCameraAction::TurnPosY) * fTurnSpeed;
+    mouseMotion.y -= g_Input.GetValue(xiiSampleCameraAction::TurnNegY) * fTurnSpeed;
   }
 
   // Apply translation
   {
-    float   fInputValue = 0.0f;
     xiiVec3 cameraMotion(0.0f);
 
-    if (xiiInputManager::GetInputActionState("Main", "MovePosX", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.x += fInputValue;
-    if (xiiInputManager::GetInputActionState("Main", "MoveNegX", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.x -= fInputValue;
-    if (xiiInputManager::GetInputActionState("Main", "MovePosY", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.y += fInputValue;
-    if (xiiInputManager::GetInputActionState("Main", "MoveNegY", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.y -= fInputValue;
+    cameraMotion.x += g_Input.GetValue(xiiSampleCameraAction::MovePosX);
+    cameraMotion.x -= g_Input.GetValue(xiiSampleCameraAction::MoveNegX);
+    cameraMotion.y += g_Input.GetValue(xiiSampleCameraAction::MovePosY);
+    cameraMotion.y -= g_Input.GetValue(xiiSampleCameraAction::MoveNegY);
   }
 
   // Perform rendering.
@@ -219,79 +209,7 @@ void xiiGraphicsExplorerWindowApp::AfterCoreSystemsStartup()
   xiiPlugin::LoadPlugin("xiiInspectorPlugin").IgnoreResult();
 #endif
 
-  // Register Input
-  {
-    xiiInputActionConfig cfg;
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "CloseApp");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyEscape;
-    xiiInputManager::SetInputActionConfig("Main", "CloseApp", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookPosX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMovePosX;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookPosX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookNegX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMoveNegX;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookNegX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookPosY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMovePosY;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookPosY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookNegY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMoveNegY;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookNegY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnPosX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyRight;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnPosX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnNegX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyLeft;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnNegX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnPosY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyDown;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnPosY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnNegY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyUp;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnNegY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "Look");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseButton0;
-    cfg.m_bApplyTimeScaling    = false;
-    xiiInputManager::SetInputActionConfig("Main", "Look", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MovePosX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyD;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MovePosX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MoveNegX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyA;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MoveNegX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MovePosY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyW;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MovePosY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MoveNegY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyS;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MoveNegY", cfg, true);
-  }
+  g_Input.RegisterActions();
 
   // Create a window for rendering
   {
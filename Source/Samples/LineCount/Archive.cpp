@@ -0,0 +1,521 @@
+#include <LineCount/Archive.h>
+
+namespace
+{
+  constexpr xiiUInt32 s_uiZipLocalSignature     = 0x04034B50;
+  constexpr xiiUInt32 s_uiZipCentralSignature   = 0x02014B50;
+  constexpr xiiUInt32 s_uiZipEndSignature       = 0x06054B50;
+  constexpr xiiUInt32 s_uiZip64EndSignature     = 0x06064B50;
+  constexpr xiiUInt32 s_uiZip64LocatorSignature = 0x07064B50;
+  constexpr xiiUInt32 s_uiZipLocalHeaderSize    = 30;
+  constexpr xiiUInt32 s_uiZipCentralHeaderSize  = 46;
+  constexpr xiiUInt32 s_uiZipEndSize            = 22;
+  constexpr xiiUInt32 s_uiZip64EndSize          = 56;
+  constexpr xiiUInt32 s_uiZip64LocatorSize      = 20;
+  constexpr xiiUInt32 s_uiTarBlockSize          = 512;
+  constexpr xiiUInt64 s_uiMaxTarMetadataSize    = 1024 * 1024;
+  constexpr xiiUInt64 s_uiInvalidSize           = 0xFFFFFFFFFFFFFFFFull;
+
+  // All numbers in zip archives are little-endian
+  xiiUInt32 ReadUInt16(const xiiUInt8* pData)
+  {
+    return pData[0] | (pData[1] << 8);
+  }
+
+  xiiUInt32 ReadUInt32(const xiiUInt8* pData)
+  {
+    return pData[0] | (pData[1] << 8) | (pData[2] << 16) | (static_cast<xiiUInt32>(pData[3]) << 24);
+  }
+
+  xiiUInt64 ReadUInt64(const xiiUInt8* pData)
+  {
+    return ReadUInt32(pData) | (static_cast<xiiUInt64>(ReadUInt32(pData + 4)) << 32);
+  }
+
+  // Numbers in tar headers are octal text, large ones may be stored in base-256 instead
+  xiiUInt64 ParseTarNumber(const xiiUInt8* pField, xiiUInt32 uiLength)
+  {
+    xiiUInt64 uiValue = 0;
+
+    if ((pField[0] & 0x80) != 0)
+    {
+      uiValue = pField[0] & 0x7F;
+
+      for (xiiUInt32 i = 1; i < uiLength; ++i)
+      {
+        uiValue = (uiValue << 8) | pField[i];
+      }
+
+      return uiValue;
+    }
+
+    xiiUInt32 i = 0;
+    while (i < uiLength && pField[i] == ' ')
+      ++i;
+
+    for (; i < uiLength && pField[i] >= '0' && pField[i] <= '7'; ++i)
+    {
+      uiValue = (uiValue << 3) | (pField[i] - '0');
+    }
+
+    return uiValue;
+  }
+
+  // The checksum is the sum of all bytes of the header, with the checksum field itself counted as spaces
+  bool IsValidTarHeader(const xiiUInt8* pHeader)
+  {
+    xiiUInt32 uiUnsignedSum = 0;
+    xiiInt32  iSignedSum    = 0;
+
+    for (xiiUInt32 i = 0; i < s_uiTarBlockSize; ++i)
+    {
+      const xiiUInt8 uiByte = (i >= 148 && i < 156) ? ' ' : pHeader[i];
+      uiUnsignedSum += uiByte;
+      iSignedSum += static_cast<xiiInt8>(uiByte);
+    }
+
+    // Some old implementations summed signed bytes
+    const xiiUInt64 uiChecksum = ParseTarNumber(pHeader + 148, 8);
+    return uiChecksum == uiUnsignedSum || uiChecksum == static_cast<xiiUInt64>(static_cast<xiiInt64>(iSignedSum));
+  }
+
+  bool IsEmptyBlock(const xiiUInt8* pBlock)
+  {
+    for (xiiUInt32 i = 0; i < s_uiTarBlockSize; ++i)
+    {
+      if (pBlock[i] != 0)
+        return false;
+    }
+
+    return true;
+  }
+
+  // Text fields in tar headers are only zero-terminated if they are shorter than the field
+  xiiStringView GetTarString(const xiiUInt8* pField, xiiUInt32 uiLength)
+  {
+    const char* szStart = reinterpret_cast<const char*>(pField);
+    const char* szEnd   = szStart;
+
+    while (szEnd < szStart + uiLength && *szEnd != '\0')
+      ++szEnd;
+
+    return xiiStringView(szStart, szEnd);
+  }
+
+  // Pax records look like '<length> <key>=<value>\n', where the length includes the whole record
+  void ParsePaxRecords(xiiStringView sRecords, xiiStringBuilder& out_sPath, xiiUInt64& out_uiSize)
+  {
+    const char* szPos = sRecords.GetStartPointer();
+    const char* szEnd = sRecords.GetEndPointer();
+
+    while (szPos < szEnd)
+    {
+      xiiUInt64   uiLength = 0;
+      const char* szDigit  = szPos;
+
+      for (; szDigit < szEnd && *szDigit >= '0' && *szDigit <= '9'; ++szDigit)
+      {
+        uiLength = uiLength * 10 + (*szDigit - '0');
+      }
+
+      if (szDigit == szPos || szDigit >= szEnd || *szDigit != ' ' || uiLength > static_cast<xiiUInt64>(szEnd - szPos))
+        return;
+
+      const char* szKey       = szDigit + 1;
+      const char* szRecordEnd = szPos + uiLength;
+      const char* szEquals    = szKey;
+
+      while (szEquals < szRecordEnd && *szEquals != '=')
+        ++szEquals;
+
+      if (szEquals < szRecordEnd && szRecordEnd[-1] == '\n')
+      {
+        const xiiStringView sKey(szKey, szEquals);
+        const xiiStringView sValue(szEquals + 1, szRecordEnd - 1);
+
+        if (sKey == "path")
+        {
+          out_sPath = sValue;
+        }
+        else if (sKey == "size")
+        {
+          out_uiSize = 0;
+          for (const char* szChar = sValue.GetStartPointer(); szChar < sValue.GetEndPointer() && *szChar >= '0' && *szChar <= '9'; ++szChar)
+          {
+            out_uiSize = out_uiSize * 10 + (*szChar - '0');
+          }
+        }
+      }
+
+      szPos = szRecordEnd;
+    }
+  }
+
+  // Paths are counted relative to the archive, no matter how they were added
+  void NormalizePath(xiiStringBuilder& ref_sPath)
+  {
+    ref_sPath.ReplaceAll("\\", "/");
+
+    while (ref_sPath.StartsWith("./") || ref_sPath.StartsWith("/"))
+    {
+      ref_sPath.Shrink(ref_sPath.StartsWith("/") ? 1 : 2, 0);
+    }
+  }
+} // namespace
+
+bool xiiLineCountArchiveReader::GetFormat(xiiStringView sPath, Format& out_format)
+{
+  if (sPath.EndsWith_NoCase(".zip"))
+  {
+    out_format = Format::Zip;
+    return true;
+  }
+
+  if (sPath.EndsWith_NoCase(".tar"))
+  {
+    out_format = Format::Tar;
+    return true;
+  }
+
+  if (sPath.EndsWith_NoCase(".tar.gz") || sPath.EndsWith_NoCase(".tgz"))
+  {
+    out_format = Format::TarGz;
+    return true;
+  }
+
+  return false;
+}
+
+xiiResult xiiLineCountArchiveReader::Open(xiiStringView sFile, Format format)
+{
+  Close();
+
+  m_Format = format;
+
+  if (format != Format::Zip)
+  {
+    XII_SUCCEED_OR_RETURN(m_File.Open(sFile));
+
+    m_pTarStream = &m_File;
+
+    if (format == Format::TarGz)
+    {
+      m_Inflate.SetInputStream(&m_File, xiiLineCountInflateReader::Format::Gzip);
+      m_pTarStream = &m_Inflate;
+    }
+
+    return XII_SUCCESS;
+  }
+
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE)
+  XII_SUCCEED_OR_RETURN(m_MappedFile.Open(sFile, xiiMemoryMappedFile::Mode::ReadOnly));
+
+  m_pArchive      = static_cast<const xiiUInt8*>(m_MappedFile.GetReadPointer());
+  m_uiArchiveSize = m_MappedFile.GetFileSize();
+
+  if (m_uiArchiveSize < s_uiZipEndSize)
+    return XII_FAILURE;
+
+  // The end record is at the end of the file, followed only by a comment of up to 64 KB
+  xiiUInt64       uiEnd    = m_uiArchiveSize - s_uiZipEndSize;
+  const xiiUInt64 uiMinEnd = uiEnd > 0xFFFF ? uiEnd - 0xFFFF : 0;
+
+  while (ReadUInt32(m_pArchive + uiEnd) != s_uiZipEndSignature)
+  {
+    if (uiEnd == uiMinEnd)
+      return XII_FAILURE;
+
+    --uiEnd;
+  }
+
+  const xiiUInt8* pEnd            = m_pArchive + uiEnd;
+  xiiUInt64       uiDirectorySize = ReadUInt32(pEnd + 12);
+  m_uiRemainingEntries            = ReadUInt16(pEnd + 10);
+  m_uiNextEntry                   = ReadUInt32(pEnd + 16);
+
+  // Archives with too many or too large files have the real values in the zip64 end record, a locator right before this one points to it
+  if ((m_uiRemainingEntries == 0xFFFF || uiDirectorySize == 0xFFFFFFFF || m_uiNextEntry == 0xFFFFFFFF) && uiEnd >= s_uiZip64LocatorSize && ReadUInt32(pEnd - s_uiZip64LocatorSize) == s_uiZip64LocatorSignature)
+  {
+    const xiiUInt64 uiZip64End = ReadUInt64(pEnd - s_uiZip64LocatorSize + 8);
+
+    if (uiZip64End > uiEnd - s_uiZip64LocatorSize || uiEnd - s_uiZip64LocatorSize - uiZip64End < s_uiZip64EndSize || ReadUInt32(m_pArchive + uiZip64End) != s_uiZip64EndSignature)
+      return XII_FAILURE;
+
+    const xiiUInt8* pZip64End = m_pArchive + uiZip64End;
+    m_uiRemainingEntries      = ReadUInt64(pZip64End + 32);
+    uiDirectorySize           = ReadUInt64(pZip64End + 40);
+    m_uiNextEntry             = ReadUInt64(pZip64End + 48);
+  }
+
+  if (m_uiNextEntry > uiEnd || uiDirectorySize > uiEnd - m_uiNextEntry)
+    return XII_FAILURE;
+
+  return XII_SUCCESS;
+#else
+  return XII_FAILURE;
+#endif
+}
+
+void xiiLineCountArchiveReader::Close()
+{
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE)
+  m_MappedFile.Close();
+#endif
+
+  m_File.Close();
+  m_Inflate.SetInputStream(nullptr, xiiLineCountInflateReader::Format::Raw);
+
+  m_bFailed            = false;
+  m_uiSkippedFiles     = 0;
+  m_sPath.Clear();
+  m_uiSize             = 0;
+  m_pArchive           = nullptr;
+  m_uiArchiveSize      = 0;
+  m_uiNextEntry        = 0;
+  m_uiRemainingEntries = 0;
+  m_bDeflated          = false;
+  m_pTarStream         = nullptr;
+  m_uiRemaining        = 0;
+  m_uiPadding          = 0;
+}
+
+bool xiiLineCountArchiveReader::NextFile()
+{
+  if (m_bFailed)
+    return false;
+
+  return m_Format == Format::Zip ? NextZipFile() : NextTarFile();
+}
+
+xiiUInt64 xiiLineCountArchiveReader::ReadBytes(void* pBuffer, xiiUInt64 uiBytesToRead)
+{
+  if (m_bFailed)
+    return 0;
+
+  if (m_Format == Format::Zip)
+  {
+    if (!m_bDeflated)
+      return m_StoredData.ReadBytes(pBuffer, uiBytesToRead);
+
+    const xiiUInt64 uiRead = m_Inflate.ReadBytes(pBuffer, uiBytesToRead);
+
+    if (m_Inflate.HasFailed())
+      Fail();
+
+    return uiRead;
+  }
+
+  const xiiUInt64 uiToRead = xiiMath::Min(uiBytesToRead, m_uiRemaining);
+  const xiiUInt64 uiRead   = m_pTarStream->ReadBytes(pBuffer, uiToRead);
+  m_uiRemaining -= uiRead;
+
+  // The archive is cut off
+  if (uiRead < uiToRead)
+    Fail();
+
+  return uiRead;
+}
+
+bool xiiLineCountArchiveReader::NextZipFile()
+{
+  while (m_uiRemainingEntries > 0)
+  {
+    --m_uiRemainingEntries;
+
+    if (m_uiNextEntry + s_uiZipCentralHeaderSize > m_uiArchiveSize)
+      return Fail();
+
+    const xiiUInt8* pEntry = m_pArchive + m_uiNextEntry;
+
+    if (ReadUInt32(pEntry) != s_uiZipCentralSignature)
+      return Fail();
+
+    const xiiUInt32 uiFlags         = ReadUInt16(pEntry + 8);
+    const xiiUInt32 uiMethod        = ReadUInt16(pEntry + 10);
+    xiiUInt64       uiCompressed    = ReadUInt32(pEntry + 20);
+    xiiUInt64       uiSize          = ReadUInt32(pEntry + 24);
+    const xiiUInt32 uiNameLength    = ReadUInt16(pEntry + 28);
+    const xiiUInt32 uiExtraLength   = ReadUInt16(pEntry + 30);
+    const xiiUInt32 uiCommentLength = ReadUInt16(pEntry + 32);
+    xiiUInt64       uiOffset        = ReadUInt32(pEntry + 42);
+
+    const xiiUInt64 uiEntrySize = s_uiZipCentralHeaderSize + uiNameLength + uiExtraLength + uiCommentLength;
+    if (uiEntrySize > m_uiArchiveSize - m_uiNextEntry)
+      return Fail();
+
+    m_uiNextEntry += uiEntrySize;
+
+    // Zip64: the values that don't fit into 32 bits are in an extra field, in this order
+    const xiiUInt8* pExtra    = pEntry + s_uiZipCentralHeaderSize + uiNameLength;
+    const xiiUInt8* pExtraEnd = pExtra + uiExtraLength;
+
+    while (pExtra + 4 <= pExtraEnd)
+    {
+      const xiiUInt32 uiId      = ReadUInt16(pExtra);
+      const xiiUInt8* pField    = pExtra + 4;
+      const xiiUInt8* pFieldEnd = pField + ReadUInt16(pExtra + 2);
+
+      if (pFieldEnd > pExtraEnd)
+        break;
+
+      if (uiId == 0x0001)
+      {
+        xiiUInt64* pValues[] = {&uiSize, &uiCompressed, &uiOffset};
+
+        for (xiiUInt64* pValue : pValues)
+        {
+          if (*pValue == 0xFFFFFFFF && pField + 8 <= pFieldEnd)
+          {
+            *pValue = ReadUInt64(pField);
+            pField += 8;
+          }
+        }
+
+        break;
+      }
+
+      pExtra = pFieldEnd;
+    }
+
+    m_sPath = xiiStringView(reinterpret_cast<const char*>(pEntry + s_uiZipCentralHeaderSize), uiNameLength);
+    NormalizePath(m_sPath);
+
+    if (m_sPath.IsEmpty() || m_sPath.EndsWith("/"))
+      continue;
+
+    // Encrypted files and other compression methods than deflate
+    if ((uiFlags & 0x01) != 0 || (uiMethod != 0 && uiMethod != 8))
+    {
+      ++m_uiSkippedFiles;
+      continue;
+    }
+
+    // The data follows the local header, whose name and extra field may differ from the central directory
+    if (m_uiArchiveSize < s_uiZipLocalHeaderSize || uiOffset > m_uiArchiveSize - s_uiZipLocalHeaderSize || ReadUInt32(m_pArchive + uiOffset) != s_uiZipLocalSignature)
+      return Fail();
+
+    const xiiUInt8* pLocal = m_pArchive + uiOffset;
+    const xiiUInt64 uiData = uiOffset + s_uiZipLocalHeaderSize + ReadUInt16(pLocal + 26) + ReadUInt16(pLocal + 28);
+
+    if (uiData > m_uiArchiveSize || uiCompressed > m_uiArchiveSize - uiData || (uiMethod == 0 && uiCompressed != uiSize))
+      return Fail();
+
+    m_StoredData.Reset(m_pArchive + uiData, uiCompressed);
+    m_uiSize    = uiSize;
+    m_bDeflated = uiMethod == 8;
+
+    if (m_bDeflated)
+      m_Inflate.SetInputStream(&m_StoredData, xiiLineCountInflateReader::Format::Raw);
+
+    return true;
+  }
+
+  return false;
+}
+
+bool xiiLineCountArchiveReader::NextTarFile()
+{
+  // The rest of the current file and the padding after it
+  const xiiUInt64 uiSkip = m_uiRemaining + m_uiPadding;
+  if (m_pTarStream->SkipBytes(uiSkip) != uiSkip)
+    return Fail();
+
+  m_uiRemaining = 0;
+  m_uiPadding   = 0;
+
+  // Set by metadata entries for the file that follows them
+  xiiStringBuilder sLongPath;
+  xiiUInt64        uiPaxSize = s_uiInvalidSize;
+
+  xiiUInt8 header[s_uiTarBlockSize];
+
+  while (true)
+  {
+    const xiiUInt64 uiRead = m_pTarStream->ReadBytes(header, s_uiTarBlockSize);
+
+    // The archive should end with two empty blocks, but some writers leave them out
+    if (uiRead == 0 || (uiRead == s_uiTarBlockSize && IsEmptyBlock(header)))
+      return false;
+
+    if (uiRead != s_uiTarBlockSize || !IsValidTarHeader(header))
+      return Fail();
+
+    const xiiUInt64 uiSize    = ParseTarNumber(header + 124, 12);
+    const xiiUInt64 uiPadding = (s_uiTarBlockSize - uiSize % s_uiTarBlockSize) % s_uiTarBlockSize;
+    const char      type      = static_cast<char>(header[156]);
+
+    // A GNU long name or pax records for the next file
+    if (type == 'L' || type == 'x')
+    {
+      xiiStringBuilder sContent;
+      if (ReadTarMetadata(uiSize, sContent).Failed() || m_pTarStream->SkipBytes(uiPadding) != uiPadding)
+        return Fail();
+
+      if (type == 'L')
+        sLongPath = sContent;
+      else
+        ParsePaxRecords(sContent, sLongPath, uiPaxSize);
+
+      continue;
+    }
+
+    const xiiUInt64 uiFileSize = uiPaxSize != s_uiInvalidSize ? uiPaxSize : uiSize;
+
+    if (!sLongPath.IsEmpty())
+    {
+      m_sPath = sLongPath;
+    }
+    else
+    {
+      // The ustar format splits long paths into a prefix and a name. Old GNU archives have other data in the place of the prefix.
+      m_sPath = GetTarString(header + 345, 155);
+
+      if (xiiMemoryUtils::IsEqual(reinterpret_cast<const char*>(header + 257), "ustar", 6) && !m_sPath.IsEmpty())
+        m_sPath.AppendPath(GetTarString(header, 100));
+      else
+        m_sPath = GetTarString(header, 100);
+    }
+
+    NormalizePath(m_sPath);
+
+    // Only regular files, everything else (directories, links, global pax records) only has its content skipped
+    if ((type != '0' && type != '\0' && type != '7') || m_sPath.IsEmpty() || m_sPath.EndsWith("/"))
+    {
+      const xiiUInt64 uiSkipEntry = uiFileSize + (s_uiTarBlockSize - uiFileSize % s_uiTarBlockSize) % s_uiTarBlockSize;
+      if (m_pTarStream->SkipBytes(uiSkipEntry) != uiSkipEntry)
+        return Fail();
+
+      sLongPath.Clear();
+      uiPaxSize = s_uiInvalidSize;
+      continue;
+    }
+
+    m_uiSize      = uiFileSize;
+    m_uiRemaining = uiFileSize;
+    m_uiPadding   = (s_uiTarBlockSize - uiFileSize % s_uiTarBlockSize) % s_uiTarBlockSize;
+    return true;
+  }
+}
+
+xiiResult xiiLineCountArchiveReader::ReadTarMetadata(xiiUInt64 uiSize, xiiStringBuilder& out_sContent)
+{
+  // Only names and a few numbers are needed from it, anything larger is not a valid archive
+  if (uiSize > s_uiMaxTarMetadataSize)
+    return XII_FAILURE;
+
+  xiiDynamicArray<char> content;
+  content.SetCountUninitialized(static_cast<xiiUInt32>(uiSize));
+
+  if (m_pTarStream->ReadBytes(content.GetData(), uiSize) != uiSize)
+    return XII_FAILURE;
+
+  // Long names are zero-terminated
+  out_sContent = GetTarString(reinterpret_cast<const xiiUInt8*>(content.GetData()), content.GetCount());
+  return XII_SUCCESS;
+}
+
+bool xiiLineCountArchiveReader::Fail()
+{
+  m_bFailed = true;
+  return false;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <LineCount/Inflate.h>
+
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/IO/MemoryMappedFile.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+// Reads the files in a zip or tar archive one after the other, without extracting anything to disk.
+//
+// Every file is decompressed while it is read, so only the part that the caller asks for at a time is kept in memory,
+// no matter how large the file or the archive is. Zip archives are memory-mapped, since their directory is at the end
+// of the file. Tar archives (also gzip-compressed ones) are read front to back in a single pass, so they can only be
+// read in order.
+//
+// Only regular files are returned, directories, links and files in unsupported formats (encrypted zip entries,
+// compression methods other than deflate) are skipped.
+class xiiLineCountArchiveReader
+{
+public:
+  enum class Format : xiiUInt8
+  {
+    Zip,
+    Tar,
+    TarGz,
+  };
+
+  // Returns whether the file is an archive, going by its name ('.zip', '.tar', '.tar.gz' or '.tgz').
+  static bool GetFormat(xiiStringView sPath, Format& out_format);
+
+  xiiResult Open(xiiStringView sFile, Format format);
+  void      Close();
+
+  // Moves to the next file, the rest of the current one is skipped. Returns false at the end of the archive, or if the
+  // archive is damaged (see HasFailed()).
+  bool NextFile();
+
+  // The path of the current file inside the archive, with '/' as the separator and without a leading one
+  xiiStringView GetPath() const { return m_sPath; }
+
+  // The size of the current file, after decompressing it
+  xiiUInt64 GetSize() const { return m_uiSize; }
+
+  // Reads from the current file. Returns fewer bytes than requested only at its end.
+  xiiUInt64 ReadBytes(void* pBuffer, xiiUInt64 uiBytesToRead);
+
+  // Whether the archive is damaged. Everything that was returned before the damage is valid.
+  bool HasFailed() const { return m_bFailed; }
+
+  // How many files were skipped because they are stored in an unsupported way
+  xiiUInt32 GetSkippedFiles() const { return m_uiSkippedFiles; }
+
+private:
+  bool NextZipFile();
+  bool NextTarFile();
+  bool Fail();
+
+  // Reads an entry of the tar stream that holds metadata for the next file (a long name or pax records)
+  xiiResult ReadTarMetadata(xiiUInt64 uiSize, xiiStringBuilder& out_sContent);
+
+  Format           m_Format         = Format::Zip;
+  bool             m_bFailed        = false;
+  xiiUInt32        m_uiSkippedFiles = 0;
+  xiiStringBuilder m_sPath;
+  xiiUInt64        m_uiSize = 0;
+
+  // Zip: the central directory tells where every file is, its data is read straight from the mapped archive
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE)
+  xiiMemoryMappedFile m_MappedFile;
+#endif
+
+  const xiiUInt8*          m_pArchive           = nullptr;
+  xiiUInt64                m_uiArchiveSize      = 0;
+  xiiUInt64                m_uiNextEntry        = 0; // Offset of the next entry of the central directory
+  xiiUInt64                m_uiRemainingEntries = 0;
+  xiiRawMemoryStreamReader m_StoredData;
+  bool                     m_bDeflated = false;
+
+  // Tar: the archive is one stream, every file is followed by padding to the next 512 byte block
+  xiiFileReader    m_File;
+  xiiStreamReader* m_pTarStream  = nullptr; // The file, or the decompressed file for .tar.gz
+  xiiUInt64        m_uiRemaining = 0;       // Bytes of the current file that were not read yet
+  xiiUInt64        m_uiPadding   = 0;
+
+  // Decompresses the current zip entry, or the whole stream of a .tar.gz
+  xiiLineCountInflateReader m_Inflate;
+};
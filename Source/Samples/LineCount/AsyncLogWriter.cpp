@@ -0,0 +1,105 @@
+#include <LineCount/AsyncLogWriter.h>
+
+#include <Foundation/Threading/Lock.h>
+
+xiiLineCountAsyncLogWriter::WorkerThread::WorkerThread(xiiLineCountAsyncLogWriter* pOwner) :
+  xiiThread("LineCount Log"),
+  m_pOwner(pOwner)
+{
+}
+
+xiiUInt32 xiiLineCountAsyncLogWriter::WorkerThread::Run()
+{
+  while (m_pOwner->ForwardQueuedMessages())
+  {
+  }
+
+  return 0;
+}
+
+xiiLineCountAsyncLogWriter::xiiLineCountAsyncLogWriter() :
+  m_MessagesQueued(xiiThreadSignal::Mode::AutoReset)
+{
+}
+
+xiiLineCountAsyncLogWriter::~xiiLineCountAsyncLogWriter()
+{
+  Stop();
+}
+
+void xiiLineCountAsyncLogWriter::Start(xiiLoggingEvent::Handler target)
+{
+  XII_ASSERT_DEV(m_pThread == nullptr, "The log writer was already started");
+
+  m_Target  = target;
+  m_bStop   = false;
+  m_pThread = XII_DEFAULT_NEW(WorkerThread, this);
+  m_pThread->Start();
+}
+
+void xiiLineCountAsyncLogWriter::Stop()
+{
+  if (m_pThread == nullptr)
+    return;
+
+  {
+    XII_LOCK(m_Mutex);
+    m_bStop = true;
+  }
+
+  m_MessagesQueued.RaiseSignal();
+  m_pThread->Join();
+  m_pThread.Clear();
+}
+
+void xiiLineCountAsyncLogWriter::LogMessageHandler(const xiiLoggingEventData& eventData)
+{
+  bool bWasEmpty = false;
+
+  {
+    XII_LOCK(m_Mutex);
+
+    bWasEmpty = m_Queue.IsEmpty();
+
+    Message& msg        = m_Queue.ExpandAndGetRef();
+    msg.m_EventType     = eventData.m_EventType;
+    msg.m_uiIndentation = eventData.m_uiIndentation;
+    msg.m_sTag          = eventData.m_sTag;
+    msg.m_sText         = eventData.m_sText;
+  }
+
+  // The background thread takes all messages at once, so it only needs to be woken up for the first one
+  if (bWasEmpty)
+  {
+    m_MessagesQueued.RaiseSignal();
+  }
+}
+
+bool xiiLineCountAsyncLogWriter::ForwardQueuedMessages()
+{
+  m_MessagesQueued.WaitForSignal();
+
+  bool bStop = false;
+
+  {
+    XII_LOCK(m_Mutex);
+    m_Forwarding.Swap(m_Queue);
+    bStop = m_bStop;
+  }
+
+  for (const Message& msg : m_Forwarding)
+  {
+    xiiLoggingEventData eventData;
+    eventData.m_EventType     = msg.m_EventType;
+    eventData.m_uiIndentation = msg.m_uiIndentation;
+    eventData.m_sTag          = msg.m_sTag;
+    eventData.m_sText         = msg.m_sText;
+
+    m_Target(eventData);
+  }
+
+  // Keeps the capacity, so that the next batch doesn't need to allocate
+  m_Forwarding.Clear();
+
+  return !bStop;
+}
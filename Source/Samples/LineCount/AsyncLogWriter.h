@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadSignal.h>
+#include <Foundation/Types/UniquePtr.h>
+
+// Forwards log messages to another log writer on a background thread.
+//
+// The messages arrive fully formatted, so the thread that logs only copies them into a queue. The background thread
+// takes all queued messages at once and passes them to the target writer in one go, so slow writers
+// (e.g. the HTML writer, which writes to a file) never block the thread that produced the messages.
+class xiiLineCountAsyncLogWriter
+{
+public:
+  xiiLineCountAsyncLogWriter();
+  ~xiiLineCountAsyncLogWriter();
+
+  // Starts the background thread, which passes all messages to the given handler.
+  void Start(xiiLoggingEvent::Handler target);
+
+  // Passes all messages that are still queued to the target and stops the background thread.
+  void Stop();
+
+  // Register this at xiiGlobalLog.
+  void LogMessageHandler(const xiiLoggingEventData& eventData);
+
+private:
+  struct Message
+  {
+    xiiLogMsgType::Enum m_EventType     = xiiLogMsgType::None;
+    xiiUInt8            m_uiIndentation = 0;
+    xiiString           m_sTag;
+    xiiString           m_sText;
+  };
+
+  class WorkerThread final : public xiiThread
+  {
+  public:
+    WorkerThread(xiiLineCountAsyncLogWriter* pOwner);
+
+  private:
+    virtual xiiUInt32 Run() override;
+
+    xiiLineCountAsyncLogWriter* m_pOwner;
+  };
+
+  // Returns false once the writer was stopped and all messages were forwarded.
+  bool ForwardQueuedMessages();
+
+  xiiLoggingEvent::Handler   m_Target;
+  xiiUniquePtr<WorkerThread> m_pThread;
+  xiiThreadSignal            m_MessagesQueued;
+
+  xiiMutex                 m_Mutex;
+  xiiDynamicArray<Message> m_Queue; // Protected by m_Mutex
+  bool                     m_bStop = false; // Protected by m_Mutex
+
+  xiiDynamicArray<Message> m_Forwarding; // Only accessed by the background thread
+};
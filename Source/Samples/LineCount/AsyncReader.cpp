@@ -0,0 +1,567 @@
+#include <LineCount/AsyncReader.h>
+
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Memory/MemoryUtils.h>
+#include <Foundation/Threading/Lock.h>
+
+#if XII_ENABLED(XII_PLATFORM_LINUX)
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  if __has_include(<linux/io_uring.h>)
+#    include <linux/io_uring.h>
+#  endif
+
+// Opening and reading files needs the operations of Linux 5.6, older headers don't have them. liburing is not needed,
+// the three system calls are all there is to it.
+#  if defined(IORING_FEAT_CUR_PERSONALITY) && defined(__NR_io_uring_setup)
+#    define XII_LINECOUNT_IO_URING XII_ON
+#  else
+#    define XII_LINECOUNT_IO_URING XII_OFF
+#  endif
+#else
+#  define XII_LINECOUNT_IO_URING XII_OFF
+#endif
+
+namespace
+{
+  // More threads than this only add contention, the disk is saturated long before
+  constexpr xiiUInt32 MaxReadThreads = 64;
+
+  // io_uring_setup refuses larger rings on older kernels
+  constexpr xiiUInt32 MaxQueueDepth = 4096;
+
+  // Reads are split, since io_uring takes 32-bit lengths
+  constexpr xiiUInt64 MaxReadSize = 1024 * 1024 * 1024;
+} // namespace
+
+xiiLineCountAsyncReader::ReadThread::ReadThread(xiiLineCountAsyncReader* pOwner) :
+  xiiThread("LineCount Read"),
+  m_pOwner(pOwner)
+{
+}
+
+xiiUInt32 xiiLineCountAsyncReader::ReadThread::Run()
+{
+  while (m_pOwner->ReadNextFile())
+  {
+  }
+
+  return 0;
+}
+
+xiiLineCountAsyncReader::xiiLineCountAsyncReader() :
+  m_FilesQueued(xiiThreadSignal::Mode::AutoReset),
+  m_FilesCompleted(xiiThreadSignal::Mode::AutoReset)
+{
+}
+
+xiiLineCountAsyncReader::~xiiLineCountAsyncReader()
+{
+  Stop();
+}
+
+const char* xiiLineCountAsyncReader::GetBackendName(Backend backend)
+{
+  switch (backend)
+  {
+    case Backend::IoUring:
+      return "io_uring";
+    case Backend::Threads:
+      return "threads";
+  }
+
+  return "";
+}
+
+void xiiLineCountAsyncReader::Start(xiiUInt32 uiQueueDepth, bool bAllowIoUring)
+{
+  XII_ASSERT_DEV(m_uiQueueDepth == 0, "The reader was already started");
+
+  m_uiQueueDepth = xiiMath::Clamp<xiiUInt32>(uiQueueDepth, 1, MaxQueueDepth);
+  m_uiPending    = 0;
+
+#if XII_ENABLED(XII_LINECOUNT_IO_URING)
+  if (bAllowIoUring && StartIoUring(m_uiQueueDepth))
+  {
+    m_Backend = Backend::IoUring;
+    return;
+  }
+#else
+  XII_IGNORE_UNUSED(bAllowIoUring);
+#endif
+
+  m_Backend = Backend::Threads;
+  m_bStop   = false;
+
+  const xiiUInt32 uiThreads = xiiMath::Min(m_uiQueueDepth, MaxReadThreads);
+  for (xiiUInt32 i = 0; i < uiThreads; ++i)
+  {
+    m_Threads.PushBack(XII_DEFAULT_NEW(ReadThread, this));
+    m_Threads.PeekBack()->Start();
+  }
+}
+
+void xiiLineCountAsyncReader::Stop()
+{
+  if (m_uiQueueDepth == 0)
+    return;
+
+  // The buffers of pending requests must not be written to after this returns
+  xiiDynamicArray<xiiLineCountReadRequest*> dropped;
+  while (m_uiPending > 0)
+  {
+    TakeCompleted(dropped, true);
+  }
+
+#if XII_ENABLED(XII_LINECOUNT_IO_URING)
+  if (m_Backend == Backend::IoUring)
+  {
+    StopIoUring();
+  }
+#endif
+
+  if (!m_Threads.IsEmpty())
+  {
+    {
+      XII_LOCK(m_Mutex);
+      m_bStop = true;
+    }
+
+    // Every thread that stops wakes up the next one
+    m_FilesQueued.RaiseSignal();
+
+    for (xiiUniquePtr<ReadThread>& pThread : m_Threads)
+    {
+      pThread->Join();
+    }
+
+    m_Threads.Clear();
+  }
+
+  m_uiQueueDepth = 0;
+}
+
+bool xiiLineCountAsyncReader::Submit(xiiLineCountReadRequest* pRequest)
+{
+  XII_ASSERT_DEV(m_uiQueueDepth > 0, "The reader was not started");
+  XII_ASSERT_DEV(pRequest->m_uiSize <= 0xFFFFFFFFu, "Files of more than 4 GB can't be read into a single buffer");
+
+  if (m_uiPending >= m_uiQueueDepth)
+    return false;
+
+  ++m_uiPending;
+  pRequest->m_bSucceeded = false;
+
+#if XII_ENABLED(XII_LINECOUNT_IO_URING)
+  if (m_Backend == Backend::IoUring)
+  {
+    const xiiUInt32 uiSlot = m_FreeSlots.PeekBack();
+    m_FreeSlots.PopBack();
+
+    m_Slots[uiSlot].m_pRequest = pRequest;
+    QueueOpen(uiSlot);
+
+    // Files are submitted in batches, unless the kernel has nothing to do at all
+    if (m_uiInKernel == 0 || m_uiUnsubmitted >= xiiMath::Max(m_uiQueueDepth / 8, 1u))
+    {
+      SubmitQueued(0);
+    }
+
+    return true;
+  }
+#endif
+
+  {
+    XII_LOCK(m_Mutex);
+    m_Queued.PushBack(pRequest);
+  }
+
+  m_FilesQueued.RaiseSignal();
+  return true;
+}
+
+void xiiLineCountAsyncReader::TakeCompleted(xiiDynamicArray<xiiLineCountReadRequest*>& out_completed, bool bWait)
+{
+  const xiiUInt32 uiPrevious = out_completed.GetCount();
+
+#if XII_ENABLED(XII_LINECOUNT_IO_URING)
+  if (m_Backend == Backend::IoUring)
+  {
+    while (true)
+    {
+      ProcessCompletions(out_completed);
+
+      // Completed opens queue reads, which should start before the disk runs out of work
+      if (m_uiUnsubmitted > 0 && (m_uiInKernel == 0 || m_uiUnsubmitted >= xiiMath::Max(m_uiQueueDepth / 8, 1u)))
+      {
+        SubmitQueued(0);
+      }
+
+      if (!bWait || out_completed.GetCount() > uiPrevious || m_uiPending == 0)
+        break;
+
+      // Submits everything that is left and sleeps until the kernel completes something
+      SubmitQueued(1);
+    }
+
+    m_uiPending -= out_completed.GetCount() - uiPrevious;
+    return;
+  }
+#endif
+
+  while (true)
+  {
+    {
+      XII_LOCK(m_Mutex);
+      out_completed.PushBackRange(m_Completed);
+      m_Completed.Clear();
+    }
+
+    if (!bWait || out_completed.GetCount() > uiPrevious || m_uiPending == 0)
+      break;
+
+    m_FilesCompleted.WaitForSignal();
+  }
+
+  m_uiPending -= out_completed.GetCount() - uiPrevious;
+}
+
+bool xiiLineCountAsyncReader::ReadNextFile()
+{
+  xiiLineCountReadRequest* pRequest = nullptr;
+
+  while (pRequest == nullptr)
+  {
+    {
+      XII_LOCK(m_Mutex);
+
+      if (m_bStop)
+      {
+        m_FilesQueued.RaiseSignal();
+        return false;
+      }
+
+      if (!m_Queued.IsEmpty())
+      {
+        pRequest = m_Queued.PeekFront();
+        m_Queued.PopFront();
+
+        // The signal only wakes up one thread, so if there is more to do, that thread wakes up the next one
+        if (!m_Queued.IsEmpty())
+        {
+          m_FilesQueued.RaiseSignal();
+        }
+      }
+    }
+
+    if (pRequest == nullptr)
+    {
+      m_FilesQueued.WaitForSignal();
+    }
+  }
+
+  xiiFileReader File;
+  if (File.Open(pRequest->m_szPath).Succeeded())
+  {
+    pRequest->m_Data.SetCountUninitialized(static_cast<xiiUInt32>(pRequest->m_uiSize));
+
+    const xiiUInt64 uiRead = File.ReadBytes(pRequest->m_Data.GetData(), pRequest->m_Data.GetCount());
+    pRequest->m_Data.SetCountUninitialized(static_cast<xiiUInt32>(uiRead));
+    pRequest->m_bSucceeded = true;
+  }
+
+  {
+    XII_LOCK(m_Mutex);
+    m_Completed.PushBack(pRequest);
+  }
+
+  m_FilesCompleted.RaiseSignal();
+  return true;
+}
+
+#if XII_ENABLED(XII_LINECOUNT_IO_URING)
+
+bool xiiLineCountAsyncReader::StartIoUring(xiiUInt32 uiQueueDepth)
+{
+  // Every file has at most one operation in flight, so the rings never hold more than the queue depth
+  io_uring_params params;
+  xiiMemoryUtils::ZeroFill(&params, 1);
+
+  m_iRing = static_cast<int>(syscall(__NR_io_uring_setup, uiQueueDepth, &params));
+  if (m_iRing < 0)
+    return false;
+
+  // The kernel may know io_uring, but not the operations for opening and reading files
+  {
+    constexpr xiiUInt32 uiMaxOps = 256;
+
+    xiiDynamicArray<xiiUInt8> probeData;
+    probeData.SetCount(sizeof(io_uring_probe) + uiMaxOps * sizeof(io_uring_probe_op));
+    io_uring_probe* pProbe = reinterpret_cast<io_uring_probe*>(probeData.GetData());
+
+    if (syscall(__NR_io_uring_register, m_iRing, IORING_REGISTER_PROBE, pProbe, uiMaxOps) < 0)
+    {
+      StopIoUring();
+      return false;
+    }
+
+    for (xiiUInt32 uiOp : {IORING_OP_OPENAT, IORING_OP_READ})
+    {
+      if (uiOp >= pProbe->ops_len || (pProbe->ops[uiOp].flags & IO_URING_OP_SUPPORTED) == 0)
+      {
+        StopIoUring();
+        return false;
+      }
+    }
+  }
+
+  m_uiSubmissionRingSize = params.sq_off.array + params.sq_entries * sizeof(xiiUInt32);
+  m_uiCompletionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  m_uiEntriesSize        = params.sq_entries * sizeof(io_uring_sqe);
+
+  // Newer kernels put both rings into the same mapping
+  const bool bSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (bSingleMapping)
+  {
+    m_uiSubmissionRingSize = xiiMath::Max(m_uiSubmissionRingSize, m_uiCompletionRingSize);
+    m_uiCompletionRingSize = m_uiSubmissionRingSize;
+  }
+
+  m_pSubmissionRing = mmap(nullptr, m_uiSubmissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iRing, IORING_OFF_SQ_RING);
+  if (m_pSubmissionRing == MAP_FAILED)
+  {
+    m_pSubmissionRing = nullptr;
+    StopIoUring();
+    return false;
+  }
+
+  if (bSingleMapping)
+  {
+    m_pCompletionRing = m_pSubmissionRing;
+  }
+  else
+  {
+    m_pCompletionRing = mmap(nullptr, m_uiCompletionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iRing, IORING_OFF_CQ_RING);
+    if (m_pCompletionRing == MAP_FAILED)
+    {
+      m_pCompletionRing = nullptr;
+      StopIoUring();
+      return false;
+    }
+  }
+
+  m_pEntries = mmap(nullptr, m_uiEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iRing, IORING_OFF_SQES);
+  if (m_pEntries == MAP_FAILED)
+  {
+    m_pEntries = nullptr;
+    StopIoUring();
+    return false;
+  }
+
+  xiiUInt8* pSubmissionRing = static_cast<xiiUInt8*>(m_pSubmissionRing);
+  m_pSubmissionHead         = reinterpret_cast<xiiUInt32*>(pSubmissionRing + params.sq_off.head);
+  m_pSubmissionTail         = reinterpret_cast<xiiUInt32*>(pSubmissionRing + params.sq_off.tail);
+  m_pSubmissionArray        = reinterpret_cast<xiiUInt32*>(pSubmissionRing + params.sq_off.array);
+  m_uiSubmissionMask        = *reinterpret_cast<xiiUInt32*>(pSubmissionRing + params.sq_off.ring_mask);
+
+  xiiUInt8* pCompletionRing = static_cast<xiiUInt8*>(m_pCompletionRing);
+  m_pCompletionHead         = reinterpret_cast<xiiUInt32*>(pCompletionRing + params.cq_off.head);
+  m_pCompletionTail         = reinterpret_cast<xiiUInt32*>(pCompletionRing + params.cq_off.tail);
+  m_pCompletions            = pCompletionRing + params.cq_off.cqes;
+  m_uiCompletionMask        = *reinterpret_cast<xiiUInt32*>(pCompletionRing + params.cq_off.ring_mask);
+
+  m_Slots.SetCount(uiQueueDepth);
+  m_FreeSlots.SetCountUninitialized(uiQueueDepth);
+  for (xiiUInt32 i = 0; i < uiQueueDepth; ++i)
+  {
+    m_FreeSlots[i] = uiQueueDepth - 1 - i;
+  }
+
+  m_uiUnsubmitted = 0;
+  m_uiInKernel    = 0;
+  return true;
+}
+
+void xiiLineCountAsyncReader::StopIoUring()
+{
+  if (m_pEntries != nullptr)
+  {
+    munmap(m_pEntries, m_uiEntriesSize);
+  }
+
+  if (m_pCompletionRing != nullptr && m_pCompletionRing != m_pSubmissionRing)
+  {
+    munmap(m_pCompletionRing, m_uiCompletionRingSize);
+  }
+
+  if (m_pSubmissionRing != nullptr)
+  {
+    munmap(m_pSubmissionRing, m_uiSubmissionRingSize);
+  }
+
+  if (m_iRing >= 0)
+  {
+    close(m_iRing);
+  }
+
+  m_iRing           = -1;
+  m_pSubmissionRing = nullptr;
+  m_pCompletionRing = nullptr;
+  m_pEntries        = nullptr;
+
+  m_Slots.Clear();
+  m_FreeSlots.Clear();
+}
+
+void xiiLineCountAsyncReader::QueueEntry(const void* pEntry)
+{
+  XII_ASSERT_DEBUG(m_uiUnsubmitted + m_uiInKernel < m_Slots.GetCount(), "The submission ring is full");
+
+  // Only this thread writes the tail, the kernel only reads it
+  const xiiUInt32 uiTail  = *m_pSubmissionTail;
+  const xiiUInt32 uiIndex = uiTail & m_uiSubmissionMask;
+
+  xiiMemoryUtils::Copy(static_cast<io_uring_sqe*>(m_pEntries) + uiIndex, static_cast<const io_uring_sqe*>(pEntry), 1);
+  m_pSubmissionArray[uiIndex] = uiIndex;
+
+  // The entry must be visible to the kernel before the new tail
+  __atomic_store_n(m_pSubmissionTail, uiTail + 1, __ATOMIC_RELEASE);
+  ++m_uiUnsubmitted;
+}
+
+void xiiLineCountAsyncReader::QueueOpen(xiiUInt32 uiSlot)
+{
+  Slot& slot      = m_Slots[uiSlot];
+  slot.m_iFile    = -1;
+  slot.m_uiOffset = 0;
+
+  io_uring_sqe entry;
+  xiiMemoryUtils::ZeroFill(&entry, 1);
+  entry.opcode     = IORING_OP_OPENAT;
+  entry.fd         = AT_FDCWD;
+  entry.addr       = reinterpret_cast<xiiUInt64>(slot.m_pRequest->m_szPath);
+  entry.open_flags = O_RDONLY | O_CLOEXEC;
+  entry.user_data  = uiSlot;
+
+  QueueEntry(&entry);
+}
+
+void xiiLineCountAsyncReader::QueueRead(xiiUInt32 uiSlot)
+{
+  Slot& slot = m_Slots[uiSlot];
+
+  io_uring_sqe entry;
+  xiiMemoryUtils::ZeroFill(&entry, 1);
+  entry.opcode    = IORING_OP_READ;
+  entry.fd        = slot.m_iFile;
+  entry.addr      = reinterpret_cast<xiiUInt64>(slot.m_pRequest->m_Data.GetData() + slot.m_uiOffset);
+  entry.len       = static_cast<xiiUInt32>(xiiMath::Min(slot.m_pRequest->m_uiSize - slot.m_uiOffset, MaxReadSize));
+  entry.off       = slot.m_uiOffset;
+  entry.user_data = uiSlot;
+
+  QueueEntry(&entry);
+}
+
+void xiiLineCountAsyncReader::CompleteSlot(xiiUInt32 uiSlot, bool bSucceeded, xiiDynamicArray<xiiLineCountReadRequest*>& out_completed)
+{
+  Slot& slot = m_Slots[uiSlot];
+
+  // Closing is fast enough that an asynchronous operation would only cost another round trip
+  if (slot.m_iFile >= 0)
+  {
+    close(slot.m_iFile);
+    slot.m_iFile = -1;
+  }
+
+  slot.m_pRequest->m_bSucceeded = bSucceeded;
+  out_completed.PushBack(slot.m_pRequest);
+
+  slot.m_pRequest = nullptr;
+  m_FreeSlots.PushBack(uiSlot);
+}
+
+void xiiLineCountAsyncReader::SubmitQueued(xiiUInt32 uiMinComplete)
+{
+  while (true)
+  {
+    const unsigned int uiFlags = uiMinComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    const long iResult         = syscall(__NR_io_uring_enter, m_iRing, m_uiUnsubmitted, uiMinComplete, uiFlags, nullptr, 0);
+
+    if (iResult >= 0)
+    {
+      m_uiUnsubmitted -= static_cast<xiiUInt32>(iResult);
+      m_uiInKernel += static_cast<xiiUInt32>(iResult);
+      return;
+    }
+
+    // Interrupted or temporarily out of memory, nothing was submitted
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+    {
+      XII_REPORT_FAILURE("io_uring_enter failed with error {}", errno);
+      return;
+    }
+  }
+}
+
+void xiiLineCountAsyncReader::ProcessCompletions(xiiDynamicArray<xiiLineCountReadRequest*>& out_completed)
+{
+  const io_uring_cqe* pCompletions = static_cast<const io_uring_cqe*>(m_pCompletions);
+
+  // Only this thread writes the head, the kernel only writes the tail
+  xiiUInt32       uiHead = *m_pCompletionHead;
+  const xiiUInt32 uiTail = __atomic_load_n(m_pCompletionTail, __ATOMIC_ACQUIRE);
+
+  if (uiHead == uiTail)
+    return;
+
+  for (; uiHead != uiTail; ++uiHead)
+  {
+    const io_uring_cqe& completion = pCompletions[uiHead & m_uiCompletionMask];
+    const xiiUInt32     uiSlot     = static_cast<xiiUInt32>(completion.user_data);
+    const xiiInt32      iResult    = completion.res;
+    --m_uiInKernel;
+
+    Slot&                    slot     = m_Slots[uiSlot];
+    xiiLineCountReadRequest* pRequest = slot.m_pRequest;
+
+    if (iResult < 0)
+    {
+      CompleteSlot(uiSlot, false, out_completed);
+    }
+    else if (slot.m_iFile < 0)
+    {
+      // Opened
+      slot.m_iFile = iResult;
+      pRequest->m_Data.SetCountUninitialized(static_cast<xiiUInt32>(pRequest->m_uiSize));
+
+      if (pRequest->m_uiSize == 0)
+        CompleteSlot(uiSlot, true, out_completed);
+      else
+        QueueRead(uiSlot);
+    }
+    else if (iResult == 0)
+    {
+      // The file got shorter since it was found
+      pRequest->m_Data.SetCountUninitialized(static_cast<xiiUInt32>(slot.m_uiOffset));
+      CompleteSlot(uiSlot, true, out_completed);
+    }
+    else
+    {
+      slot.m_uiOffset += static_cast<xiiUInt32>(iResult);
+
+      if (slot.m_uiOffset >= pRequest->m_uiSize)
+        CompleteSlot(uiSlot, true, out_completed);
+      else
+        QueueRead(uiSlot);
+    }
+  }
+
+  // The kernel may reuse the entries once the head has moved past them
+  __atomic_store_n(m_pCompletionHead, uiHead, __ATOMIC_RELEASE);
+}
+
+#endif
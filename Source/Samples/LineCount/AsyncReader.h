@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadSignal.h>
+#include <Foundation/Types/UniquePtr.h>
+
+// A file that xiiLineCountAsyncReader reads completely into memory
+struct xiiLineCountReadRequest
+{
+  const char*               m_szPath    = nullptr; // Must stay valid until the request is completed
+  xiiUInt64                 m_uiSize    = 0;       // How many bytes to read, usually the size of the file when it was found
+  void*                     m_pUserData = nullptr;
+  xiiDynamicArray<xiiUInt8> m_Data;                // The content, shorter than m_uiSize if the file shrank in the meantime
+  bool                      m_bSucceeded = false;
+};
+
+// Reads many files at the same time, so that the disk always has enough requests queued to run at full speed, even
+// when nothing is cached yet. A single thread submits the files and takes the completed ones, everything else happens
+// in the background.
+//
+// On Linux, io_uring is used: opening and reading the files are asynchronous operations that are submitted in
+// batches, so a whole queue of files costs only a few system calls and no threads. Where io_uring is not available
+// (other platforms, kernels before 5.6, or when it is forbidden, e.g. in containers), a pool of threads does blocking
+// reads instead, one thread per file in flight.
+class xiiLineCountAsyncReader
+{
+public:
+  enum class Backend : xiiUInt8
+  {
+    IoUring,
+    Threads,
+  };
+
+  xiiLineCountAsyncReader();
+  ~xiiLineCountAsyncReader();
+
+  // Up to uiQueueDepth files are read at the same time. Uses io_uring if it is available, unless bAllowIoUring is false.
+  void Start(xiiUInt32 uiQueueDepth, bool bAllowIoUring);
+
+  // Waits until all pending requests are completed and stops. Requests that were not taken are dropped.
+  void Stop();
+
+  Backend            GetBackend() const { return m_Backend; }
+  static const char* GetBackendName(Backend backend);
+
+  // Starts reading the file. Returns false if the queue is full, then completed requests have to be taken first.
+  bool Submit(xiiLineCountReadRequest* pRequest);
+
+  // Appends the requests that are completed. With bWait, waits until there is at least one, unless nothing is pending.
+  void TakeCompleted(xiiDynamicArray<xiiLineCountReadRequest*>& out_completed, bool bWait);
+
+  // How many requests were submitted, but not taken yet
+  xiiUInt32 GetPendingCount() const { return m_uiPending; }
+
+private:
+  Backend   m_Backend      = Backend::Threads;
+  xiiUInt32 m_uiQueueDepth = 0;
+  xiiUInt32 m_uiPending    = 0;
+
+  // Threads backend
+
+  class ReadThread final : public xiiThread
+  {
+  public:
+    ReadThread(xiiLineCountAsyncReader* pOwner);
+
+  private:
+    virtual xiiUInt32 Run() override;
+
+    xiiLineCountAsyncReader* m_pOwner;
+  };
+
+  // Reads the next queued file. Returns false once the reader is stopped.
+  bool ReadNextFile();
+
+  xiiDynamicArray<xiiUniquePtr<ReadThread>> m_Threads;
+  xiiThreadSignal                           m_FilesQueued;
+  xiiThreadSignal                           m_FilesCompleted;
+
+  xiiMutex                                  m_Mutex;
+  xiiDeque<xiiLineCountReadRequest*>        m_Queued;        // Protected by m_Mutex
+  xiiDynamicArray<xiiLineCountReadRequest*> m_Completed;     // Protected by m_Mutex
+  bool                                      m_bStop = false; // Protected by m_Mutex
+
+#if XII_ENABLED(XII_PLATFORM_LINUX)
+  // io_uring backend
+
+  // A file from opening it until it is read completely
+  struct Slot
+  {
+    xiiLineCountReadRequest* m_pRequest = nullptr;
+    int                      m_iFile    = -1;
+    xiiUInt64                m_uiOffset = 0;
+  };
+
+  bool StartIoUring(xiiUInt32 uiQueueDepth);
+  void StopIoUring();
+  void QueueEntry(const void* pEntry); // Copies an io_uring_sqe into the submission ring
+  void QueueOpen(xiiUInt32 uiSlot);
+  void QueueRead(xiiUInt32 uiSlot);
+  void CompleteSlot(xiiUInt32 uiSlot, bool bSucceeded, xiiDynamicArray<xiiLineCountReadRequest*>& out_completed);
+  void SubmitQueued(xiiUInt32 uiMinComplete);
+  void ProcessCompletions(xiiDynamicArray<xiiLineCountReadRequest*>& out_completed);
+
+  int m_iRing = -1;
+
+  // The rings are shared with the kernel
+  void*      m_pSubmissionRing      = nullptr;
+  xiiUInt64  m_uiSubmissionRingSize = 0;
+  void*      m_pCompletionRing      = nullptr;
+  xiiUInt64  m_uiCompletionRingSize = 0;
+  void*      m_pEntries             = nullptr;
+  xiiUInt64  m_uiEntriesSize        = 0;
+  xiiUInt32* m_pSubmissionHead      = nullptr;
+  xiiUInt32* m_pSubmissionTail      = nullptr;
+  xiiUInt32* m_pSubmissionArray     = nullptr;
+  xiiUInt32  m_uiSubmissionMask     = 0;
+  void*      m_pCompletions         = nullptr;
+  xiiUInt32* m_pCompletionHead      = nullptr;
+  xiiUInt32* m_pCompletionTail      = nullptr;
+  xiiUInt32  m_uiCompletionMask     = 0;
+
+  xiiDynamicArray<Slot>      m_Slots;
+  xiiDynamicArray<xiiUInt32> m_FreeSlots;
+  xiiUInt32                  m_uiUnsubmitted = 0; // Operations in the submission ring that the kernel doesn't know about yet
+  xiiUInt32                  m_uiInKernel    = 0; // Operations that were submitted, but are not completed yet
+#endif
+};
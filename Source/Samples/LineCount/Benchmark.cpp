@@ -0,0 +1,236 @@
+#include <LineCount/Benchmark.h>
+#include <LineCount/Scanner.h>
+#include <LineCount/Utf8Validator.h>
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Math/Random.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Strings/StringUtils.h>
+#include <Foundation/Strings/UnicodeUtils.h>
+#include <Foundation/Time/Time.h>
+
+namespace
+{
+  // Generates deterministic source-code-like lines of about the given length.
+  // Roughly the given percentages of tokens are non-ASCII characters and of lines end with "\r\n".
+  void GenerateText(xiiDynamicArray<xiiUInt8>& out_text, xiiUInt32 uiSize, xiiUInt32 uiLineLength, xiiUInt32 uiNonAsciiPercentage, xiiUInt32 uiCrlfPercentage, xiiRandom& ref_rng)
+  {
+    const char* szTokens[]   = {"int", " ", "main", "(", ")", "{", "}", "return", "0", ";", "foo_bar", "=", "42", "\t", "//", "comment", "  "};
+    const char* szNonAscii[] = {"\xC3\xA4", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"};
+
+    out_text.Clear();
+    out_text.Reserve(uiSize + 256);
+
+    auto Append = [&](const char* szText)
+    {
+      out_text.PushBackRange(xiiArrayPtr<const xiiUInt8>(reinterpret_cast<const xiiUInt8*>(szText), xiiStringUtils::GetStringElementCount(szText)));
+    };
+
+    while (out_text.GetCount() < uiSize)
+    {
+      // Line lengths vary between half and one and a half times the average
+      const xiiUInt32 uiLineEnd = out_text.GetCount() + uiLineLength / 2 + ref_rng.UIntInRange(uiLineLength + 1);
+
+      while (out_text.GetCount() < uiLineEnd)
+      {
+        if (ref_rng.UIntInRange(100) < uiNonAsciiPercentage)
+          Append(szNonAscii[ref_rng.UIntInRange(XII_ARRAY_SIZE(szNonAscii))]);
+        else
+          Append(szTokens[ref_rng.UIntInRange(XII_ARRAY_SIZE(szTokens))]);
+      }
+
+      Append(ref_rng.UIntInRange(100) < uiCrlfPercentage ? "\r\n" : "\n");
+    }
+  }
+
+  void GenerateText(xiiDynamicArray<xiiUInt8>& out_text, xiiUInt32 uiSize, xiiUInt32 uiNonAsciiPercentage, xiiUInt32 uiSeed)
+  {
+    xiiRandom rng;
+    rng.Initialize(uiSeed);
+
+    GenerateText(out_text, uiSize, 30, uiNonAsciiPercentage, 50, rng);
+  }
+
+  // Generates the path (relative to the corpus directory) and the content of one file of the corpus.
+  // Every file uses its own random number generator, so each one can be generated on its own.
+  void GenerateCorpusFile(const xiiLineCountCorpusDesc& desc, xiiUInt32 uiFile, xiiStringBuilder& out_sPath, xiiDynamicArray<xiiUInt8>& out_content)
+  {
+    const char* szExtensions[] = {"cpp", "h", "cpp", "h", "inl", "hpp"};
+
+    xiiRandom rng;
+    rng.Initialize(desc.m_uiSeed * 1000003ull + uiFile);
+
+    out_sPath.Clear();
+    for (xiiUInt32 uiLevel = 0; uiLevel < desc.m_uiDirectoryDepth; ++uiLevel)
+    {
+      out_sPath.AppendFormat("Dir{0}/", rng.UIntInRange(4));
+    }
+
+    out_sPath.AppendFormat("File{0}.{1}", uiFile, szExtensions[rng.UIntInRange(XII_ARRAY_SIZE(szExtensions))]);
+
+    const double    fLogSize = rng.DoubleMinMax(xiiMath::Ln((double)desc.m_uiMinFileSize), xiiMath::Ln((double)desc.m_uiMaxFileSize));
+    const xiiUInt32 uiSize   = (xiiUInt32)xiiMath::Exp(fLogSize);
+
+    GenerateText(out_content, uiSize, desc.m_uiLineLength, desc.m_uiNonAsciiPercentage, desc.m_uiCrlfPercentage, rng);
+  }
+
+  // Returns the fastest of several runs, to reduce the noise
+  template <typename Function>
+  xiiTime MeasureBest(xiiUInt32 uiRuns, Function func)
+  {
+    xiiTime best = xiiTime::Hours(1);
+
+    for (xiiUInt32 i = 0; i < uiRuns; ++i)
+    {
+      const xiiTime start = xiiTime::Now();
+      func();
+      best = xiiMath::Min(best, xiiTime::Now() - start);
+    }
+
+    return best;
+  }
+
+  double GetMegaBytesPerSecond(xiiUInt64 uiBytes, xiiTime duration)
+  {
+    return uiBytes / (1024.0 * 1024.0) / xiiMath::Max(duration.GetSeconds(), 0.000001);
+  }
+} // namespace
+
+void RunUtf8Benchmark()
+{
+  constexpr xiiUInt32 uiTextSize = 16 * 1024 * 1024;
+  constexpr xiiUInt32 uiRuns     = 10;
+
+  const xiiLineCountScanner::Kernel defaultKernel = xiiLineCountScanner::GetKernel();
+
+  xiiDynamicArray<xiiUInt8> text;
+
+  for (xiiUInt32 uiNonAsciiPercentage : {0u, 1u, 10u})
+  {
+    GenerateText(text, uiTextSize, uiNonAsciiPercentage, 42);
+
+    const char* szStart = reinterpret_cast<const char*>(text.GetData());
+    const char* szEnd   = szStart + text.GetCount();
+
+    xiiLog::Info("Utf-8 benchmark: {0} MB, {1}% non-ASCII", uiTextSize / (1024 * 1024), uiNonAsciiPercentage);
+
+    // The sequence that LineCount used before: one pass to validate, one pass to count the characters
+    bool      bValid       = false;
+    xiiUInt64 uiCodePoints = 0;
+
+    const xiiTime twoPasses = MeasureBest(uiRuns, [&]()
+      {
+        bValid       = xiiUnicodeUtils::IsValidUtf8(szStart, szEnd);
+        uiCodePoints = xiiStringUtils::GetCharacterCount(szStart, szEnd);
+      });
+
+    xiiLog::Info("  IsValidUtf8 + GetCharacterCount: {0} ms, {1} MB/sec (valid: {2}, {3} code points)", xiiArgF(twoPasses.GetMilliseconds(), 2), xiiArgF(GetMegaBytesPerSecond(uiTextSize, twoPasses), 0), bValid, uiCodePoints);
+
+    for (xiiUInt32 k = 0; k <= (xiiUInt32)xiiLineCountScanner::Kernel::AVX2; ++k)
+    {
+      xiiLineCountScanner::SetKernel((xiiLineCountScanner::Kernel)k);
+
+      if ((xiiUInt32)xiiLineCountScanner::GetKernel() != k)
+        continue;
+
+      const xiiTime fused = MeasureBest(uiRuns, [&]()
+        {
+          xiiLineCountUtf8Validator validator;
+          validator.Process(text);
+          bValid       = validator.Finish();
+          uiCodePoints = validator.GetCodePointCount();
+        });
+
+      xiiLog::Info("  Fused validation ({0}): {1} ms, {2} MB/sec, {3}x (valid: {4}, {5} code points)", xiiLineCountScanner::GetKernelName(xiiLineCountScanner::GetKernel()), xiiArgF(fused.GetMilliseconds(), 2), xiiArgF(GetMegaBytesPerSecond(uiTextSize, fused), 0), xiiArgF(twoPasses.GetSeconds() / xiiMath::Max(fused.GetSeconds(), 0.000001), 2), bValid, uiCodePoints);
+    }
+  }
+
+  xiiLineCountScanner::SetKernel(defaultKernel);
+}
+
+xiiResult GenerateCorpus(const xiiLineCountCorpusDesc& desc, xiiStringView sRootDir, xiiStringBuilder& out_sCorpusDir)
+{
+  out_sCorpusDir = sRootDir;
+  out_sCorpusDir.AppendFormat("/Corpus-{0}-{1}-{2}-{3}-{4}-{5}-{6}-{7}", desc.m_uiFileCount, desc.m_uiMinFileSize, desc.m_uiMaxFileSize, desc.m_uiLineLength, desc.m_uiCrlfPercentage, desc.m_uiNonAsciiPercentage, desc.m_uiDirectoryDepth, desc.m_uiSeed);
+  out_sCorpusDir.MakeCleanPath();
+
+  xiiLog::Info("Generating {0} files in '{1}'", desc.m_uiFileCount, out_sCorpusDir);
+
+  xiiStringBuilder          sPath, sFile;
+  xiiDynamicArray<xiiUInt8> content;
+
+  for (xiiUInt32 i = 0; i < desc.m_uiFileCount; ++i)
+  {
+    GenerateCorpusFile(desc, i, sPath, content);
+
+    sFile = out_sCorpusDir;
+    sFile.AppendPath(sPath);
+
+    // Opening a file for writing creates all missing directories
+    xiiOSFile file;
+    XII_SUCCEED_OR_RETURN(file.Open(sFile, xiiFileOpenMode::Write));
+    XII_SUCCEED_OR_RETURN(file.Write(content.GetData(), content.GetCount()));
+  }
+
+  return XII_SUCCESS;
+}
+
+void RunFileStatsBenchmark(const xiiLineCountCorpusDesc& desc)
+{
+  constexpr xiiUInt32 uiRuns = 5;
+
+  const xiiLineCountScanner::Kernel defaultKernel = xiiLineCountScanner::GetKernel();
+
+  xiiDynamicArray<xiiDynamicArray<xiiUInt8>> files;
+  files.SetCount(desc.m_uiFileCount);
+
+  xiiStringBuilder sPath;
+  xiiUInt64        uiBytes = 0;
+
+  for (xiiUInt32 i = 0; i < desc.m_uiFileCount; ++i)
+  {
+    GenerateCorpusFile(desc, i, sPath, files[i]);
+    uiBytes += files[i].GetCount();
+  }
+
+  for (xiiUInt32 k = 0; k <= (xiiUInt32)xiiLineCountScanner::Kernel::AVX2; ++k)
+  {
+    xiiLineCountScanner::SetKernel((xiiLineCountScanner::Kernel)k);
+
+    if ((xiiUInt32)xiiLineCountScanner::GetKernel() != k)
+      continue;
+
+    // Classifying the corpus as C-family text shows how much telling comments from code costs
+    for (xiiLineCountLanguage language : {xiiLineCountLanguage::None, xiiLineCountLanguage::C})
+    {
+      FileStats stats;
+
+      const xiiTime duration = MeasureBest(uiRuns, [&]()
+        {
+          stats = FileStats();
+
+          for (const xiiDynamicArray<xiiUInt8>& file : files)
+          {
+            stats += GetFileStats(file, "Corpus", language);
+          }
+        });
+
+      xiiStringBuilder sVariant = xiiLineCountScanner::GetKernelName(xiiLineCountScanner::GetKernel());
+      if (language == xiiLineCountLanguage::C)
+        sVariant.Append("-classify");
+
+      LogBenchmarkResult("GetFileStats", sVariant.GetData(), desc.m_uiFileCount, uiBytes, duration);
+    }
+  }
+
+  xiiLineCountScanner::SetKernel(defaultKernel);
+}
+
+void LogBenchmarkResult(const char* szName, const char* szVariant, xiiUInt64 uiFiles, xiiUInt64 uiBytes, xiiTime duration)
+{
+  const double fSeconds = xiiMath::Max(duration.GetSeconds(), 0.000001);
+
+  xiiLog::Info("LineCountBenchmark: name={0} variant={1} files={2} bytes={3} seconds={4} mb_per_sec={5} files_per_sec={6}", szName, szVariant, uiFiles, uiBytes, xiiArgF(duration.GetSeconds(), 6), xiiArgF(GetMegaBytesPerSecond(uiBytes, duration), 1), xiiArgF(uiFiles / fSeconds, 0));
+}
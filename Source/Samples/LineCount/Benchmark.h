@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Foundation/Basics.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Time/Time.h>
+
+// Compares xiiLineCountUtf8Validator with all available kernels against xiiUnicodeUtils::IsValidUtf8() followed by
+// xiiStringUtils::GetCharacterCount() on generated text with different amounts of non-ASCII characters.
+void RunUtf8Benchmark();
+
+// Describes a synthetic source tree. The same description always produces exactly the same files.
+struct xiiLineCountCorpusDesc
+{
+  xiiUInt32 m_uiFileCount          = 2000;
+  xiiUInt32 m_uiMinFileSize        = 512;        // File sizes are distributed log-uniformly between min and max,
+  xiiUInt32 m_uiMaxFileSize        = 128 * 1024; // so that most files are small, like in real code bases
+  xiiUInt32 m_uiLineLength         = 40;         // Average number of bytes per line
+  xiiUInt32 m_uiCrlfPercentage     = 0;          // Percentage of lines that end with "\r\n" instead of "\n"
+  xiiUInt32 m_uiNonAsciiPercentage = 1;          // Percentage of tokens that are non-ASCII characters
+  xiiUInt32 m_uiDirectoryDepth     = 3;          // Files are spread over this many levels of sub-directories
+  xiiUInt32 m_uiSeed               = 42;
+};
+
+// Writes the files of the corpus into a sub-directory of sRootDir, which is named after the description, and returns its path.
+// Existing files with the same names are overwritten, nothing else is deleted.
+xiiResult GenerateCorpus(const xiiLineCountCorpusDesc& desc, xiiStringView sRootDir, xiiStringBuilder& out_sCorpusDir);
+
+// Measures GetFileStats() with all available kernels on the files of the corpus, which are generated in memory for this.
+void RunFileStatsBenchmark(const xiiLineCountCorpusDesc& desc);
+
+// Logs a benchmark result in a fixed 'key=value' format, which stays stable so that it can be compared across runs.
+void LogBenchmarkResult(const char* szName, const char* szVariant, xiiUInt64 uiFiles, xiiUInt64 uiBytes, xiiTime duration);
@@ -0,0 +1,59 @@
+#include <LineCount/CheckedReader.h>
+
+#include <Foundation/IO/FileSystem/FileReader.h>
+
+xiiResult xiiLineCountCheckedReader::Open(xiiStringView sFile)
+{
+  m_bFailed = false;
+  m_Data.Clear();
+
+  xiiFileReader file;
+  XII_SUCCEED_OR_RETURN(file.Open(sFile));
+
+  // The files are small compared to the trees that they describe, anything above 4 GB is not one of them
+  const xiiUInt64 uiSize = file.GetFileSize();
+  if (uiSize > 0xFFFFFFFFu)
+    return XII_FAILURE;
+
+  m_Data.SetCountUninitialized(static_cast<xiiUInt32>(uiSize));
+  if (file.ReadBytes(m_Data.GetData(), uiSize) != uiSize)
+    return XII_FAILURE;
+
+  m_Reader.Reset(m_Data.GetData(), m_Data.GetCount());
+  return XII_SUCCESS;
+}
+
+void xiiLineCountCheckedReader::ReadString(xiiStringBuilder& out_sString)
+{
+  out_sString.Clear();
+
+  xiiUInt32 uiLength = 0;
+  Read(uiLength);
+
+  if (uiLength == 0 || !Require(uiLength))
+    return;
+
+  out_sString.Set(xiiStringView(reinterpret_cast<const char*>(m_Data.GetData() + m_Reader.GetByteOffset()), uiLength));
+  m_Reader.SkipBytes(uiLength);
+}
+
+xiiUInt32 xiiLineCountCheckedReader::ReadCount(xiiUInt32 uiMinItemSize)
+{
+  xiiUInt32 uiCount = 0;
+  Read(uiCount);
+
+  if (!Require(static_cast<xiiUInt64>(uiCount) * uiMinItemSize))
+    return 0;
+
+  return uiCount;
+}
+
+bool xiiLineCountCheckedReader::Require(xiiUInt64 uiBytes)
+{
+  if (!m_bFailed && uiBytes > GetRemainingBytes())
+  {
+    m_bFailed = true;
+  }
+
+  return !m_bFailed;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+// Reads a binary file that LineCount wrote earlier (the stats cache or a shard result), without trusting it.
+//
+// The whole file is loaded first, so every read knows how much is left. A read past the end, or a count or string
+// length that can't possibly fit into the rest of the file, makes the reader fail instead of allocating for it. Once it
+// failed, all further reads return zeros, so a caller only has to check HasFailed() after a section instead of after
+// every value.
+class xiiLineCountCheckedReader
+{
+public:
+  xiiResult Open(xiiStringView sFile);
+
+  template <typename T>
+  void Read(T& out_value)
+  {
+    out_value = T();
+
+    if (Require(sizeof(T)))
+    {
+      m_Reader >> out_value;
+    }
+  }
+
+  // Reads a string that was written with xiiStreamWriter::WriteString()
+  void ReadString(xiiStringBuilder& out_sString);
+
+  // Reads the number of items that follow. Every item takes at least uiMinItemSize bytes, so a count that doesn't fit
+  // into the rest of the file means it is damaged.
+  xiiUInt32 ReadCount(xiiUInt32 uiMinItemSize);
+
+  bool      HasFailed() const { return m_bFailed; }
+  xiiUInt64 GetRemainingBytes() const { return m_Data.GetCount() - m_Reader.GetByteOffset(); }
+
+private:
+  bool Require(xiiUInt64 uiBytes);
+
+  xiiDynamicArray<xiiUInt8> m_Data;
+  xiiRawMemoryStreamReader  m_Reader;
+  bool                      m_bFailed = false;
+};
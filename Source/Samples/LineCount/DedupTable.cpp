@@ -0,0 +1,84 @@
+#include <LineCount/DedupTable.h>
+
+#include <Foundation/Threading/Lock.h>
+
+bool xiiLineCountDedupTable::Find(xiiUInt64 uiSize, xiiUInt64 uiHash, xiiLineCountLanguage language, FileStats& out_stats)
+{
+  Key key;
+  key.m_uiSize   = uiSize;
+  key.m_uiHash   = uiHash;
+  key.m_Language = language;
+
+  Stripe& stripe = GetStripe(uiHash);
+  XII_LOCK(stripe.m_Mutex);
+
+  const Entry* pEntry = stripe.m_Entries.GetValue(key);
+  if (pEntry == nullptr)
+    return false;
+
+  out_stats = pEntry->m_Stats;
+
+  ++stripe.m_uiDuplicateFiles;
+  stripe.m_uiDuplicateBytes += uiSize;
+  stripe.m_TimeSaved += pEntry->m_CountTime;
+  return true;
+}
+
+void xiiLineCountDedupTable::Store(xiiUInt64 uiSize, xiiUInt64 uiHash, xiiLineCountLanguage language, const FileStats& stats, xiiTime countTime)
+{
+  Key key;
+  key.m_uiSize   = uiSize;
+  key.m_uiHash   = uiHash;
+  key.m_Language = language;
+
+  Stripe& stripe = GetStripe(uiHash);
+  XII_LOCK(stripe.m_Mutex);
+
+  if (stripe.m_Entries.Contains(key))
+    return;
+
+  Entry entry;
+  entry.m_Stats     = stats;
+  entry.m_CountTime = countTime;
+
+  stripe.m_Entries.Insert(key, entry);
+}
+
+xiiUInt32 xiiLineCountDedupTable::GetDuplicateFiles() const
+{
+  xiiUInt32 uiFiles = 0;
+
+  for (const Stripe& stripe : m_Stripes)
+  {
+    XII_LOCK(stripe.m_Mutex);
+    uiFiles += stripe.m_uiDuplicateFiles;
+  }
+
+  return uiFiles;
+}
+
+xiiUInt64 xiiLineCountDedupTable::GetDuplicateBytes() const
+{
+  xiiUInt64 uiBytes = 0;
+
+  for (const Stripe& stripe : m_Stripes)
+  {
+    XII_LOCK(stripe.m_Mutex);
+    uiBytes += stripe.m_uiDuplicateBytes;
+  }
+
+  return uiBytes;
+}
+
+xiiTime xiiLineCountDedupTable::GetTimeSaved() const
+{
+  xiiTime saved;
+
+  for (const Stripe& stripe : m_Stripes)
+  {
+    XII_LOCK(stripe.m_Mutex);
+    saved += stripe.m_TimeSaved;
+  }
+
+  return saved;
+}
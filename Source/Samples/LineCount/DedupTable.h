@@ -0,0 +1,67 @@
+#pragma once
+
+#include <LineCount/Lexer.h>
+
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Threading/Mutex.h>
+
+// Remembers the stats of every file content that was counted, by its size and the hash of the content, so that
+// byte-identical copies of a file (e.g. the same headers vendored into several platform folders) only cost hashing
+// and a lookup.
+//
+// All workers share one table. It is split into stripes by hash, each with its own lock, so that the workers rarely
+// wait for each other. Two copies that are counted at the same time are both counted, the first result is kept.
+// The hash is a 64-bit non-cryptographic hash, so different contents of the same size are not expected to collide.
+class xiiLineCountDedupTable
+{
+public:
+  // Returns whether the content was counted before and if so, its stats. Also counts the duplicate.
+  bool Find(xiiUInt64 uiSize, xiiUInt64 uiHash, xiiLineCountLanguage language, FileStats& out_stats);
+
+  // Stores the stats of the content and how long it took to compute them.
+  void Store(xiiUInt64 uiSize, xiiUInt64 uiHash, xiiLineCountLanguage language, const FileStats& stats, xiiTime countTime);
+
+  // The duplicates that were found so far, how large they are, and how long it would have taken to count them
+  xiiUInt32 GetDuplicateFiles() const;
+  xiiUInt64 GetDuplicateBytes() const;
+  xiiTime   GetTimeSaved() const;
+
+private:
+  // The same content counts differently in another language
+  struct Key
+  {
+    xiiUInt64            m_uiSize   = 0;
+    xiiUInt64            m_uiHash   = 0;
+    xiiLineCountLanguage m_Language = xiiLineCountLanguage::Text;
+  };
+
+  struct KeyHash
+  {
+    static xiiUInt32 Hash(const Key& key) { return static_cast<xiiUInt32>(key.m_uiHash); }
+    static bool      Equal(const Key& a, const Key& b) { return a.m_uiHash == b.m_uiHash && a.m_uiSize == b.m_uiSize && a.m_Language == b.m_Language; }
+  };
+
+  struct Entry
+  {
+    FileStats m_Stats;
+    xiiTime   m_CountTime;
+  };
+
+  struct Stripe
+  {
+    mutable xiiMutex m_Mutex;
+
+    // Protected by m_Mutex
+    xiiHashTable<Key, Entry, KeyHash> m_Entries;
+    xiiUInt32                         m_uiDuplicateFiles = 0;
+    xiiUInt64                         m_uiDuplicateBytes = 0;
+    xiiTime                           m_TimeSaved;
+  };
+
+  static constexpr xiiUInt32 StripeCount = 16;
+
+  // The stripe is chosen by the high bits of the hash, the hash table uses the low ones
+  Stripe& GetStripe(xiiUInt64 uiHash) { return m_Stripes[(uiHash >> 60) % StripeCount]; }
+
+  Stripe m_Stripes[StripeCount];
+};
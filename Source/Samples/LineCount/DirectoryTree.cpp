@@ -0,0 +1,185 @@
+#include <LineCount/DirectoryTree.h>
+
+#include <Foundation/Math/Math.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Threading/TaskSystem.h>
+
+// Every invocation of this task is one worker that sums up directories of the current level.
+class xiiLineCountReduceTask final : public xiiTask
+{
+public:
+  xiiLineCountReduceTask(xiiLineCountDirectoryTree* pTree, xiiUInt32 uiWorkers) :
+    m_pTree(pTree)
+  {
+    ConfigureTask("LineCountReduce", xiiTaskNesting::Never);
+    SetMultiplicity(uiWorkers);
+  }
+
+private:
+  virtual void ExecuteWithMultiplicity(xiiUInt32 /*uiInvocation*/) const override
+  {
+    XII_PROFILE_SCOPE("ReduceLevel");
+    m_pTree->ReduceLevel();
+  }
+
+  xiiLineCountDirectoryTree* m_pTree;
+};
+
+void xiiLineCountDirectoryTree::Reset(xiiStringView sRootDir, xiiUInt32 uiMaxDepth)
+{
+  m_uiMaxDepth = xiiMath::Min(uiMaxDepth, MaxDepth);
+  m_Directories.Clear();
+  m_NextFile.Clear();
+  m_DirectoryIndices.Clear();
+  m_sLastDirectory.Clear();
+  m_uiLastDirectory = InvalidIndex;
+
+  m_Directories.ExpandAndGetRef();
+
+  m_sCleanPath = sRootDir;
+  m_sCleanPath.MakeCleanPath();
+  m_DirectoryIndices.Insert(m_sCleanPath, 0);
+}
+
+xiiUInt32 xiiLineCountDirectoryTree::FindDirectory(xiiStringView sDirectory)
+{
+  if (m_uiLastDirectory != InvalidIndex && sDirectory.IsEqual(m_sLastDirectory))
+    return m_uiLastDirectory;
+
+  m_sCleanPath = sDirectory;
+  m_sCleanPath.MakeCleanPath();
+
+  // Anything that wasn't added counts for the root, so the root always ends up with all files
+  xiiUInt32 uiDirectory = 0;
+  m_DirectoryIndices.TryGetValue(m_sCleanPath, uiDirectory);
+
+  m_sLastDirectory  = sDirectory;
+  m_uiLastDirectory = uiDirectory;
+  return uiDirectory;
+}
+
+void xiiLineCountDirectoryTree::AddDirectory(xiiStringView sParentDir, xiiStringView sName)
+{
+  const xiiUInt32 uiParent = FindDirectory(sParentDir);
+
+  m_sCleanPath = sParentDir;
+  m_sCleanPath.AppendPath(sName);
+  m_sCleanPath.MakeCleanPath();
+
+  // Deeper directories are merged into their ancestor at the maximum depth
+  if (m_Directories[uiParent].m_uiDepth >= m_uiMaxDepth)
+  {
+    m_DirectoryIndices.Insert(m_sCleanPath, uiParent);
+    return;
+  }
+
+  const xiiUInt32 uiDirectory = m_Directories.GetCount();
+  m_DirectoryIndices.Insert(m_sCleanPath, uiDirectory);
+
+  Directory& dir    = m_Directories.ExpandAndGetRef();
+  Directory& parent = m_Directories[uiParent];
+
+  if (parent.m_sPath.IsEmpty())
+  {
+    dir.m_sPath = sName;
+  }
+  else
+  {
+    m_sCleanPath.Set(parent.m_sPath, "/", sName);
+    dir.m_sPath = m_sCleanPath;
+  }
+
+  dir.m_uiDepth         = parent.m_uiDepth + 1;
+  dir.m_uiNextSibling   = parent.m_uiFirstChild;
+  parent.m_uiFirstChild = uiDirectory;
+}
+
+void xiiLineCountDirectoryTree::AddFile(xiiStringView sDirectory)
+{
+  Directory& dir = m_Directories[FindDirectory(sDirectory)];
+
+  // The order within a directory doesn't matter for the sums, so files are added at the front of its list
+  m_NextFile.PushBack(dir.m_uiFirstFile);
+  dir.m_uiFirstFile = m_NextFile.GetCount() - 1;
+}
+
+void xiiLineCountDirectoryTree::Reduce(const FileStatsFunc& getFileStats, xiiUInt32 uiThreads)
+{
+  XII_PROFILE_SCOPE("ReduceDirectories");
+
+  // Sort the directories by depth with a counting sort, so that every level is one range of m_Levels
+  xiiUInt32       uiLevelStart[MaxDepth + 3] = {};
+  const xiiUInt32 uiLevels                   = m_uiMaxDepth + 1;
+
+  for (const Directory& dir : m_Directories)
+  {
+    ++uiLevelStart[dir.m_uiDepth + 2];
+  }
+
+  for (xiiUInt32 i = 2; i <= uiLevels; ++i)
+  {
+    uiLevelStart[i] += uiLevelStart[i - 1];
+  }
+
+  m_Levels.SetCountUninitialized(m_Directories.GetCount());
+
+  for (xiiUInt32 i = 0; i < m_Directories.GetCount(); ++i)
+  {
+    m_Levels[uiLevelStart[m_Directories[i].m_uiDepth + 1]++] = i;
+  }
+
+  // Now uiLevelStart[d] is where level d starts and uiLevelStart[d + 1] where it ends
+  m_pGetFileStats = &getFileStats;
+
+  xiiSharedPtr<xiiTask> pTask;
+  if (uiThreads > 1)
+  {
+    pTask = XII_DEFAULT_NEW(xiiLineCountReduceTask, this, uiThreads);
+  }
+
+  for (xiiUInt32 uiDepth = uiLevels; uiDepth-- > 0;)
+  {
+    m_Level = m_Levels.GetArrayPtr().GetSubArray(uiLevelStart[uiDepth], uiLevelStart[uiDepth + 1] - uiLevelStart[uiDepth]);
+    m_iNextDirectory.Set(0);
+
+    // The levels near the root only have a few directories, those aren't worth waking up the workers
+    if (pTask == nullptr || m_Level.GetCount() < 2)
+    {
+      ReduceLevel();
+    }
+    else
+    {
+      xiiTaskSystem::WaitForGroup(xiiTaskSystem::StartSingleTask(pTask, xiiTaskPriority::LongRunningHighPriority));
+    }
+  }
+
+  m_pGetFileStats = nullptr;
+}
+
+void xiiLineCountDirectoryTree::ReduceLevel()
+{
+  // Directories are taken one at a time, since the number of files in them differs a lot. Each worker only writes the
+  // directories that it took, and only reads the level below, which is complete.
+  while (true)
+  {
+    const xiiUInt32 uiIndex = static_cast<xiiUInt32>(m_iNextDirectory.PostIncrement());
+
+    if (uiIndex >= m_Level.GetCount())
+      return;
+
+    Directory& dir = m_Directories[m_Level[uiIndex]];
+    FileStats  stats;
+
+    for (xiiUInt32 uiFile = dir.m_uiFirstFile; uiFile != InvalidIndex; uiFile = m_NextFile[uiFile])
+    {
+      (*m_pGetFileStats)(uiFile, stats);
+    }
+
+    for (xiiUInt32 uiChild = dir.m_uiFirstChild; uiChild != InvalidIndex; uiChild = m_Directories[uiChild].m_uiNextSibling)
+    {
+      stats += m_Directories[uiChild].m_Stats;
+    }
+
+    dir.m_Stats = stats;
+  }
+}
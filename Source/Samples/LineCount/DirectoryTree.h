@@ -0,0 +1,87 @@
+#pragma once
+
+#include <LineCount/FileStats.h>
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Types/Delegate.h>
+
+class xiiLineCountReduceTask;
+
+// The stats of every directory below the search directory, each including everything in its subdirectories.
+//
+// The tree is built while the files are enumerated, but it only records which file is in which directory, the stats
+// are filled in afterwards by Reduce(). Directories that are deeper than the requested depth are not tracked on their
+// own, their files count for their parent at that depth. So the tree only ever has as many nodes as the report has
+// rows, and recording a file costs one array entry.
+//
+// Not thread-safe while it is built, the enumerating thread is the only one that adds to it.
+class xiiLineCountDirectoryTree
+{
+public:
+  static constexpr xiiUInt32 InvalidIndex = 0xFFFFFFFFu;
+  static constexpr xiiUInt32 MaxDepth     = 64;
+
+  // Adds the stats of a file to inout_stats, by the number that it got in AddFile()
+  using FileStatsFunc = xiiDelegate<void(xiiUInt32 uiFile, FileStats& inout_stats)>;
+
+  // Starts a new tree with only the given directory, which is the root with depth zero. Directories up to uiMaxDepth
+  // (at most MaxDepth) levels below it are tracked.
+  void Reset(xiiStringView sRootDir, xiiUInt32 uiMaxDepth);
+
+  // Adds a directory that was found in sParentDir. Parents have to be added before their children, which is the order
+  // in which a directory iterator finds them anyway.
+  void AddDirectory(xiiStringView sParentDir, xiiStringView sName);
+
+  // Adds a file that is directly in sDirectory. Files are numbered in the order in which they are added, starting at zero.
+  void AddFile(xiiStringView sDirectory);
+
+  // Computes the stats of all directories, bottom-up. The directories of one level only depend on the level below, so
+  // each level is summed up in parallel, starting with the deepest one.
+  void Reduce(const FileStatsFunc& getFileStats, xiiUInt32 uiThreads);
+
+  // The directories in the order in which they were added, the root is always the first one
+  xiiUInt32        GetCount() const { return m_Directories.GetCount(); }
+  xiiStringView    GetPath(xiiUInt32 uiDirectory) const { return m_Directories[uiDirectory].m_sPath; } // Relative to the root, with '/'
+  xiiUInt32        GetDepth(xiiUInt32 uiDirectory) const { return m_Directories[uiDirectory].m_uiDepth; }
+  const FileStats& GetStats(xiiUInt32 uiDirectory) const { return m_Directories[uiDirectory].m_Stats; }
+
+private:
+  friend class xiiLineCountReduceTask;
+
+  struct Directory
+  {
+    xiiString m_sPath;
+    xiiUInt32 m_uiDepth       = 0;
+    xiiUInt32 m_uiFirstChild  = InvalidIndex;
+    xiiUInt32 m_uiNextSibling = InvalidIndex;
+    xiiUInt32 m_uiFirstFile   = InvalidIndex; // The files directly in the directory (or in untracked subdirectories) are a list through m_NextFile
+    FileStats m_Stats;
+  };
+
+  // Returns the directory that tracks the files in sDirectory, looking it up by its clean absolute path
+  xiiUInt32 FindDirectory(xiiStringView sDirectory);
+
+  // Sums up the directories of the current level until none are left, called by every worker
+  void ReduceLevel();
+
+  xiiUInt32                  m_uiMaxDepth = 0;
+  xiiDynamicArray<Directory> m_Directories;
+  xiiDynamicArray<xiiUInt32> m_NextFile; // By file number, the next file in the same directory
+
+  // All directories that were found, also those deeper than m_uiMaxDepth, by their clean absolute path
+  xiiHashTable<xiiString, xiiUInt32> m_DirectoryIndices;
+  xiiStringBuilder                   m_sCleanPath;
+
+  // Files come in runs of the same directory, so the last lookup is remembered
+  xiiString m_sLastDirectory;
+  xiiUInt32 m_uiLastDirectory = InvalidIndex;
+
+  // While reducing: the directories of the current level, and the next one that a worker takes
+  const FileStatsFunc*       m_pGetFileStats = nullptr;
+  xiiDynamicArray<xiiUInt32> m_Levels;
+  xiiArrayPtr<xiiUInt32>     m_Level;
+  xiiAtomicInteger32         m_iNextDirectory;
+};
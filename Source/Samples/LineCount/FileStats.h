@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Foundation/Basics.h>
+#include <Foundation/Containers/Map.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Time/Time.h>
+
+// The statistics that LineCount gathers, either for a single file or accumulated over many files
+struct FileStats
+{
+  FileStats()
+  {
+    m_uiFileCount    = 0;
+    m_uiLines        = 0;
+    m_uiEmptyLines   = 0;
+    m_uiBytes        = 0;
+    m_uiCharacters   = 0;
+    m_uiWords        = 0;
+    m_uiCodeLines    = 0;
+    m_uiCommentLines = 0;
+    m_uiMixedLines   = 0;
+  }
+
+  void operator+=(const FileStats& rhs)
+  {
+    m_uiFileCount += rhs.m_uiFileCount;
+    m_uiLines += rhs.m_uiLines;
+    m_uiEmptyLines += rhs.m_uiEmptyLines;
+    m_uiBytes += rhs.m_uiBytes;
+    m_uiCharacters += rhs.m_uiCharacters;
+    m_uiWords += rhs.m_uiWords;
+    m_uiCodeLines += rhs.m_uiCodeLines;
+    m_uiCommentLines += rhs.m_uiCommentLines;
+    m_uiMixedLines += rhs.m_uiMixedLines;
+  }
+
+  void operator-=(const FileStats& rhs)
+  {
+    m_uiFileCount -= rhs.m_uiFileCount;
+    m_uiLines -= rhs.m_uiLines;
+    m_uiEmptyLines -= rhs.m_uiEmptyLines;
+    m_uiBytes -= rhs.m_uiBytes;
+    m_uiCharacters -= rhs.m_uiCharacters;
+    m_uiWords -= rhs.m_uiWords;
+    m_uiCodeLines -= rhs.m_uiCodeLines;
+    m_uiCommentLines -= rhs.m_uiCommentLines;
+    m_uiMixedLines -= rhs.m_uiMixedLines;
+  }
+
+  // All counters are 64-bit, since sums over large trees easily exceed 4 billion bytes (or words, or characters)
+  xiiUInt64 m_uiFileCount;
+  xiiUInt64 m_uiLines;
+  xiiUInt64 m_uiEmptyLines;
+  xiiUInt64 m_uiBytes;
+  xiiUInt64 m_uiCharacters;
+  xiiUInt64 m_uiWords;
+
+  // Every non-empty line is exactly one of these, so together they add up to m_uiLines
+  xiiUInt64 m_uiCodeLines;    // Lines with code, but no comments
+  xiiUInt64 m_uiCommentLines; // Lines with comments, but no code
+  xiiUInt64 m_uiMixedLines;   // Lines with both code and comments
+};
+
+// Stats per file extension, sorted by extension name
+using FileTypeStatsMap = xiiMap<xiiString, FileStats>;
+
+// How much time was spent in the phases of computing file stats, summed over all files (and threads)
+struct ScanTimings
+{
+  void operator+=(const ScanTimings& rhs)
+  {
+    m_Read += rhs.m_Read;
+    m_Hash += rhs.m_Hash;
+    m_Validate += rhs.m_Validate;
+    m_Count += rhs.m_Count;
+  }
+
+  xiiTime m_Read;     // Opening and reading files. For memory-mapped files, reading actually happens while validating.
+  xiiTime m_Hash;     // Hashing complete files for the cache or for finding duplicates
+  xiiTime m_Validate; // Utf-8 validation, including counting characters and finding the end of the text
+  xiiTime m_Count;    // Counting lines, words and bytes
+};
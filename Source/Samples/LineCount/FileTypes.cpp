@@ -0,0 +1,200 @@
+#include <LineCount/FileTypes.h>
+
+#include <Foundation/Containers/HybridArray.h>
+
+namespace
+{
+  using Table = xiiLineCountFileTypes::Table;
+
+  constexpr const char* s_szDefaultExtensions[] = {
+    // C and C++
+    "c", "cc", "cpp", "cxx", "c++", "cppm", "ixx", "h", "hh", "hpp", "hxx", "h++", "inl", "ipp", "tpp", "inc",
+    // Shaders
+    "hlsl", "hlsli", "fx", "fxh", "glsl", "vert", "frag", "comp", "xiishader"};
+
+  // All default extensions use C-style comments, xiiShader files additionally consist of sections
+  constexpr xiiLineCountLanguage GetDefaultLanguage(const char* szExtension)
+  {
+    const char* szShader = "xiishader";
+
+    for (xiiUInt32 i = 0;; ++i)
+    {
+      if (szExtension[i] != szShader[i])
+        return xiiLineCountLanguage::C;
+
+      if (szExtension[i] == '\0')
+        return xiiLineCountLanguage::XiiShader;
+    }
+  }
+
+  constexpr char ToLower(char c)
+  {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+  }
+
+  // FNV-1a over the lower-case characters, mixed with the seed
+  constexpr xiiUInt32 GetSlot(const char* szExtension, xiiUInt32 uiLength, xiiUInt32 uiSeed)
+  {
+    xiiUInt32 uiHash = 2166136261u ^ (uiSeed * 0x9E3779B9u);
+
+    for (xiiUInt32 i = 0; i < uiLength; ++i)
+    {
+      uiHash ^= static_cast<xiiUInt8>(ToLower(szExtension[i]));
+      uiHash *= 16777619u;
+    }
+
+    uiHash ^= uiHash >> 15;
+    return uiHash & (xiiLineCountFileTypes::SlotCount - 1);
+  }
+
+  // Builds the table for extensions that are already lower-case, unique and short enough
+  constexpr Table BuildTable(const char* const* pExtensions, const xiiUInt32* pLengths, const xiiLineCountLanguage* pLanguages, xiiUInt32 uiCount)
+  {
+    Table table;
+    table.m_uiCount = uiCount;
+
+    for (xiiUInt32 i = 0; i < uiCount; ++i)
+    {
+      table.m_uiLengths[i] = static_cast<xiiUInt8>(pLengths[i]);
+      table.m_Languages[i] = pLanguages[i];
+
+      for (xiiUInt32 c = 0; c < pLengths[i]; ++c)
+      {
+        table.m_szExtensions[i][c] = pExtensions[i][c];
+      }
+    }
+
+    // Try seeds until there is no collision. With at most MaxTypes extensions in SlotCount slots, this takes few attempts.
+    for (xiiUInt32 uiSeed = 0;; ++uiSeed)
+    {
+      for (xiiUInt32 s = 0; s < xiiLineCountFileTypes::SlotCount; ++s)
+      {
+        table.m_uiSlots[s] = 0;
+      }
+
+      bool bCollision = false;
+
+      for (xiiUInt32 i = 0; i < uiCount && !bCollision; ++i)
+      {
+        xiiUInt8& uiSlot = table.m_uiSlots[GetSlot(pExtensions[i], pLengths[i], uiSeed)];
+
+        bCollision = uiSlot != 0;
+        uiSlot     = static_cast<xiiUInt8>(i + 1);
+      }
+
+      if (!bCollision)
+      {
+        table.m_uiSeed = uiSeed;
+        return table;
+      }
+    }
+  }
+
+  constexpr Table BuildDefaultTable()
+  {
+    constexpr xiiUInt32 uiCount = XII_ARRAY_SIZE(s_szDefaultExtensions);
+
+    xiiUInt32            uiLengths[uiCount]  = {};
+    xiiLineCountLanguage languages[uiCount] = {};
+
+    for (xiiUInt32 i = 0; i < uiCount; ++i)
+    {
+      while (s_szDefaultExtensions[i][uiLengths[i]] != '\0')
+        ++uiLengths[i];
+
+      languages[i] = GetDefaultLanguage(s_szDefaultExtensions[i]);
+    }
+
+    return BuildTable(s_szDefaultExtensions, uiLengths, languages, uiCount);
+  }
+
+  constexpr Table s_DefaultTable = BuildDefaultTable();
+
+  static_assert(XII_ARRAY_SIZE(s_szDefaultExtensions) <= xiiLineCountFileTypes::MaxTypes, "Too many default extensions");
+
+  xiiUInt32 FindInTable(const Table& table, xiiStringView sExtension)
+  {
+    const xiiUInt32 uiLength = sExtension.GetElementCount();
+
+    if (uiLength > xiiLineCountFileTypes::MaxExtensionLength)
+      return xiiLineCountFileTypes::InvalidIndex;
+
+    const xiiUInt8 uiSlot = table.m_uiSlots[GetSlot(sExtension.GetStartPointer(), uiLength, table.m_uiSeed)];
+
+    if (uiSlot == 0)
+      return xiiLineCountFileTypes::InvalidIndex;
+
+    const xiiUInt32 uiIndex = uiSlot - 1u;
+
+    if (table.m_uiLengths[uiIndex] != uiLength)
+      return xiiLineCountFileTypes::InvalidIndex;
+
+    for (xiiUInt32 c = 0; c < uiLength; ++c)
+    {
+      if (ToLower(sExtension.GetStartPointer()[c]) != table.m_szExtensions[uiIndex][c])
+        return xiiLineCountFileTypes::InvalidIndex;
+    }
+
+    return uiIndex;
+  }
+} // namespace
+
+xiiLineCountFileTypes::xiiLineCountFileTypes() :
+  m_Table(s_DefaultTable)
+{
+}
+
+xiiResult xiiLineCountFileTypes::SetExtensions(xiiStringView sExtensions)
+{
+  xiiHybridArray<xiiStringView, 16> parts;
+  sExtensions.Split(false, parts, ";", ",");
+
+  char                 szExtensions[MaxTypes][MaxExtensionLength + 1] = {};
+  const char*          pExtensions[MaxTypes]                          = {};
+  xiiUInt32            uiLengths[MaxTypes]                            = {};
+  xiiLineCountLanguage languages[MaxTypes]                            = {};
+  xiiUInt32            uiCount                                        = 0;
+
+  for (xiiStringView sPart : parts)
+  {
+    sPart.Trim(" \t.");
+
+    if (sPart.IsEmpty())
+      continue;
+
+    if (uiCount == MaxTypes || sPart.GetElementCount() > MaxExtensionLength)
+      return XII_FAILURE;
+
+    for (xiiUInt32 c = 0; c < sPart.GetElementCount(); ++c)
+    {
+      szExtensions[uiCount][c] = ToLower(sPart.GetStartPointer()[c]);
+    }
+
+    // Duplicates would collide with themselves, so they are skipped
+    const xiiStringView sLower(szExtensions[uiCount], sPart.GetElementCount());
+
+    bool bDuplicate = false;
+    for (xiiUInt32 i = 0; i < uiCount; ++i)
+    {
+      bDuplicate |= sLower == xiiStringView(szExtensions[i], uiLengths[i]);
+    }
+
+    if (bDuplicate)
+      continue;
+
+    const xiiUInt32 uiDefault = FindInTable(s_DefaultTable, sLower);
+
+    pExtensions[uiCount] = szExtensions[uiCount];
+    uiLengths[uiCount]   = sPart.GetElementCount();
+    languages[uiCount]   = uiDefault != InvalidIndex ? s_DefaultTable.m_Languages[uiDefault] : xiiLineCountLanguage::Text;
+    ++uiCount;
+  }
+
+  m_Table = BuildTable(pExtensions, uiLengths, languages, uiCount);
+  return XII_SUCCESS;
+}
+
+xiiUInt32 xiiLineCountFileTypes::Find(xiiStringView sExtension) const
+{
+  return FindInTable(m_Table, sExtension);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <LineCount/Lexer.h>
+
+#include <Foundation/Strings/StringView.h>
+
+// The set of file extensions that LineCount scans. Every extension gets an index, which is used to look up its stats directly.
+//
+// Extensions are found through a perfect hash: a seed is chosen such that no two extensions of the set end up in the
+// same slot, so a lookup is one hash, one table read and one string compare, no matter how many extensions there are.
+// For the built-in default set, the table is computed at compile time.
+//
+// Every extension also has the language that its comments are recognized in. Extensions of the default set keep
+// their language when they are passed in through SetExtensions(), all others are counted as plain text.
+class xiiLineCountFileTypes
+{
+public:
+  static constexpr xiiUInt32 MaxTypes           = 64;
+  static constexpr xiiUInt32 MaxExtensionLength = 15;
+  static constexpr xiiUInt32 SlotCount          = 512;
+  static constexpr xiiUInt32 InvalidIndex       = 0xFFFFFFFF;
+
+  // The perfect hash table over a set of lower-case extensions
+  struct Table
+  {
+    char                 m_szExtensions[MaxTypes][MaxExtensionLength + 1] = {};
+    xiiUInt8             m_uiLengths[MaxTypes]                            = {};
+    xiiLineCountLanguage m_Languages[MaxTypes]                            = {};
+    xiiUInt8             m_uiSlots[SlotCount]                             = {}; // Index of the extension + 1, zero for empty slots
+    xiiUInt32            m_uiCount                                        = 0;
+    xiiUInt32            m_uiSeed                                         = 0;
+  };
+
+  // Starts out with the built-in default set (C/C++ sources and headers and shaders).
+  xiiLineCountFileTypes();
+
+  // Replaces the set with the given extensions, separated by ';' or ','. Leading dots are ignored.
+  // Fails if there are more than MaxTypes extensions or one of them is longer than MaxExtensionLength, then the set is left unchanged.
+  xiiResult SetExtensions(xiiStringView sExtensions);
+
+  // Returns the number of extensions in the set.
+  xiiUInt32 GetCount() const { return m_Table.m_uiCount; }
+
+  // Returns the lower-case extension with the given index.
+  xiiStringView GetExtension(xiiUInt32 uiIndex) const { return xiiStringView(m_Table.m_szExtensions[uiIndex], m_Table.m_uiLengths[uiIndex]); }
+
+  // Returns the language of the extension with the given index.
+  xiiLineCountLanguage GetLanguage(xiiUInt32 uiIndex) const { return m_Table.m_Languages[uiIndex]; }
+
+  // Returns the index of the given extension (ignoring case), or InvalidIndex if it is not part of the set.
+  xiiUInt32 Find(xiiStringView sExtension) const;
+
+private:
+  Table m_Table;
+};
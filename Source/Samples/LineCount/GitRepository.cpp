@@ -0,0 +1,764 @@
+#include <LineCount/GitRepository.h>
+#include <LineCount/Inflate.h>
+
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Strings/PathUtils.h>
+
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE) && XII_ENABLED(XII_SUPPORTS_FILE_ITERATORS)
+
+namespace
+{
+  using ObjectId   = xiiLineCountGitRepository::ObjectId;
+  using ObjectType = xiiLineCountGitRepository::ObjectType;
+
+  constexpr xiiUInt32 s_uiIndexMagic = 0xFF744F63; // '\377tOc'
+  constexpr xiiUInt32 s_uiPackMagic  = 0x5041434B; // 'PACK'
+
+  // The types of pack entries that are stored as deltas, in addition to the object types
+  constexpr xiiUInt32 s_uiOffsetDelta = 6; // Against an earlier entry of the same pack, given by its distance
+  constexpr xiiUInt32 s_uiRefDelta    = 7; // Against another object, given by its id
+
+  // The names of the object types in the headers of loose objects, by ObjectType
+  constexpr const char* s_szTypeNames[] = {"", "commit", "tree", "blob", "tag"};
+
+  XII_ALWAYS_INLINE xiiUInt32 ReadBigEndian32(const xiiUInt8* p)
+  {
+    return (static_cast<xiiUInt32>(p[0]) << 24) | (static_cast<xiiUInt32>(p[1]) << 16) | (static_cast<xiiUInt32>(p[2]) << 8) | p[3];
+  }
+
+  XII_ALWAYS_INLINE xiiUInt64 ReadBigEndian64(const xiiUInt8* p)
+  {
+    return (static_cast<xiiUInt64>(ReadBigEndian32(p)) << 32) | ReadBigEndian32(p + 4);
+  }
+
+  XII_ALWAYS_INLINE xiiInt32 GetHexDigit(char c)
+  {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  // The compressed data of a pack entry continues up to the end of the pack at most
+  xiiArrayPtr<const xiiUInt8> GetCompressedData(const xiiUInt8* p, const xiiUInt8* pEnd)
+  {
+    return xiiArrayPtr<const xiiUInt8>(p, static_cast<xiiUInt32>(xiiMath::Min<xiiUInt64>(pEnd - p, xiiMath::MaxValue<xiiUInt32>())));
+  }
+
+  // Reads a size at the start of a delta, 7 bits per byte with the least significant ones first
+  bool ReadDeltaSize(const xiiUInt8*& ref_p, const xiiUInt8* pEnd, xiiUInt64& out_uiSize)
+  {
+    out_uiSize = 0;
+
+    for (xiiUInt32 uiShift = 0; ref_p < pEnd && uiShift < 64; uiShift += 7)
+    {
+      const xiiUInt8 uiByte = *ref_p++;
+      out_uiSize |= static_cast<xiiUInt64>(uiByte & 0x7F) << uiShift;
+
+      if ((uiByte & 0x80) == 0)
+        return true;
+    }
+
+    return false;
+  }
+
+  // Finds a header line like 'tree <id>' in a commit or 'object <id>' in a tag. The headers end at the first empty line.
+  xiiResult FindHeaderId(xiiArrayPtr<const xiiUInt8> data, xiiStringView sKey, ObjectId& out_id)
+  {
+    const char* p    = reinterpret_cast<const char*>(data.GetPtr());
+    const char* pEnd = p + data.GetCount();
+
+    while (p < pEnd && *p != '\n')
+    {
+      const char* pLineEnd = p;
+      while (pLineEnd < pEnd && *pLineEnd != '\n')
+        ++pLineEnd;
+
+      const xiiStringView sLine(p, pLineEnd);
+
+      if (sLine.StartsWith(sKey) && sLine.GetElementCount() > sKey.GetElementCount() && p[sKey.GetElementCount()] == ' ')
+        return xiiLineCountGitRepository::ParseObjectId(xiiStringView(p + sKey.GetElementCount() + 1, pLineEnd), out_id);
+
+      p = pLineEnd + 1;
+    }
+
+    return XII_FAILURE;
+  }
+
+  void ReadTextFile(xiiStringView sFile, xiiStringBuilder& out_sContent)
+  {
+    out_sContent.Clear();
+
+    xiiFileReader file;
+    if (file.Open(sFile).Succeeded())
+    {
+      out_sContent.ReadAll(file);
+      out_sContent.Trim(" \t\r\n");
+    }
+  }
+} // namespace
+
+bool xiiLineCountGitRepository::ObjectId::operator==(const ObjectId& other) const
+{
+  return xiiMemoryUtils::IsEqual(m_uiBytes, other.m_uiBytes, 20);
+}
+
+xiiUInt32 xiiLineCountGitRepository::ObjectIdHash::Hash(const ObjectId& id)
+{
+  // The ids are hashes themselves, so any part of them is evenly distributed
+  return ReadBigEndian32(id.m_uiBytes);
+}
+
+xiiResult xiiLineCountGitRepository::Open(xiiStringView sDirectory)
+{
+  m_sGitDir.Clear();
+  m_Packs.Clear();
+  m_Cache.Clear();
+  m_uiCachedBytes       = 0;
+  m_uiLooseObjectReads  = 0;
+  m_uiPackedObjectReads = 0;
+  m_uiDeltas            = 0;
+
+  xiiStringBuilder sGitDir = sDirectory;
+  sGitDir.AppendPath(".git");
+  sGitDir.MakeCleanPath();
+
+  if (xiiOSFile::ExistsFile(sGitDir))
+  {
+    // In submodules, '.git' is a file that refers to the actual directory, e.g. 'gitdir: ../.git/modules/name'
+    xiiStringBuilder sContent;
+    ReadTextFile(sGitDir, sContent);
+
+    if (!sContent.StartsWith("gitdir:"))
+      return XII_FAILURE;
+
+    sContent.Shrink(7, 0);
+    sContent.Trim(" \t");
+
+    if (xiiPathUtils::IsAbsolutePath(sContent))
+    {
+      sGitDir = sContent;
+    }
+    else
+    {
+      sGitDir = sDirectory;
+      sGitDir.AppendPath(sContent);
+    }
+
+    sGitDir.MakeCleanPath();
+  }
+  else if (!xiiOSFile::ExistsDirectory(sGitDir))
+  {
+    // The directory may be the '.git' directory itself or a bare repository
+    sGitDir = sDirectory;
+    sGitDir.MakeCleanPath();
+  }
+
+  xiiStringBuilder sPackDir = sGitDir;
+  sPackDir.AppendPath("objects");
+
+  if (!xiiOSFile::ExistsDirectory(sPackDir))
+    return XII_FAILURE;
+
+  m_sGitDir = sGitDir;
+
+  // Every pack comes with an index file of the same name
+  sPackDir.AppendPath("pack");
+
+  xiiFileSystemIterator it;
+  it.StartSearch(sPackDir, xiiFileSystemIteratorFlags::ReportFiles);
+
+  xiiStringBuilder sIndexFile;
+
+  for (; it.IsValid(); it.Next())
+  {
+    if (!it.GetStats().m_sName.EndsWith(".idx"))
+      continue;
+
+    sIndexFile = it.GetCurrentPath();
+    sIndexFile.AppendPath(it.GetStats().m_sName);
+
+    if (OpenPack(m_Packs.ExpandAndGetRef(), sIndexFile).Failed())
+    {
+      xiiLog::Warning("Skipping the unsupported or invalid pack index '{0}'", sIndexFile);
+      m_Packs.PopBack();
+    }
+  }
+
+  return XII_SUCCESS;
+}
+
+xiiResult xiiLineCountGitRepository::OpenPack(Pack& ref_pack, xiiStringView sIndexFile)
+{
+  xiiStringBuilder sPackFile = sIndexFile;
+  sPackFile.ChangeFileExtension("pack");
+
+  XII_SUCCEED_OR_RETURN(ref_pack.m_IndexFile.Open(sIndexFile, xiiMemoryMappedFile::Mode::ReadOnly));
+  XII_SUCCEED_OR_RETURN(ref_pack.m_PackFile.Open(sPackFile, xiiMemoryMappedFile::Mode::ReadOnly));
+
+  // Only version 2 of the index format is supported, which git writes by default since 2007.
+  // It consists of the fan-out table, the ids, their CRCs, their offsets, the 64-bit offsets and two checksums.
+  const xiiUInt8* pIndex       = static_cast<const xiiUInt8*>(ref_pack.m_IndexFile.GetReadPointer());
+  const xiiUInt64 uiIndexSize  = ref_pack.m_IndexFile.GetFileSize();
+  const xiiUInt64 uiHeaderSize = 8 + 256 * 4;
+
+  if (uiIndexSize < uiHeaderSize + 40 || ReadBigEndian32(pIndex) != s_uiIndexMagic || ReadBigEndian32(pIndex + 4) != 2)
+    return XII_FAILURE;
+
+  ref_pack.m_pFanout   = pIndex + 8;
+  ref_pack.m_uiObjects = ReadBigEndian32(ref_pack.m_pFanout + 255 * 4);
+
+  const xiiUInt64 uiTablesSize = uiHeaderSize + static_cast<xiiUInt64>(ref_pack.m_uiObjects) * (20 + 4 + 4) + 40;
+
+  if (uiIndexSize < uiTablesSize || (uiIndexSize - uiTablesSize) % 8 != 0)
+    return XII_FAILURE;
+
+  ref_pack.m_pIds        = ref_pack.m_pFanout + 256 * 4;
+  ref_pack.m_pOffsets    = ref_pack.m_pIds + ref_pack.m_uiObjects * (20 + 4);
+  ref_pack.m_pOffsets64  = ref_pack.m_pOffsets + ref_pack.m_uiObjects * 4;
+  ref_pack.m_uiOffsets64 = static_cast<xiiUInt32>((uiIndexSize - uiTablesSize) / 8);
+
+  // The pack starts with a header and ends with a checksum
+  const xiiUInt8* pPack      = static_cast<const xiiUInt8*>(ref_pack.m_PackFile.GetReadPointer());
+  const xiiUInt64 uiPackSize = ref_pack.m_PackFile.GetFileSize();
+
+  if (uiPackSize < 12 + 20 || ReadBigEndian32(pPack) != s_uiPackMagic || (ReadBigEndian32(pPack + 4) != 2 && ReadBigEndian32(pPack + 4) != 3))
+    return XII_FAILURE;
+
+  ref_pack.m_pData      = pPack;
+  ref_pack.m_uiDataSize = uiPackSize - 20;
+  return XII_SUCCESS;
+}
+
+xiiResult xiiLineCountGitRepository::ResolveRevision(xiiStringView sRevision, ObjectId& out_commitId)
+{
+  ObjectId id;
+
+  if (ParseObjectId(sRevision, id).Failed())
+  {
+    // The same places that 'git rev-parse' looks at, in the same order
+    struct RefPattern
+    {
+      const char* m_szPrefix;
+      const char* m_szSuffix;
+    };
+
+    constexpr RefPattern s_Patterns[] = {{"", ""}, {"refs/", ""}, {"refs/tags/", ""}, {"refs/heads/", ""}, {"refs/remotes/", ""}, {"refs/remotes/", "/HEAD"}};
+
+    xiiStringBuilder sName;
+    bool             bFound = false;
+
+    for (const RefPattern& pattern : s_Patterns)
+    {
+      sName.Set(pattern.m_szPrefix, sRevision, pattern.m_szSuffix);
+
+      if (ReadRef(sName, id, 0).Succeeded())
+      {
+        bFound = true;
+        break;
+      }
+    }
+
+    if (!bFound)
+      return XII_FAILURE;
+  }
+
+  // Annotated tags are objects of their own, which refer to the tagged object (possibly another tag)
+  xiiDynamicArray<xiiUInt8> data;
+
+  for (xiiUInt32 i = 0; i < 16; ++i)
+  {
+    ObjectType type = ObjectType::Invalid;
+    XII_SUCCEED_OR_RETURN(ReadObject(id, type, data));
+
+    if (type == ObjectType::Commit)
+    {
+      out_commitId = id;
+      return XII_SUCCESS;
+    }
+
+    if (type != ObjectType::Tag)
+      return XII_FAILURE;
+
+    XII_SUCCEED_OR_RETURN(FindHeaderId(data, "object", id));
+  }
+
+  return XII_FAILURE;
+}
+
+xiiResult xiiLineCountGitRepository::ReadRef(xiiStringView sName, ObjectId& out_id, xiiUInt32 uiDepth) const
+{
+  // Symbolic refs could refer to each other
+  if (uiDepth > 8)
+    return XII_FAILURE;
+
+  xiiStringBuilder sPath = m_sGitDir;
+  sPath.AppendPath(sName);
+
+  xiiStringBuilder sContent;
+
+  if (xiiOSFile::ExistsFile(sPath))
+  {
+    ReadTextFile(sPath, sContent);
+
+    // Symbolic refs like HEAD refer to another ref, e.g. 'ref: refs/heads/main'
+    if (sContent.StartsWith("ref:"))
+    {
+      sContent.Shrink(4, 0);
+      sContent.Trim(" \t");
+      return ReadRef(sContent, out_id, uiDepth + 1);
+    }
+
+    return ParseObjectId(sContent, out_id);
+  }
+
+  // Refs that did not change for a while are only listed in 'packed-refs', one '<id> <name>' per line
+  sPath = m_sGitDir;
+  sPath.AppendPath("packed-refs");
+
+  if (!xiiOSFile::ExistsFile(sPath))
+    return XII_FAILURE;
+
+  ReadTextFile(sPath, sContent);
+
+  xiiDynamicArray<xiiStringView> Lines;
+  sContent.Split(false, Lines, "\n", "\r");
+
+  for (const xiiStringView& sLine : Lines)
+  {
+    if (sLine.GetElementCount() > 41 && sLine.GetStartPointer()[40] == ' ' && xiiStringView(sLine.GetStartPointer() + 41, sLine.GetEndPointer()) == sName)
+      return ParseObjectId(xiiStringView(sLine.GetStartPointer(), sLine.GetStartPointer() + 40), out_id);
+  }
+
+  return XII_FAILURE;
+}
+
+xiiResult xiiLineCountGitRepository::ListFiles(const ObjectId& commitId, xiiDynamicArray<File>& out_files, xiiUInt32& out_uiDirectories)
+{
+  out_files.Clear();
+  out_uiDirectories = 0;
+
+  ObjectType                type = ObjectType::Invalid;
+  xiiDynamicArray<xiiUInt8> data;
+  XII_SUCCEED_OR_RETURN(ReadObject(commitId, type, data));
+
+  ObjectId treeId;
+  if (type != ObjectType::Commit || FindHeaderId(data, "tree", treeId).Failed())
+    return XII_FAILURE;
+
+  return ListTree(treeId, "", out_files, out_uiDirectories);
+}
+
+xiiResult xiiLineCountGitRepository::ListTree(const ObjectId& treeId, xiiStringView sPath, xiiDynamicArray<File>& out_files, xiiUInt32& out_uiDirectories)
+{
+  ObjectType                type = ObjectType::Invalid;
+  xiiDynamicArray<xiiUInt8> data;
+  XII_SUCCEED_OR_RETURN(ReadObject(treeId, type, data));
+
+  if (type != ObjectType::Tree)
+    return XII_FAILURE;
+
+  const char* p    = reinterpret_cast<const char*>(data.GetData());
+  const char* pEnd = p + data.GetCount();
+
+  xiiStringBuilder sEntryPath;
+
+  // Every entry is '<mode> <name>\0' followed by the binary id. The mode is in octal, without leading zeros.
+  while (p < pEnd)
+  {
+    const char* szMode = p;
+    while (p < pEnd && *p != ' ')
+      ++p;
+
+    const char* szModeEnd = p++;
+    const char* szName    = p;
+    while (p < pEnd && *p != '\0')
+      ++p;
+
+    if (pEnd - p < 21)
+      return XII_FAILURE;
+
+    const xiiStringView sMode(szMode, szModeEnd);
+    const xiiStringView sName(szName, p);
+
+    ObjectId id;
+    xiiMemoryUtils::Copy(id.m_uiBytes, reinterpret_cast<const xiiUInt8*>(p + 1), 20);
+    p += 21;
+
+    sEntryPath = sPath;
+    sEntryPath.AppendPath(sName);
+
+    if (sMode == "40000")
+    {
+      ++out_uiDirectories;
+      XII_SUCCEED_OR_RETURN(ListTree(id, sEntryPath, out_files, out_uiDirectories));
+    }
+    else if (sMode.StartsWith("100")) // 100644 or 100755, symbolic links are 120000 and submodules 160000
+    {
+      File& file  = out_files.ExpandAndGetRef();
+      file.m_sPath = sEntryPath;
+      file.m_Id    = id;
+    }
+  }
+
+  return XII_SUCCESS;
+}
+
+xiiResult xiiLineCountGitRepository::ReadObject(const ObjectId& id, ObjectType& out_type, xiiDynamicArray<xiiUInt8>& out_data)
+{
+  xiiUInt32 uiPack   = 0;
+  xiiUInt64 uiOffset = 0;
+
+  // Most objects of a repository are packed, so the packs are searched first
+  if (FindPackedObject(id, uiPack, uiOffset))
+  {
+    ++m_uiPackedObjectReads;
+    return ReadPackedObject(uiPack, uiOffset, out_type, out_data, 0);
+  }
+
+  return ReadLooseObject(id, out_type, out_data);
+}
+
+bool xiiLineCountGitRepository::FindPackedObject(const ObjectId& id, xiiUInt32& out_uiPack, xiiUInt64& out_uiOffset) const
+{
+  const xiiUInt32 uiFirstByte = id.m_uiBytes[0];
+
+  for (xiiUInt32 uiPack = 0; uiPack < m_Packs.GetCount(); ++uiPack)
+  {
+    const Pack& pack = m_Packs[uiPack];
+
+    // The fan-out table narrows the search down to the ids with the same first byte
+    xiiUInt32 uiLow  = uiFirstByte > 0 ? ReadBigEndian32(pack.m_pFanout + (uiFirstByte - 1) * 4) : 0;
+    xiiUInt32 uiHigh = ReadBigEndian32(pack.m_pFanout + uiFirstByte * 4);
+
+    uiHigh = xiiMath::Min(uiHigh, pack.m_uiObjects);
+
+    while (uiLow < uiHigh)
+    {
+      const xiiUInt32 uiMiddle = uiLow + (uiHigh - uiLow) / 2;
+      const xiiInt32  iCompare = xiiMemoryUtils::Compare(pack.m_pIds + uiMiddle * 20, id.m_uiBytes, 20);
+
+      if (iCompare < 0)
+      {
+        uiLow = uiMiddle + 1;
+      }
+      else if (iCompare > 0)
+      {
+        uiHigh = uiMiddle;
+      }
+      else
+      {
+        const xiiUInt32 uiOffset = ReadBigEndian32(pack.m_pOffsets + uiMiddle * 4);
+
+        // Offsets beyond 2 GB are stored in a separate table
+        if (uiOffset & 0x80000000)
+        {
+          const xiiUInt32 uiIndex = uiOffset & 0x7FFFFFFF;
+          if (uiIndex >= pack.m_uiOffsets64)
+            return false;
+
+          out_uiOffset = ReadBigEndian64(pack.m_pOffsets64 + uiIndex * 8);
+        }
+        else
+        {
+          out_uiOffset = uiOffset;
+        }
+
+        out_uiPack = uiPack;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+xiiResult xiiLineCountGitRepository::ReadLooseObject(const ObjectId& id, ObjectType& out_type, xiiDynamicArray<xiiUInt8>& out_data)
+{
+  // Loose objects are stored by their id, with the first two hex digits as the directory
+  xiiStringBuilder sHex;
+  FormatObjectId(id, sHex);
+
+  xiiStringBuilder sPath = m_sGitDir;
+  sPath.AppendPath("objects", xiiStringView(sHex.GetData(), sHex.GetData() + 2), sHex.GetData() + 2);
+
+  if (!xiiOSFile::ExistsFile(sPath))
+    return XII_FAILURE;
+
+  xiiFileReader file;
+  XII_SUCCEED_OR_RETURN(file.Open(sPath));
+
+  ++m_uiLooseObjectReads;
+
+  xiiLineCountInflateReader reader;
+  reader.SetInputStream(&file, xiiLineCountInflateReader::Format::Zlib);
+
+  // The content is preceded by the type and the size in decimal, e.g. 'blob 1234\0'
+  char      szHeader[32];
+  xiiUInt32 uiHeaderLength = 0;
+
+  while (true)
+  {
+    if (uiHeaderLength == XII_ARRAY_SIZE(szHeader) || reader.ReadBytes(&szHeader[uiHeaderLength], 1) != 1)
+      return XII_FAILURE;
+
+    if (szHeader[uiHeaderLength] == '\0')
+      break;
+
+    ++uiHeaderLength;
+  }
+
+  const xiiStringView sHeader(szHeader, szHeader + uiHeaderLength);
+  const char*         szSize = sHeader.FindSubString(" ");
+
+  if (szSize == nullptr)
+    return XII_FAILURE;
+
+  out_type = ObjectType::Invalid;
+
+  for (xiiUInt32 uiType = 1; uiType < XII_ARRAY_SIZE(s_szTypeNames); ++uiType)
+  {
+    if (xiiStringView(szHeader, szSize) == s_szTypeNames[uiType])
+      out_type = static_cast<ObjectType>(uiType);
+  }
+
+  xiiUInt64 uiSize = 0;
+
+  for (const char* c = szSize + 1; c < sHeader.GetEndPointer(); ++c)
+  {
+    if (*c < '0' || *c > '9' || uiSize > xiiMath::MaxValue<xiiUInt32>())
+      return XII_FAILURE;
+
+    uiSize = uiSize * 10 + (*c - '0');
+  }
+
+  if (out_type == ObjectType::Invalid || uiSize > xiiMath::MaxValue<xiiUInt32>())
+    return XII_FAILURE;
+
+  out_data.SetCountUninitialized(static_cast<xiiUInt32>(uiSize));
+
+  if (reader.ReadBytes(out_data.GetData(), uiSize) != uiSize)
+    return XII_FAILURE;
+
+  return XII_SUCCESS;
+}
+
+xiiResult xiiLineCountGitRepository::ReadPackedObject(xiiUInt32 uiPack, xiiUInt64 uiOffset, ObjectType& out_type, xiiDynamicArray<xiiUInt8>& out_data, xiiUInt32 uiDepth)
+{
+  const Pack& pack = m_Packs[uiPack];
+
+  if (uiDepth > MaxDeltaDepth || uiOffset < 12 || uiOffset >= pack.m_uiDataSize)
+    return XII_FAILURE;
+
+  const xiiUInt8* p    = pack.m_pData + uiOffset;
+  const xiiUInt8* pEnd = pack.m_pData + pack.m_uiDataSize;
+
+  // The entry starts with its type and its size: 4 bits of the size in the first byte and 7 more in each following one
+  xiiUInt8        uiByte = *p++;
+  const xiiUInt32 uiType = (uiByte >> 4) & 7;
+  xiiUInt64       uiSize = uiByte & 0x0F;
+
+  for (xiiUInt32 uiShift = 4; (uiByte & 0x80) != 0; uiShift += 7)
+  {
+    if (p == pEnd || uiShift > 57)
+      return XII_FAILURE;
+
+    uiByte = *p++;
+    uiSize |= static_cast<xiiUInt64>(uiByte & 0x7F) << uiShift;
+  }
+
+  if (uiType >= static_cast<xiiUInt32>(ObjectType::Commit) && uiType <= static_cast<xiiUInt32>(ObjectType::Tag))
+  {
+    out_type = static_cast<ObjectType>(uiType);
+    return xiiLineCountInflateReader::Inflate(GetCompressedData(p, pEnd), xiiLineCountInflateReader::Format::Zlib, out_data, uiSize);
+  }
+
+  // Everything else is a delta, the size is the size of the delta
+  xiiUInt32 uiBasePack   = uiPack;
+  xiiUInt64 uiBaseOffset = 0;
+
+  if (uiType == s_uiOffsetDelta)
+  {
+    // The distance back to the base, 7 bits per byte with the most significant ones first. Every further byte also adds
+    // one, so that there is only one way to encode each distance.
+    if (p == pEnd)
+      return XII_FAILURE;
+
+    uiByte = *p++;
+
+    xiiUInt64 uiDistance = uiByte & 0x7F;
+
+    while ((uiByte & 0x80) != 0)
+    {
+      if (p == pEnd || uiDistance > (xiiMath::MaxValue<xiiUInt64>() >> 8))
+        return XII_FAILURE;
+
+      uiByte     = *p++;
+      uiDistance = ((uiDistance + 1) << 7) | (uiByte & 0x7F);
+    }
+
+    if (uiDistance == 0 || uiDistance > uiOffset)
+      return XII_FAILURE;
+
+    uiBaseOffset = uiOffset - uiDistance;
+  }
+  else if (uiType == s_uiRefDelta)
+  {
+    if (pEnd - p < 20)
+      return XII_FAILURE;
+
+    ObjectId baseId;
+    xiiMemoryUtils::Copy(baseId.m_uiBytes, p, 20);
+    p += 20;
+
+    // Only packs that are sent over the network may refer to objects outside of themselves
+    if (!FindPackedObject(baseId, uiBasePack, uiBaseOffset))
+      return XII_FAILURE;
+  }
+  else
+  {
+    return XII_FAILURE;
+  }
+
+  ++m_uiDeltas;
+
+  xiiDynamicArray<xiiUInt8> delta;
+  XII_SUCCEED_OR_RETURN(xiiLineCountInflateReader::Inflate(GetCompressedData(p, pEnd), xiiLineCountInflateReader::Format::Zlib, delta, uiSize));
+
+  // Resolving the base may take a chain of deltas itself, and the same base is usually needed by several objects
+  const xiiUInt64     uiBaseKey = (static_cast<xiiUInt64>(uiBasePack) << 48) | uiBaseOffset;
+  const CachedObject* pBase     = m_Cache.GetValue(uiBaseKey);
+
+  if (pBase == nullptr)
+  {
+    CachedObject base;
+    XII_SUCCEED_OR_RETURN(ReadPackedObject(uiBasePack, uiBaseOffset, base.m_Type, base.m_Data, uiDepth + 1));
+
+    if (m_uiCachedBytes + base.m_Data.GetCount() > MaxCachedBytes)
+    {
+      m_Cache.Clear();
+      m_uiCachedBytes = 0;
+    }
+
+    m_uiCachedBytes += base.m_Data.GetCount();
+    m_Cache.Insert(uiBaseKey, std::move(base));
+
+    pBase = m_Cache.GetValue(uiBaseKey);
+  }
+
+  out_type = pBase->m_Type;
+  return ApplyDelta(pBase->m_Data, delta, out_data);
+}
+
+xiiResult xiiLineCountGitRepository::ApplyDelta(xiiArrayPtr<const xiiUInt8> base, xiiArrayPtr<const xiiUInt8> delta, xiiDynamicArray<xiiUInt8>& out_result)
+{
+  const xiiUInt8* p    = delta.GetPtr();
+  const xiiUInt8* pEnd = p + delta.GetCount();
+
+  xiiUInt64 uiBaseSize   = 0;
+  xiiUInt64 uiResultSize = 0;
+
+  if (!ReadDeltaSize(p, pEnd, uiBaseSize) || !ReadDeltaSize(p, pEnd, uiResultSize) || uiBaseSize != base.GetCount() || uiResultSize > xiiMath::MaxValue<xiiUInt32>())
+    return XII_FAILURE;
+
+  out_result.SetCountUninitialized(static_cast<xiiUInt32>(uiResultSize));
+
+  xiiUInt8*       pOut    = out_result.GetData();
+  xiiUInt8* const pOutEnd = pOut + uiResultSize;
+
+  // The delta is a sequence of instructions that either copy a range of the base or insert new bytes
+  while (p < pEnd)
+  {
+    const xiiUInt8 uiInstruction = *p++;
+
+    if ((uiInstruction & 0x80) != 0)
+    {
+      // The low 4 bits tell which bytes of the offset follow, the next 3 bits which bytes of the size
+      xiiUInt32 uiCopyOffset = 0;
+      xiiUInt32 uiCopySize   = 0;
+
+      for (xiiUInt32 i = 0; i < 7; ++i)
+      {
+        if ((uiInstruction & (1u << i)) == 0)
+          continue;
+
+        if (p == pEnd)
+          return XII_FAILURE;
+
+        if (i < 4)
+          uiCopyOffset |= static_cast<xiiUInt32>(*p++) << (i * 8);
+        else
+          uiCopySize |= static_cast<xiiUInt32>(*p++) << ((i - 4) * 8);
+      }
+
+      if (uiCopySize == 0)
+        uiCopySize = 0x10000;
+
+      if (static_cast<xiiUInt64>(uiCopyOffset) + uiCopySize > base.GetCount() || uiCopySize > static_cast<xiiUInt64>(pOutEnd - pOut))
+        return XII_FAILURE;
+
+      xiiMemoryUtils::Copy(pOut, base.GetPtr() + uiCopyOffset, uiCopySize);
+      pOut += uiCopySize;
+    }
+    else if (uiInstruction != 0)
+    {
+      if (uiInstruction > pEnd - p || uiInstruction > pOutEnd - pOut)
+        return XII_FAILURE;
+
+      xiiMemoryUtils::Copy(pOut, p, uiInstruction);
+      p += uiInstruction;
+      pOut += uiInstruction;
+    }
+    else
+    {
+      // Reserved
+      return XII_FAILURE;
+    }
+  }
+
+  return pOut == pOutEnd ? XII_SUCCESS : XII_FAILURE;
+}
+
+xiiResult xiiLineCountGitRepository::ParseObjectId(xiiStringView sHex, ObjectId& out_id)
+{
+  if (sHex.GetElementCount() != 40)
+    return XII_FAILURE;
+
+  const char* szHex = sHex.GetStartPointer();
+
+  for (xiiUInt32 i = 0; i < 20; ++i)
+  {
+    const xiiInt32 iHigh = GetHexDigit(szHex[i * 2]);
+    const xiiInt32 iLow  = GetHexDigit(szHex[i * 2 + 1]);
+
+    if (iHigh < 0 || iLow < 0)
+      return XII_FAILURE;
+
+    out_id.m_uiBytes[i] = static_cast<xiiUInt8>((iHigh << 4) | iLow);
+  }
+
+  return XII_SUCCESS;
+}
+
+void xiiLineCountGitRepository::FormatObjectId(const ObjectId& id, xiiStringBuilder& out_sHex)
+{
+  constexpr const char* szDigits = "0123456789abcdef";
+
+  char szHex[41];
+
+  for (xiiUInt32 i = 0; i < 20; ++i)
+  {
+    szHex[i * 2]     = szDigits[id.m_uiBytes[i] >> 4];
+    szHex[i * 2 + 1] = szDigits[id.m_uiBytes[i] & 0x0F];
+  }
+
+  szHex[40] = '\0';
+  out_sHex  = szHex;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/IO/MemoryMappedFile.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE) && XII_ENABLED(XII_SUPPORTS_FILE_ITERATORS)
+
+// Reads commits, trees and blobs directly from the object database of a local git repository, without a checkout.
+//
+// Objects are found as loose files ('objects/ab/cdef...') or in pack files, whose index files are searched with the
+// fan-out table and a binary search. Pack files are memory-mapped, so only the pages of the objects that are actually
+// read are loaded. Deltas are resolved recursively against their base objects. Since many objects of a revision share
+// the same bases (e.g. the previous version of a file), the most recently resolved bases are kept in a cache.
+//
+// Only repositories with SHA-1 object ids are supported. Checksums are not verified.
+class xiiLineCountGitRepository
+{
+public:
+  struct ObjectId
+  {
+    xiiUInt8 m_uiBytes[20] = {};
+
+    bool operator==(const ObjectId& other) const;
+    bool operator!=(const ObjectId& other) const { return !(*this == other); }
+  };
+
+  // For using object ids as keys in hash tables
+  struct ObjectIdHash
+  {
+    static xiiUInt32 Hash(const ObjectId& id);
+    static bool      Equal(const ObjectId& a, const ObjectId& b) { return a == b; }
+  };
+
+  enum class ObjectType : xiiUInt8
+  {
+    Invalid = 0,
+    Commit  = 1,
+    Tree    = 2,
+    Blob    = 3,
+    Tag     = 4,
+  };
+
+  // A regular file of a tree, with its path relative to the root of the tree
+  struct File
+  {
+    xiiString m_sPath;
+    ObjectId  m_Id;
+  };
+
+  // Opens the repository in the given directory, which can be a '.git' directory (or a bare repository) or a working tree.
+  xiiResult Open(xiiStringView sDirectory);
+
+  // Returns the directory with the object database, e.g. '/path/to/repo/.git'.
+  xiiStringView GetGitDir() const { return m_sGitDir; }
+
+  // Finds the commit that the given revision refers to: a full object id, 'HEAD', or the name of a branch or tag.
+  // Annotated tags are followed to the commit that they tag.
+  xiiResult ResolveRevision(xiiStringView sRevision, ObjectId& out_commitId);
+
+  // Lists all regular files of the commit's tree and counts its directories. Symbolic links and submodules are skipped.
+  xiiResult ListFiles(const ObjectId& commitId, xiiDynamicArray<File>& out_files, xiiUInt32& out_uiDirectories);
+
+  // Reads and decompresses an object, with all deltas applied.
+  xiiResult ReadObject(const ObjectId& id, ObjectType& out_type, xiiDynamicArray<xiiUInt8>& out_data);
+
+  // Converts between object ids and their 40 hex digit representation.
+  static xiiResult ParseObjectId(xiiStringView sHex, ObjectId& out_id);
+  static void      FormatObjectId(const ObjectId& id, xiiStringBuilder& out_sHex);
+
+  xiiUInt32 GetPackCount() const { return m_Packs.GetCount(); }
+  xiiUInt32 GetLooseObjectReads() const { return m_uiLooseObjectReads; }
+  xiiUInt32 GetPackedObjectReads() const { return m_uiPackedObjectReads; }
+  xiiUInt32 GetDeltaCount() const { return m_uiDeltas; }
+
+private:
+  // A pack file with its index, both memory-mapped
+  struct Pack
+  {
+    xiiMemoryMappedFile m_IndexFile;
+    xiiMemoryMappedFile m_PackFile;
+
+    const xiiUInt8* m_pFanout     = nullptr; // 256 big-endian counts of the objects whose first byte is at most the index
+    const xiiUInt8* m_pIds        = nullptr; // The sorted object ids
+    const xiiUInt8* m_pOffsets    = nullptr; // 32-bit offsets, or indices into the 64-bit offsets if the highest bit is set
+    const xiiUInt8* m_pOffsets64  = nullptr;
+    xiiUInt32       m_uiObjects   = 0;
+    xiiUInt32       m_uiOffsets64 = 0;
+    const xiiUInt8* m_pData       = nullptr;
+    xiiUInt64       m_uiDataSize  = 0;
+  };
+
+  // A resolved delta base, by pack and offset
+  struct CachedObject
+  {
+    ObjectType                m_Type = ObjectType::Invalid;
+    xiiDynamicArray<xiiUInt8> m_Data;
+  };
+
+  static constexpr xiiUInt32 MaxDeltaDepth  = 64;               // Git itself never creates longer chains than 50
+  static constexpr xiiUInt64 MaxCachedBytes = 64 * 1024 * 1024; // The cache of delta bases is dropped when it grows beyond this
+
+  static xiiResult OpenPack(Pack& ref_pack, xiiStringView sIndexFile);
+  xiiResult ReadLooseObject(const ObjectId& id, ObjectType& out_type, xiiDynamicArray<xiiUInt8>& out_data);
+  xiiResult ReadPackedObject(xiiUInt32 uiPack, xiiUInt64 uiOffset, ObjectType& out_type, xiiDynamicArray<xiiUInt8>& out_data, xiiUInt32 uiDepth);
+  bool      FindPackedObject(const ObjectId& id, xiiUInt32& out_uiPack, xiiUInt64& out_uiOffset) const;
+  xiiResult ReadRef(xiiStringView sName, ObjectId& out_id, xiiUInt32 uiDepth) const;
+  xiiResult ListTree(const ObjectId& treeId, xiiStringView sPath, xiiDynamicArray<File>& out_files, xiiUInt32& out_uiDirectories);
+
+  static xiiResult ApplyDelta(xiiArrayPtr<const xiiUInt8> base, xiiArrayPtr<const xiiUInt8> delta, xiiDynamicArray<xiiUInt8>& out_result);
+
+  xiiString      m_sGitDir;
+  xiiDeque<Pack> m_Packs; // Must not move, since the memory-mapped files can't be copied
+
+  xiiHashTable<xiiUInt64, CachedObject> m_Cache; // By pack index << 48 | offset
+  xiiUInt64                             m_uiCachedBytes = 0;
+
+  // Statistics
+  xiiUInt32 m_uiLooseObjectReads  = 0;
+  xiiUInt32 m_uiPackedObjectReads = 0;
+  xiiUInt32 m_uiDeltas            = 0;
+};
+
+#endif
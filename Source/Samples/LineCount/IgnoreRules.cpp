@@ -0,0 +1,441 @@
+#include <LineCount/IgnoreRules.h>
+
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/IO/OSFile.h>
+
+namespace
+{
+  XII_ALWAYS_INLINE char ToLower(char c)
+  {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+  }
+
+  XII_ALWAYS_INLINE bool IsSameCharacter(char a, char b)
+  {
+#if XII_ENABLED(XII_PLATFORM_WINDOWS)
+    // Like git on Windows, the patterns don't care about case
+    return ToLower(a) == ToLower(b);
+#else
+    return a == b;
+#endif
+  }
+
+  bool IsSameText(const char* a, const char* b, xiiUInt32 uiLength)
+  {
+    for (xiiUInt32 i = 0; i < uiLength; ++i)
+    {
+      if (!IsSameCharacter(a[i], b[i]))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool HasWildcards(const char* szStart, const char* szEnd)
+  {
+    for (const char* c = szStart; c < szEnd; ++c)
+    {
+      if (*c == '*' || *c == '?' || *c == '[' || *c == '\\')
+        return true;
+    }
+
+    return false;
+  }
+
+  // Matches a character class like 'a-z]' or '!0-9]' (after the '['). Returns the end of the class, or nullptr if it is not closed.
+  const char* MatchClass(const char* p, const char* pEnd, char c, bool& out_bMatch)
+  {
+    const bool bNegated = p < pEnd && (*p == '!' || *p == '^');
+    if (bNegated)
+      ++p;
+
+    bool bMatch = false;
+
+    // A ']' right at the start is part of the class
+    for (const char* pFirst = p; p < pEnd && (*p != ']' || p == pFirst);)
+    {
+      if (*p == '\\' && p + 1 < pEnd)
+        ++p;
+
+      if (p + 2 < pEnd && p[1] == '-' && p[2] != ']')
+      {
+        bMatch |= ToLower(c) >= ToLower(p[0]) && ToLower(c) <= ToLower(p[2]);
+        p += 3;
+      }
+      else
+      {
+        bMatch |= IsSameCharacter(c, *p);
+        ++p;
+      }
+    }
+
+    if (p == pEnd)
+      return nullptr;
+
+    out_bMatch = bMatch != bNegated;
+    return p + 1;
+  }
+
+  // Matches the whole text against a glob. '*', '?' and classes don't match a '/', '**' matches across directories.
+  bool MatchGlob(const char* p, const char* pEnd, const char* t, const char* tEnd)
+  {
+    while (p < pEnd)
+    {
+      if (*p == '*')
+      {
+        if (p + 1 < pEnd && p[1] == '*')
+        {
+          p += 2;
+
+          // '**/' matches any number of directories, even none, e.g. 'a/**/b' matches 'a/b' and 'a/x/y/b'
+          if (p < pEnd && *p == '/')
+          {
+            ++p;
+
+            while (true)
+            {
+              if (MatchGlob(p, pEnd, t, tEnd))
+                return true;
+
+              while (t < tEnd && *t != '/')
+                ++t;
+
+              if (t == tEnd)
+                return false;
+
+              ++t;
+            }
+          }
+
+          // Anywhere else, '**' matches everything
+          for (; t <= tEnd; ++t)
+          {
+            if (MatchGlob(p, pEnd, t, tEnd))
+              return true;
+          }
+
+          return false;
+        }
+
+        ++p;
+
+        while (true)
+        {
+          if (MatchGlob(p, pEnd, t, tEnd))
+            return true;
+
+          if (t == tEnd || *t == '/')
+            return false;
+
+          ++t;
+        }
+      }
+
+      if (t == tEnd)
+        return false;
+
+      if (*p == '?')
+      {
+        if (*t == '/')
+          return false;
+      }
+      else if (*p == '[')
+      {
+        bool        bMatch    = false;
+        const char* pClassEnd = MatchClass(p + 1, pEnd, *t, bMatch);
+
+        // A '[' without a ']' is a normal character
+        if (pClassEnd == nullptr)
+        {
+          if (!IsSameCharacter(*p, *t))
+            return false;
+        }
+        else
+        {
+          if (!bMatch || *t == '/')
+            return false;
+
+          p = pClassEnd;
+          ++t;
+          continue;
+        }
+      }
+      else
+      {
+        if (*p == '\\' && p + 1 < pEnd)
+          ++p;
+
+        if (!IsSameCharacter(*p, *t))
+          return false;
+      }
+
+      ++p;
+      ++t;
+    }
+
+    return t == tEnd;
+  }
+} // namespace
+
+void xiiLineCountIgnoreRules::Reset(xiiStringView sSearchDir, xiiStringView sPatterns, bool bUseIgnoreFiles)
+{
+  m_Directories.Clear();
+  m_Lookup.Clear();
+  m_sLastDirectory.Clear();
+  m_pLastDirectory  = nullptr;
+  m_bUseIgnoreFiles = bUseIgnoreFiles;
+  m_uiIgnoreFiles   = 0;
+
+  xiiStringBuilder sDir = sSearchDir;
+  sDir.Trim(nullptr, "/");
+
+  m_Override.m_Patterns.Clear();
+  m_Override.m_sPath = sDir;
+  m_Override.m_sPath.Append("/");
+  AddPatterns(m_Override, sPatterns, ";");
+
+  m_sTopDir = sDir;
+
+  if (!bUseIgnoreFiles)
+    return;
+
+  // The ignore files above the search directory apply as well, up to the root of the repository
+  xiiStringBuilder sGitDir, sParentDir;
+
+  while (true)
+  {
+    sGitDir = sDir;
+    sGitDir.AppendPath(".git");
+
+    // In worktrees and submodules, '.git' is a file
+    if (xiiOSFile::ExistsDirectory(sGitDir) || xiiOSFile::ExistsFile(sGitDir))
+    {
+      m_sTopDir = sDir;
+      break;
+    }
+
+    const char* szSlash = sDir.FindLastSubString("/");
+    if (szSlash == nullptr || szSlash == sDir.GetData())
+      break;
+
+    sParentDir.SetSubString_FromTo(sDir.GetData(), szSlash);
+    sDir = sParentDir;
+  }
+}
+
+bool xiiLineCountIgnoreRules::IsIgnored(xiiStringView sDirectory, xiiStringView sName, bool bIsDirectory)
+{
+  if (bIsDirectory && sName == ".git")
+    return true;
+
+  if (sDirectory.EndsWith("/"))
+    sDirectory.Shrink(0, 1);
+
+  if (sDirectory != m_sLastDirectory)
+  {
+    m_pLastDirectory = FindDirectory(sDirectory);
+    m_sLastDirectory = sDirectory;
+  }
+
+  if (m_pLastDirectory == nullptr && m_Override.m_Patterns.IsEmpty())
+    return false;
+
+  m_sPath = sDirectory;
+  m_sPath.Append("/", sName);
+
+  // The patterns that were passed in directly come first, then the closest directory decides
+  Result result = Match(m_Override, m_sPath, sName, bIsDirectory);
+
+  for (const Directory* pDirectory = m_pLastDirectory; pDirectory != nullptr && result == Result::NoMatch; pDirectory = pDirectory->m_pParent)
+  {
+    result = Match(*pDirectory, m_sPath, sName, bIsDirectory);
+  }
+
+  return result == Result::Ignored;
+}
+
+bool xiiLineCountIgnoreRules::IsPathIgnored(xiiStringView sPath, bool bIsDirectory)
+{
+  // The search directory with a trailing '/'
+  const xiiString& sSearchDir = m_Override.m_sPath;
+
+  if (!sPath.StartsWith(sSearchDir))
+    return false;
+
+  // Check every directory on the way down, as if the file system iterator had found them
+  const char* szName = sPath.GetStartPointer() + sSearchDir.GetElementCount();
+
+  while (true)
+  {
+    const char* szSlash = xiiStringView(szName, sPath.GetEndPointer()).FindSubString("/");
+    const bool  bLast   = szSlash == nullptr;
+
+    if (IsIgnored(xiiStringView(sPath.GetStartPointer(), szName - 1), xiiStringView(szName, bLast ? sPath.GetEndPointer() : szSlash), bLast ? bIsDirectory : true))
+      return true;
+
+    if (bLast)
+      return false;
+
+    szName = szSlash + 1;
+  }
+}
+
+const xiiLineCountIgnoreRules::Directory* xiiLineCountIgnoreRules::FindDirectory(xiiStringView sDirectory)
+{
+  if (const Directory* const* pKnown = m_Lookup.GetValue(sDirectory))
+    return *pKnown;
+
+  // The rules of the parents apply here as well, up to the top directory
+  const Directory* pParent = nullptr;
+  const char*      szSlash = sDirectory.FindLastSubString("/");
+
+  if (szSlash != nullptr && sDirectory != m_sTopDir && sDirectory.StartsWith(m_sTopDir))
+  {
+    pParent = FindDirectory(xiiStringView(sDirectory.GetStartPointer(), szSlash));
+  }
+
+  Directory directory;
+  directory.m_sPath   = sDirectory;
+  directory.m_pParent = pParent;
+  directory.m_sPath.Append("/");
+
+  if (m_bUseIgnoreFiles)
+  {
+    // '.ignore' is read last, so its patterns take precedence
+    ReadIgnoreFile(directory, ".gitignore");
+    ReadIgnoreFile(directory, ".ignore");
+  }
+
+  // Directories without rules are not stored, they just use the rules of their parent
+  const Directory* pResult = pParent;
+
+  if (!directory.m_Patterns.IsEmpty())
+  {
+    m_Directories.PushBack(std::move(directory));
+    pResult = &m_Directories.PeekBack();
+  }
+
+  m_Lookup.Insert(sDirectory, pResult);
+  return pResult;
+}
+
+void xiiLineCountIgnoreRules::ReadIgnoreFile(Directory& ref_directory, xiiStringView sFile)
+{
+  xiiStringBuilder sPath = ref_directory.m_sPath;
+  sPath.Append(sFile);
+
+  xiiFileReader file;
+  if (file.Open(sPath).Failed())
+    return;
+
+  xiiStringBuilder sContent;
+  sContent.ReadAll(file);
+
+  AddPatterns(ref_directory, sContent, "\n");
+  ++m_uiIgnoreFiles;
+}
+
+void xiiLineCountIgnoreRules::AddPatterns(Directory& ref_directory, const xiiStringBuilder& sText, const char* szSeparator)
+{
+  xiiDynamicArray<xiiStringView> lines;
+  sText.Split(false, lines, szSeparator, "\r");
+
+  for (xiiStringView sLine : lines)
+  {
+    // Trailing spaces are ignored, unless they are escaped
+    while (sLine.EndsWith(" ") && !sLine.EndsWith("\\ "))
+      sLine.Shrink(0, 1);
+
+    if (sLine.IsEmpty() || sLine.StartsWith("#"))
+      continue;
+
+    Pattern pattern;
+
+    if (sLine.StartsWith("!"))
+    {
+      pattern.m_bNegated = true;
+      sLine.Shrink(1, 0);
+    }
+    else if (sLine.StartsWith("\\!") || sLine.StartsWith("\\#"))
+    {
+      sLine.Shrink(1, 0);
+    }
+
+    if (sLine.EndsWith("/"))
+    {
+      pattern.m_bDirectoryOnly = true;
+      sLine.Shrink(0, 1);
+    }
+
+    // A pattern with a '/' (other than at the end) is relative to the directory of the ignore file.
+    // A leading '**/' in front of a single name means the same as no '/' at all: the name, in any directory.
+    if (sLine.StartsWith("**/") && xiiStringView(sLine.GetStartPointer() + 3, sLine.GetEndPointer()).FindSubString("/") == nullptr)
+    {
+      sLine.Shrink(3, 0);
+    }
+    else if (sLine.FindSubString("/") != nullptr)
+    {
+      pattern.m_bAnchored = true;
+
+      if (sLine.StartsWith("/"))
+        sLine.Shrink(1, 0);
+    }
+
+    if (sLine.IsEmpty())
+      continue;
+
+    if (!HasWildcards(sLine.GetStartPointer(), sLine.GetEndPointer()))
+    {
+      pattern.m_Kind = Pattern::Kind::Literal;
+    }
+    else if (!pattern.m_bAnchored && sLine.StartsWith("*") && !HasWildcards(sLine.GetStartPointer() + 1, sLine.GetEndPointer()))
+    {
+      pattern.m_Kind = Pattern::Kind::Suffix;
+      sLine.Shrink(1, 0);
+    }
+
+    pattern.m_sText = sLine;
+    ref_directory.m_Patterns.PushBack(pattern);
+  }
+}
+
+xiiLineCountIgnoreRules::Result xiiLineCountIgnoreRules::Match(const Directory& directory, xiiStringView sPath, xiiStringView sName, bool bIsDirectory)
+{
+  // The path relative to the directory of the patterns, all checked entries are below it
+  const xiiStringView sRelativePath(sPath.GetStartPointer() + directory.m_sPath.GetElementCount(), sPath.GetEndPointer());
+
+  // Later patterns override earlier ones
+  for (xiiUInt32 i = directory.m_Patterns.GetCount(); i-- > 0;)
+  {
+    const Pattern& pattern = directory.m_Patterns[i];
+
+    if (pattern.m_bDirectoryOnly && !bIsDirectory)
+      continue;
+
+    const xiiStringView sText           = pattern.m_bAnchored ? sRelativePath : sName;
+    const xiiUInt32     uiLength        = sText.GetElementCount();
+    const xiiUInt32     uiPatternLength = pattern.m_sText.GetElementCount();
+
+    bool bMatch = false;
+
+    switch (pattern.m_Kind)
+    {
+      case Pattern::Kind::Literal:
+        bMatch = uiLength == uiPatternLength && IsSameText(sText.GetStartPointer(), pattern.m_sText.GetData(), uiLength);
+        break;
+
+      case Pattern::Kind::Suffix:
+        bMatch = uiLength >= uiPatternLength && IsSameText(sText.GetEndPointer() - uiPatternLength, pattern.m_sText.GetData(), uiPatternLength);
+        break;
+
+      case Pattern::Kind::Glob:
+        bMatch = MatchGlob(pattern.m_sText.GetData(), pattern.m_sText.GetData() + uiPatternLength, sText.GetStartPointer(), sText.GetEndPointer());
+        break;
+    }
+
+    if (bMatch)
+      return pattern.m_bNegated ? Result::Included : Result::Ignored;
+  }
+
+  return Result::NoMatch;
+}
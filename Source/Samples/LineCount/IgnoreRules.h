@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+// Decides which files and directories LineCount skips, the same way git does with '.gitignore' files.
+//
+// The rules come from the '.gitignore' and '.ignore' files of the searched directories and of their parents up to the
+// root of the repository, plus patterns that are passed in directly (e.g. on the command line), which take precedence
+// over all files. The '.git' directory itself is always skipped. Ignored directories are not entered at all, so nothing
+// below them costs any time.
+//
+// The ignore files of a directory are read and compiled once, when the first entry of that directory is checked. Every
+// directory only refers to the closest parent that has any rules, so checking an entry visits only directories with rules.
+class xiiLineCountIgnoreRules
+{
+public:
+  // Starts over for the given search directory, which must be a clean absolute path.
+  // The patterns use the .gitignore syntax, are separated by ';' and are relative to the search directory.
+  // Without bUseIgnoreFiles, only the given patterns and the '.git' directory are ignored.
+  void Reset(xiiStringView sSearchDir, xiiStringView sPatterns, bool bUseIgnoreFiles);
+
+  // Returns whether the given entry of the given directory is ignored.
+  // The directory must be a clean absolute path below the search directory, as the file system iterator reports it.
+  bool IsIgnored(xiiStringView sDirectory, xiiStringView sName, bool bIsDirectory);
+
+  // Returns whether the given path or any of its parent directories below the search directory is ignored.
+  // Paths outside of the search directory are never ignored.
+  bool IsPathIgnored(xiiStringView sPath, bool bIsDirectory);
+
+  // Returns how many '.gitignore' and '.ignore' files were read so far.
+  xiiUInt32 GetIgnoreFileCount() const { return m_uiIgnoreFiles; }
+
+private:
+  // One line of an ignore file, prepared for matching
+  struct Pattern
+  {
+    enum class Kind : xiiUInt8
+    {
+      Literal, // No wildcards, compared as a whole
+      Suffix,  // '*' followed by a literal, e.g. '*.obj', compared with the end of the name
+      Glob,    // Everything else
+    };
+
+    xiiString m_sText; // Without '!', a trailing '/', a leading '/' and (for suffixes) the '*'
+    Kind      m_Kind           = Kind::Glob;
+    bool      m_bNegated       = false; // Starts with '!', re-includes what a previous pattern ignored
+    bool      m_bDirectoryOnly = false; // Ends with '/', only matches directories
+    bool      m_bAnchored      = false; // Contains a '/', matches the path relative to its directory instead of only the name
+  };
+
+  // The rules of one directory
+  struct Directory
+  {
+    xiiString                m_sPath;             // With a trailing '/'
+    const Directory*         m_pParent = nullptr; // The closest parent directory that has rules
+    xiiDynamicArray<Pattern> m_Patterns;
+  };
+
+  enum class Result : xiiUInt8
+  {
+    NoMatch,
+    Included,
+    Ignored,
+  };
+
+  const Directory* FindDirectory(xiiStringView sDirectory);
+  void             ReadIgnoreFile(Directory& ref_directory, xiiStringView sFile);
+
+  static void   AddPatterns(Directory& ref_directory, const xiiStringBuilder& sText, const char* szSeparator);
+  static Result Match(const Directory& directory, xiiStringView sPath, xiiStringView sName, bool bIsDirectory);
+
+  xiiDeque<Directory>                       m_Directories; // Must not move, since directories refer to their parents
+  xiiHashTable<xiiString, const Directory*> m_Lookup;      // The rules that apply to a directory (its own or a parent's), by its path
+  Directory                                 m_Override;    // The patterns that were passed in directly
+  xiiString                                 m_sTopDir;     // Where the chain of parents ends, the repository root or the search directory
+  bool                                      m_bUseIgnoreFiles = true;
+  xiiUInt32                                 m_uiIgnoreFiles   = 0;
+
+  // Most entries are in the same directory as the previous one
+  xiiString        m_sLastDirectory;
+  const Directory* m_pLastDirectory = nullptr;
+  xiiStringBuilder m_sPath;
+};
@@ -0,0 +1,606 @@
+#include <LineCount/Inflate.h>
+
+#include <Foundation/IO/MemoryStream.h>
+
+namespace
+{
+  // Base values and extra bits of the length symbols 257 to 285 and of the distance symbols 0 to 29
+  constexpr xiiUInt16 s_uiLengthBase[29]  = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  constexpr xiiUInt8  s_uiLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+  constexpr xiiUInt16 s_uiDistanceBase[30]  = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  constexpr xiiUInt8  s_uiDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  // The order in which the code lengths of the code length alphabet are stored
+  constexpr xiiUInt8 s_uiCodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+  xiiUInt32 ReverseBits(xiiUInt32 uiCode, xiiUInt32 uiLength)
+  {
+    xiiUInt32 uiResult = 0;
+
+    for (xiiUInt32 i = 0; i < uiLength; ++i)
+    {
+      uiResult = (uiResult << 1) | (uiCode & 1);
+      uiCode >>= 1;
+    }
+
+    return uiResult;
+  }
+} // namespace
+
+void xiiLineCountInflateReader::SetInputStream(xiiStreamReader* pInputStream, Format format)
+{
+  m_pInputStream      = pInputStream;
+  m_Format            = format;
+  m_State             = format != Format::Raw ? State::Header : State::BlockHeader;
+  m_bLastBlock        = false;
+  m_uiInputPos        = 0;
+  m_uiInputSize       = 0;
+  m_uiBitBuffer       = 0;
+  m_uiBitCount        = 0;
+  m_uiStoredRemaining = 0;
+  m_uiCopyRemaining   = 0;
+  m_uiCopyDistance    = 0;
+  m_uiTotalOutput     = 0;
+}
+
+xiiUInt64 xiiLineCountInflateReader::ReadBytes(void* pReadBuffer, xiiUInt64 uiBytesToRead)
+{
+  xiiUInt8* pOutput    = static_cast<xiiUInt8*>(pReadBuffer);
+  xiiUInt64 uiProduced = 0;
+
+  auto Output = [&](xiiUInt8 uiByte)
+  {
+    m_Window[m_uiTotalOutput & (WindowSize - 1)] = uiByte;
+    ++m_uiTotalOutput;
+
+    if (pOutput != nullptr)
+      pOutput[uiProduced] = uiByte;
+
+    ++uiProduced;
+  };
+
+  while (uiProduced < uiBytesToRead)
+  {
+    // First finish the match that did not fit last time
+    if (m_uiCopyRemaining > 0)
+    {
+      for (; m_uiCopyRemaining > 0 && uiProduced < uiBytesToRead; --m_uiCopyRemaining)
+      {
+        Output(m_Window[(m_uiTotalOutput - m_uiCopyDistance) & (WindowSize - 1)]);
+      }
+
+      continue;
+    }
+
+    switch (m_State)
+    {
+      case State::Header:
+        if ((m_Format == Format::Zlib ? ReadZlibHeader() : ReadGzipHeader()).Failed())
+        {
+          Fail();
+          break;
+        }
+
+        m_State = State::BlockHeader;
+        break;
+
+      case State::BlockHeader:
+        if (m_bLastBlock)
+        {
+          m_State = m_Format != Format::Raw ? State::Trailer : State::Done;
+          break;
+        }
+
+        if (ReadBlockHeader().Failed())
+          Fail();
+
+        break;
+
+      case State::Stored:
+        for (; m_uiStoredRemaining > 0 && uiProduced < uiBytesToRead; --m_uiStoredRemaining)
+        {
+          if (!NeedBits(8))
+          {
+            Fail();
+            break;
+          }
+
+          Output(static_cast<xiiUInt8>(GetBits(8)));
+        }
+
+        if (m_uiStoredRemaining == 0 && m_State == State::Stored)
+          m_State = State::BlockHeader;
+
+        break;
+
+      case State::Codes:
+        while (uiProduced < uiBytesToRead)
+        {
+          const xiiInt32 iSymbol = DecodeSymbol(m_Literals);
+
+          if (iSymbol < 256)
+          {
+            if (iSymbol < 0)
+            {
+              Fail();
+              break;
+            }
+
+            Output(static_cast<xiiUInt8>(iSymbol));
+            continue;
+          }
+
+          if (iSymbol == 256)
+          {
+            m_State = State::BlockHeader;
+            break;
+          }
+
+          // A match: the length, then the distance, each with some extra bits
+          const xiiInt32 iLength = iSymbol - 257;
+          if (iLength >= 29 || !NeedBits(s_uiLengthExtra[iLength]))
+          {
+            Fail();
+            break;
+          }
+
+          m_uiCopyRemaining = s_uiLengthBase[iLength] + GetBits(s_uiLengthExtra[iLength]);
+
+          const xiiInt32 iDistance = DecodeSymbol(m_Distances);
+          if (iDistance < 0 || iDistance >= 30 || !NeedBits(s_uiDistanceExtra[iDistance]))
+          {
+            Fail();
+            break;
+          }
+
+          m_uiCopyDistance = s_uiDistanceBase[iDistance] + GetBits(s_uiDistanceExtra[iDistance]);
+
+          if (m_uiCopyDistance > m_uiTotalOutput)
+          {
+            Fail();
+            break;
+          }
+
+          // The match is copied at the start of the outer loop
+          break;
+        }
+
+        if (m_State == State::Error)
+          m_uiCopyRemaining = 0;
+
+        break;
+
+      case State::Trailer:
+        // The checksum (and for gzip the size) is not verified, but it is consumed, in case the caller continues with the input stream
+        GetBits(m_uiBitCount % 8);
+
+        if (NeedBits(32))
+          GetBits(32);
+
+        m_State = State::Done;
+
+        if (m_Format == Format::Gzip)
+        {
+          if (NeedBits(32))
+            GetBits(32);
+
+          // Concatenated gzip files are one file, anything else after the end is ignored
+          if (NeedBits(16) && (m_uiBitBuffer & 0xFFFF) == 0x8B1F)
+          {
+            m_State      = State::Header;
+            m_bLastBlock = false;
+          }
+        }
+
+        break;
+
+      case State::Done:
+      case State::Error:
+        return uiProduced;
+    }
+  }
+
+  return uiProduced;
+}
+
+xiiResult xiiLineCountInflateReader::Inflate(xiiArrayPtr<const xiiUInt8> data, Format format, xiiDynamicArray<xiiUInt8>& out_result, xiiUInt64 uiExpectedSize)
+{
+  xiiRawMemoryStreamReader input(data.GetPtr(), data.GetCount());
+
+  xiiLineCountInflateReader reader;
+  reader.SetInputStream(&input, format);
+
+  out_result.Clear();
+
+  if (uiExpectedSize != InvalidSize)
+  {
+    if (uiExpectedSize > xiiMath::MaxValue<xiiUInt32>())
+      return XII_FAILURE;
+
+    out_result.SetCountUninitialized(static_cast<xiiUInt32>(uiExpectedSize));
+
+    if (reader.ReadBytes(out_result.GetData(), uiExpectedSize) != uiExpectedSize)
+      return XII_FAILURE;
+
+    // There must not be any more data
+    xiiUInt8 uiExtra = 0;
+    return reader.ReadBytes(&uiExtra, 1) == 0 && !reader.HasFailed() ? XII_SUCCESS : XII_FAILURE;
+  }
+
+  // Without knowing the size, grow the result until everything is read
+  xiiUInt32 uiSize = 0;
+
+  while (true)
+  {
+    const xiiUInt32 uiChunkSize = xiiMath::Max(uiSize, 4096u);
+    out_result.SetCountUninitialized(uiSize + uiChunkSize);
+
+    const xiiUInt32 uiRead = static_cast<xiiUInt32>(reader.ReadBytes(out_result.GetData() + uiSize, uiChunkSize));
+    uiSize += uiRead;
+
+    if (uiRead < uiChunkSize)
+      break;
+  }
+
+  out_result.SetCount(uiSize);
+  return reader.HasFailed() ? XII_FAILURE : XII_SUCCESS;
+}
+
+xiiResult xiiLineCountInflateReader::BuildHuffman(Huffman& out_huffman, const xiiUInt8* pLengths, xiiUInt32 uiCount)
+{
+  xiiMemoryUtils::ZeroFill(out_huffman.m_uiCounts, 16);
+  xiiMemoryUtils::ZeroFill(out_huffman.m_uiFast, 1 << FastBits);
+
+  for (xiiUInt32 i = 0; i < uiCount; ++i)
+  {
+    ++out_huffman.m_uiCounts[pLengths[i]];
+  }
+
+  out_huffman.m_uiCounts[0] = 0;
+
+  // There must not be more codes of a length than are left over by the shorter ones
+  xiiInt32 iLeft = 1;
+  for (xiiUInt32 uiLength = 1; uiLength < 16; ++uiLength)
+  {
+    iLeft = (iLeft << 1) - out_huffman.m_uiCounts[uiLength];
+
+    if (iLeft < 0)
+      return XII_FAILURE;
+  }
+
+  // Where the symbols of each length start, and the first code of each length
+  xiiUInt16 uiOffsets[16] = {};
+  xiiUInt32 uiNextCode[16] = {};
+
+  for (xiiUInt32 uiLength = 1; uiLength < 15; ++uiLength)
+  {
+    uiOffsets[uiLength + 1] = uiOffsets[uiLength] + out_huffman.m_uiCounts[uiLength];
+  }
+
+  for (xiiUInt32 uiLength = 1; uiLength < 16; ++uiLength)
+  {
+    uiNextCode[uiLength] = (uiNextCode[uiLength - 1] + out_huffman.m_uiCounts[uiLength - 1]) << 1;
+  }
+
+  for (xiiUInt32 uiSymbol = 0; uiSymbol < uiCount; ++uiSymbol)
+  {
+    const xiiUInt32 uiLength = pLengths[uiSymbol];
+
+    if (uiLength == 0)
+      continue;
+
+    out_huffman.m_uiSymbols[uiOffsets[uiLength]++] = static_cast<xiiUInt16>(uiSymbol);
+
+    const xiiUInt32 uiCode = uiNextCode[uiLength]++;
+
+    // Deflate stores codes starting with the most significant bit, so short codes are looked up reversed.
+    // Every entry whose low bits are the code belongs to it, whatever the following bits are.
+    if (uiLength <= FastBits)
+    {
+      for (xiiUInt32 uiEntry = ReverseBits(uiCode, uiLength); uiEntry < (1u << FastBits); uiEntry += 1u << uiLength)
+      {
+        out_huffman.m_uiFast[uiEntry] = static_cast<xiiUInt16>((uiSymbol << 4) | uiLength);
+      }
+    }
+  }
+
+  return XII_SUCCESS;
+}
+
+bool xiiLineCountInflateReader::ReadInputByte(xiiUInt8& out_uiByte)
+{
+  if (m_uiInputPos == m_uiInputSize)
+  {
+    m_uiInputPos  = 0;
+    m_uiInputSize = m_pInputStream != nullptr ? static_cast<xiiUInt32>(m_pInputStream->ReadBytes(m_InputBuffer, sizeof(m_InputBuffer))) : 0;
+
+    if (m_uiInputSize == 0)
+      return false;
+  }
+
+  out_uiByte = m_InputBuffer[m_uiInputPos++];
+  return true;
+}
+
+bool xiiLineCountInflateReader::NeedBits(xiiUInt32 uiBits)
+{
+  while (m_uiBitCount < uiBits)
+  {
+    xiiUInt8 uiByte = 0;
+    if (!ReadInputByte(uiByte))
+      return false;
+
+    m_uiBitBuffer |= static_cast<xiiUInt64>(uiByte) << m_uiBitCount;
+    m_uiBitCount += 8;
+  }
+
+  return true;
+}
+
+xiiUInt32 xiiLineCountInflateReader::GetBits(xiiUInt32 uiBits)
+{
+  XII_ASSERT_DEBUG(m_uiBitCount >= uiBits, "Not enough bits available");
+
+  const xiiUInt32 uiValue = static_cast<xiiUInt32>(m_uiBitBuffer & ((1ull << uiBits) - 1));
+  m_uiBitBuffer >>= uiBits;
+  m_uiBitCount -= uiBits;
+  return uiValue;
+}
+
+xiiInt32 xiiLineCountInflateReader::DecodeSymbol(const Huffman& huffman)
+{
+  // Near the end of the data there may be fewer bits left than the longest code has
+  NeedBits(15);
+
+  const xiiUInt16 uiEntry = huffman.m_uiFast[m_uiBitBuffer & ((1u << FastBits) - 1)];
+
+  if (uiEntry != 0)
+  {
+    const xiiUInt32 uiLength = uiEntry & 0x0F;
+    if (uiLength > m_uiBitCount)
+      return -1;
+
+    GetBits(uiLength);
+    return uiEntry >> 4;
+  }
+
+  // Longer codes are decoded bit by bit: the codes of each length are consecutive numbers
+  xiiInt32 iCode  = 0;
+  xiiInt32 iFirst = 0;
+  xiiInt32 iIndex = 0;
+
+  for (xiiUInt32 uiLength = 1; uiLength < 16; ++uiLength)
+  {
+    if (m_uiBitCount == 0)
+      return -1;
+
+    iCode |= static_cast<xiiInt32>(GetBits(1));
+
+    const xiiInt32 iCount = huffman.m_uiCounts[uiLength];
+    if (iCode - iFirst < iCount)
+      return huffman.m_uiSymbols[iIndex + (iCode - iFirst)];
+
+    iIndex += iCount;
+    iFirst = (iFirst + iCount) << 1;
+    iCode <<= 1;
+  }
+
+  return -1;
+}
+
+bool xiiLineCountInflateReader::SkipInputBytes(xiiUInt32 uiBytes)
+{
+  for (xiiUInt32 i = 0; i < uiBytes; ++i)
+  {
+    if (!NeedBits(8))
+      return false;
+
+    GetBits(8);
+  }
+
+  return true;
+}
+
+bool xiiLineCountInflateReader::SkipInputString()
+{
+  while (NeedBits(8))
+  {
+    if (GetBits(8) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+xiiResult xiiLineCountInflateReader::ReadZlibHeader()
+{
+  if (!NeedBits(16))
+    return XII_FAILURE;
+
+  const xiiUInt32 uiMethod = GetBits(8);
+  const xiiUInt32 uiFlags  = GetBits(8);
+
+  // Deflate with a window of at most 32 KB, without a preset dictionary
+  if ((uiMethod & 0x0F) != 8 || (uiMethod >> 4) > 7 || ((uiMethod << 8) | uiFlags) % 31 != 0 || (uiFlags & 0x20) != 0)
+    return XII_FAILURE;
+
+  return XII_SUCCESS;
+}
+
+xiiResult xiiLineCountInflateReader::ReadGzipHeader()
+{
+  constexpr xiiUInt32 HeaderCrc = 0x02;
+  constexpr xiiUInt32 Extra     = 0x04;
+  constexpr xiiUInt32 Name      = 0x08;
+  constexpr xiiUInt32 Comment   = 0x10;
+  constexpr xiiUInt32 Reserved  = 0xE0;
+
+  // The magic number, deflate as the method and the flags
+  if (!NeedBits(32) || GetBits(16) != 0x8B1F || GetBits(8) != 8)
+    return XII_FAILURE;
+
+  const xiiUInt32 uiFlags = GetBits(8);
+
+  if ((uiFlags & Reserved) != 0)
+    return XII_FAILURE;
+
+  // The modification time, extra flags and operating system are not needed
+  if (!SkipInputBytes(6))
+    return XII_FAILURE;
+
+  if ((uiFlags & Extra) != 0)
+  {
+    if (!NeedBits(16) || !SkipInputBytes(GetBits(16)))
+      return XII_FAILURE;
+  }
+
+  if ((uiFlags & Name) != 0 && !SkipInputString())
+    return XII_FAILURE;
+
+  if ((uiFlags & Comment) != 0 && !SkipInputString())
+    return XII_FAILURE;
+
+  if ((uiFlags & HeaderCrc) != 0 && !SkipInputBytes(2))
+    return XII_FAILURE;
+
+  return XII_SUCCESS;
+}
+
+xiiResult xiiLineCountInflateReader::ReadBlockHeader()
+{
+  if (!NeedBits(3))
+    return XII_FAILURE;
+
+  m_bLastBlock = GetBits(1) != 0;
+
+  switch (GetBits(2))
+  {
+    case 0:
+    {
+      // Stored blocks start at the next byte, with their length and its complement
+      GetBits(m_uiBitCount % 8);
+
+      if (!NeedBits(32))
+        return XII_FAILURE;
+
+      const xiiUInt32 uiLength           = GetBits(16);
+      const xiiUInt32 uiLengthComplement = GetBits(16);
+
+      if (uiLength != (~uiLengthComplement & 0xFFFF))
+        return XII_FAILURE;
+
+      m_uiStoredRemaining = uiLength;
+      m_State             = State::Stored;
+      return XII_SUCCESS;
+    }
+
+    case 1:
+    {
+      // The fixed codes
+      xiiUInt8 uiLengths[288];
+      xiiMemoryUtils::PatternFill(uiLengths, 8, 144);
+      xiiMemoryUtils::PatternFill(uiLengths + 144, 9, 112);
+      xiiMemoryUtils::PatternFill(uiLengths + 256, 7, 24);
+      xiiMemoryUtils::PatternFill(uiLengths + 280, 8, 8);
+      XII_SUCCEED_OR_RETURN(BuildHuffman(m_Literals, uiLengths, 288));
+
+      xiiMemoryUtils::PatternFill(uiLengths, 5, 30);
+      XII_SUCCEED_OR_RETURN(BuildHuffman(m_Distances, uiLengths, 30));
+
+      m_State = State::Codes;
+      return XII_SUCCESS;
+    }
+
+    case 2:
+      XII_SUCCEED_OR_RETURN(ReadDynamicCodes());
+      m_State = State::Codes;
+      return XII_SUCCESS;
+
+    default:
+      return XII_FAILURE;
+  }
+}
+
+xiiResult xiiLineCountInflateReader::ReadDynamicCodes()
+{
+  if (!NeedBits(14))
+    return XII_FAILURE;
+
+  const xiiUInt32 uiLiteralCount    = GetBits(5) + 257;
+  const xiiUInt32 uiDistanceCount   = GetBits(5) + 1;
+  const xiiUInt32 uiCodeLengthCount = GetBits(4) + 4;
+
+  if (uiLiteralCount > 286 || uiDistanceCount > 30)
+    return XII_FAILURE;
+
+  // First the code that the code lengths are compressed with
+  xiiUInt8 uiLengths[286 + 30] = {};
+
+  for (xiiUInt32 i = 0; i < uiCodeLengthCount; ++i)
+  {
+    if (!NeedBits(3))
+      return XII_FAILURE;
+
+    uiLengths[s_uiCodeLengthOrder[i]] = static_cast<xiiUInt8>(GetBits(3));
+  }
+
+  Huffman& codeLengths = m_Distances; // Only needed until the actual distance code is built
+  XII_SUCCEED_OR_RETURN(BuildHuffman(codeLengths, uiLengths, 19));
+
+  // Then the code lengths of both codes in one sequence, with runs of repeated lengths
+  for (xiiUInt32 i = 0; i < uiLiteralCount + uiDistanceCount;)
+  {
+    const xiiInt32 iSymbol = DecodeSymbol(codeLengths);
+
+    if (iSymbol < 0)
+      return XII_FAILURE;
+
+    if (iSymbol < 16)
+    {
+      uiLengths[i++] = static_cast<xiiUInt8>(iSymbol);
+      continue;
+    }
+
+    xiiUInt8  uiRepeated = 0;
+    xiiUInt32 uiRepeat   = 0;
+
+    if (iSymbol == 16)
+    {
+      if (i == 0 || !NeedBits(2))
+        return XII_FAILURE;
+
+      uiRepeated = uiLengths[i - 1];
+      uiRepeat   = 3 + GetBits(2);
+    }
+    else if (iSymbol == 17)
+    {
+      if (!NeedBits(3))
+        return XII_FAILURE;
+
+      uiRepeat = 3 + GetBits(3);
+    }
+    else
+    {
+      if (!NeedBits(7))
+        return XII_FAILURE;
+
+      uiRepeat = 11 + GetBits(7);
+    }
+
+    if (i + uiRepeat > uiLiteralCount + uiDistanceCount)
+      return XII_FAILURE;
+
+    for (; uiRepeat > 0; --uiRepeat)
+    {
+      uiLengths[i++] = uiRepeated;
+    }
+  }
+
+  // Without an end of block code, the block could never end
+  if (uiLengths[256] == 0)
+    return XII_FAILURE;
+
+  XII_SUCCEED_OR_RETURN(BuildHuffman(m_Literals, uiLengths, uiLiteralCount));
+  return BuildHuffman(m_Distances, uiLengths + uiLiteralCount, uiDistanceCount);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/IO/Stream.h>
+
+// Decompresses deflate data (RFC 1951), either raw or wrapped in a zlib (RFC 1950) or gzip (RFC 1952) header, while it
+// is being read.
+//
+// The compressed data is pulled from another stream in small pieces and only the last 32 KB of output are kept,
+// which is as far back as deflate can refer to. So the memory usage does not depend on the size of the data.
+// Huffman codes of up to FastBits bits are decoded with a single table lookup, longer ones bit by bit.
+//
+// The checksums of the zlib and gzip formats are not verified. Everything that the decompressed data has to match (sizes,
+// object headers) is checked by the callers instead.
+class xiiLineCountInflateReader : public xiiStreamReader
+{
+public:
+  enum class Format : xiiUInt8
+  {
+    Raw,  // Only the deflate blocks, e.g. in zip files
+    Zlib, // A two byte header and an Adler-32 checksum around the deflate blocks, e.g. in git objects
+    Gzip, // A header with optional file name and comment and a CRC-32 around the deflate blocks, e.g. in .tar.gz files.
+          // Several of these may follow each other, they are decompressed as one.
+  };
+
+  // Starts decompressing the data of the given stream. Bytes after the end of the compressed data may be consumed as well.
+  void SetInputStream(xiiStreamReader* pInputStream, Format format);
+
+  // Returns fewer bytes than requested only at the end of the data or if the data is invalid.
+  virtual xiiUInt64 ReadBytes(void* pReadBuffer, xiiUInt64 uiBytesToRead) override;
+
+  // Whether the compressed data is invalid or ended too early. Everything that was read before the error is valid.
+  bool HasFailed() const { return m_State == State::Error; }
+
+  // Decompresses the given data completely. Fails if the data is invalid or does not decompress to uiExpectedSize bytes,
+  // unless uiExpectedSize is InvalidSize.
+  static constexpr xiiUInt64 InvalidSize = 0xFFFFFFFFFFFFFFFFull;
+  static xiiResult Inflate(xiiArrayPtr<const xiiUInt8> data, Format format, xiiDynamicArray<xiiUInt8>& out_result, xiiUInt64 uiExpectedSize = InvalidSize);
+
+private:
+  static constexpr xiiUInt32 FastBits   = 9;
+  static constexpr xiiUInt32 WindowSize = 32 * 1024;
+
+  enum class State : xiiUInt8
+  {
+    Header,
+    BlockHeader,
+    Stored,
+    Codes,
+    Trailer,
+    Done,
+    Error,
+  };
+
+  // A canonical Huffman code, as defined by the code length of every symbol
+  struct Huffman
+  {
+    xiiUInt16 m_uiFast[1 << FastBits]; // By the next FastBits input bits: the symbol << 4 | the code length, zero for longer codes
+    xiiUInt16 m_uiCounts[16];          // How many codes there are of each length
+    xiiUInt16 m_uiSymbols[288];        // The symbols, ordered by their codes
+  };
+
+  static xiiResult BuildHuffman(Huffman& out_huffman, const xiiUInt8* pLengths, xiiUInt32 uiCount);
+
+  bool      ReadInputByte(xiiUInt8& out_uiByte);
+  bool      NeedBits(xiiUInt32 uiBits);
+  xiiUInt32 GetBits(xiiUInt32 uiBits);
+  xiiInt32  DecodeSymbol(const Huffman& huffman);
+  bool      SkipInputBytes(xiiUInt32 uiBytes);
+  bool      SkipInputString();
+  xiiResult ReadZlibHeader();
+  xiiResult ReadGzipHeader();
+  xiiResult ReadBlockHeader();
+  xiiResult ReadDynamicCodes();
+  void      Fail() { m_State = State::Error; }
+
+  xiiStreamReader* m_pInputStream = nullptr;
+  Format           m_Format       = Format::Raw;
+  State            m_State        = State::Done;
+  bool             m_bLastBlock   = false;
+
+  // The input is buffered, so that bits can be taken one byte at a time
+  xiiUInt8  m_InputBuffer[4096];
+  xiiUInt32 m_uiInputPos  = 0;
+  xiiUInt32 m_uiInputSize = 0;
+  xiiUInt64 m_uiBitBuffer = 0;
+  xiiUInt32 m_uiBitCount  = 0;
+
+  // A stored block or a match that did not fit into the output buffer of the last call
+  xiiUInt32 m_uiStoredRemaining = 0;
+  xiiUInt32 m_uiCopyRemaining   = 0;
+  xiiUInt32 m_uiCopyDistance    = 0;
+
+  xiiUInt8  m_Window[WindowSize];
+  xiiUInt64 m_uiTotalOutput = 0;
+
+  Huffman m_Literals;
+  Huffman m_Distances;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Foundation/Threading/AtomicInteger.h>
+
+// A bounded queue that any number of threads may push to and pop from at the same time, without taking a lock.
+//
+// Every cell carries a sequence number, which tells whether the cell is ready to be written (sequence == position)
+// or ready to be read (sequence == position + 1). Producers and consumers only compete for their respective
+// position counter, so a push and a pop never block each other.
+template <typename T, xiiUInt32 Capacity>
+class xiiLineCountJobQueue
+{
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+public:
+  xiiLineCountJobQueue()
+  {
+    for (xiiUInt32 i = 0; i < Capacity; ++i)
+    {
+      m_Cells[i].m_iSequence.Set(i);
+    }
+  }
+
+  // Returns false if the queue is full.
+  bool TryPush(const T& item)
+  {
+    xiiInt64 iPos = m_iEnqueuePos;
+
+    while (true)
+    {
+      Cell&          cell  = m_Cells[iPos & s_iMask];
+      const xiiInt64 iDiff = (xiiInt64)cell.m_iSequence - iPos;
+
+      if (iDiff == 0)
+      {
+        if (m_iEnqueuePos.TestAndSet(iPos, iPos + 1))
+        {
+          cell.m_Item = item;
+          cell.m_iSequence.Set(iPos + 1);
+          return true;
+        }
+      }
+      else if (iDiff < 0)
+      {
+        // The cell still holds an item from the previous round
+        return false;
+      }
+
+      iPos = m_iEnqueuePos;
+    }
+  }
+
+  // Returns false if the queue is empty.
+  bool TryPop(T& out_item)
+  {
+    xiiInt64 iPos = m_iDequeuePos;
+
+    while (true)
+    {
+      Cell&          cell  = m_Cells[iPos & s_iMask];
+      const xiiInt64 iDiff = (xiiInt64)cell.m_iSequence - (iPos + 1);
+
+      if (iDiff == 0)
+      {
+        if (m_iDequeuePos.TestAndSet(iPos, iPos + 1))
+        {
+          out_item = cell.m_Item;
+          cell.m_iSequence.Set(iPos + Capacity);
+          return true;
+        }
+      }
+      else if (iDiff < 0)
+      {
+        // The cell was not written yet
+        return false;
+      }
+
+      iPos = m_iDequeuePos;
+    }
+  }
+
+  // Returns the number of items in the queue. This is only a snapshot, other threads may change it at any time.
+  xiiUInt32 GetCount() const
+  {
+    const xiiInt64 iCount = (xiiInt64)m_iEnqueuePos - (xiiInt64)m_iDequeuePos;
+    return (xiiUInt32)xiiMath::Clamp<xiiInt64>(iCount, 0, Capacity);
+  }
+
+private:
+  static constexpr xiiInt64 s_iMask = Capacity - 1;
+
+  struct Cell
+  {
+    xiiAtomicInteger64 m_iSequence;
+    T                  m_Item;
+  };
+
+  Cell m_Cells[Capacity];
+
+  // Kept on separate cache lines, so that producers and consumers don't slow each other down
+  alignas(64) xiiAtomicInteger64 m_iEnqueuePos;
+  alignas(64) xiiAtomicInteger64 m_iDequeuePos;
+};
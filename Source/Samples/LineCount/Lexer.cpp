@@ -0,0 +1,742 @@
+#include <LineCount/Lexer.h>
+
+#include <Foundation/Math/Math.h>
+
+namespace
+{
+  // The states of the lexer. Everything from SlashSeen on depends on the next character, so it is never skipped over.
+  enum LexerState : xiiUInt8
+  {
+    Code,
+    LineComment,
+    BlockComment,
+    String,
+    Character,
+    SlashSeen,         // A '/' in code, which may start a comment
+    StarSeen,          // A '*' in a block comment, which may end it
+    StringEscape,      // A '\' in a string literal
+    CharacterEscape,   // A '\' in a character literal
+    LineCommentEscape, // A '\' in a line comment, which continues it on the next line
+    StateCount,
+    FirstPendingState = SlashSeen,
+  };
+
+  // The character classes, everything that is not listed here is 'Other'
+  enum Class : xiiUInt8
+  {
+    Other,
+    Blank,
+    Newline,
+    Slash,
+    Star,
+    DoubleQuote,
+    SingleQuote,
+    Backslash,
+    ClassCount,
+  };
+
+  // What a character makes its line, stored next to the state in a transition
+  constexpr xiiUInt8 IsCode    = 1 << 4;
+  constexpr xiiUInt8 IsComment = 2 << 4;
+
+  // How much of a section header ('[NAME]' alone on its line) the current line matches
+  enum Section : xiiUInt8
+  {
+    NoSection,
+    LineStart,
+    OpenBracket,
+    SectionName,
+    CloseBracket,
+  };
+
+  constexpr xiiUInt32 s_uiStateMask = 0x0F;
+} // namespace
+
+// One transition per state and character class: the next state in the low bits, IsCode / IsComment in the high bits
+struct xiiLineCountLanguageTable
+{
+  xiiUInt8 m_Transitions[StateCount][ClassCount];
+  xiiUInt8 m_uiEventClasses[StateCount]; // Per state, one bit per class that has to be stepped through the table
+  bool     m_bSections;
+  bool     m_bCFamily; // Whether the transitions are the ones of C, which blocks handle as a whole, see ProcessRegions()
+};
+
+namespace
+{
+  constexpr xiiUInt8 s_Classes[128] = {
+    // clang-format off
+    Other, Other, Other, Other, Other, Other, Other, Other, Other, Blank, Newline, Other, Other, Other, Other, Other,
+    Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other,   Other, Other, Other, Other, Other,
+    Blank, Other, DoubleQuote, Other, Other, Other, Other, SingleQuote, Other, Other, Star, Other, Other, Other, Other, Slash,
+    Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other,
+    Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other,
+    Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Backslash, Other, Other, Other,
+    Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other,
+    Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other, Other,
+    // clang-format on
+  };
+
+  // clang-format off
+  constexpr xiiUInt8 s_TextTransitions[StateCount][ClassCount] = {
+    //          Other          Blank Newline Slash          Star           DoubleQuote    SingleQuote    Backslash
+    /* Code */ {Code | IsCode, Code, Code,   Code | IsCode, Code | IsCode, Code | IsCode, Code | IsCode, Code | IsCode},
+  };
+
+  constexpr xiiUInt8 s_CTransitions[StateCount][ClassCount] = {
+    //                    Other                     Blank               Newline        Slash                     Star                      DoubleQuote               SingleQuote               Backslash
+    /* Code */           {Code | IsCode,            Code,               Code,          SlashSeen,                Code | IsCode,            String | IsCode,          Character | IsCode,       Code | IsCode},
+    /* LineComment */    {LineComment | IsComment,  LineComment,        Code,          LineComment | IsComment,  LineComment | IsComment,  LineComment | IsComment,  LineComment | IsComment,  LineCommentEscape | IsComment},
+    /* BlockComment */   {BlockComment | IsComment, BlockComment,       BlockComment,  BlockComment | IsComment, StarSeen | IsComment,     BlockComment | IsComment, BlockComment | IsComment, BlockComment | IsComment},
+    /* String */         {String | IsCode,          String,             Code,          String | IsCode,          String | IsCode,          Code | IsCode,            String | IsCode,          StringEscape | IsCode},
+    /* Character */      {Character | IsCode,       Character,          Code,          Character | IsCode,       Character | IsCode,       Character | IsCode,       Code | IsCode,            CharacterEscape | IsCode},
+    /* SlashSeen */      {Code | IsCode,            Code | IsCode,      Code | IsCode, LineComment | IsComment,  BlockComment | IsComment, String | IsCode,          Character | IsCode,       Code | IsCode},
+    /* StarSeen */       {BlockComment | IsComment, BlockComment,       BlockComment,  Code | IsComment,         StarSeen | IsComment,     BlockComment | IsComment, BlockComment | IsComment, BlockComment | IsComment},
+    /* StringEscape */   {String | IsCode,          String | IsCode,    String,        String | IsCode,          String | IsCode,          String | IsCode,          String | IsCode,          String | IsCode},
+    /* CharEscape */     {Character | IsCode,       Character | IsCode, Character,     Character | IsCode,       Character | IsCode,       Character | IsCode,       Character | IsCode,       Character | IsCode},
+    /* LineCommentEsc */ {LineComment | IsComment,  LineComment,        LineComment,   LineComment | IsComment,  LineComment | IsComment,  LineComment | IsComment,  LineComment | IsComment,  LineCommentEscape | IsComment},
+  };
+  // clang-format on
+
+  constexpr bool IsCFamily(const xiiUInt8 (&transitions)[StateCount][ClassCount])
+  {
+    for (xiiUInt32 s = 0; s < StateCount; ++s)
+    {
+      for (xiiUInt32 c = 0; c < ClassCount; ++c)
+      {
+        if (transitions[s][c] != s_CTransitions[s][c])
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+  constexpr xiiLineCountLanguageTable MakeTable(const xiiUInt8 (&transitions)[StateCount][ClassCount], bool bSections)
+  {
+    xiiLineCountLanguageTable table = {};
+
+    for (xiiUInt32 s = 0; s < StateCount; ++s)
+    {
+      // Blanks are never content and can't change the state of a run. Newlines that keep the state only end lines,
+      // which runs handle on their own, unless the line may be a section header.
+      table.m_uiEventClasses[s] = 0;
+
+      if (bSections || transitions[s][Newline] != s)
+        table.m_uiEventClasses[s] |= 1u << Newline;
+
+      // Pending states depend on the very next character, whatever it is
+      if (s >= FirstPendingState)
+        table.m_uiEventClasses[s] |= 1u << Other;
+
+      for (xiiUInt32 c = 0; c < ClassCount; ++c)
+      {
+        table.m_Transitions[s][c] = transitions[s][c];
+
+        if (c >= Slash && transitions[s][c] != transitions[s][Other])
+          table.m_uiEventClasses[s] |= static_cast<xiiUInt8>(1u << c);
+      }
+    }
+
+    table.m_bSections = bSections;
+    table.m_bCFamily  = IsCFamily(transitions);
+    return table;
+  }
+
+  // ORs the masks of the given classes. As the classes are known at compile time, only the ORs that are needed remain.
+  template <xiiUInt32 Classes>
+  XII_ALWAYS_INLINE xiiUInt32 CombineMasks(const xiiUInt32 (&masks)[ClassCount])
+  {
+    xiiUInt32 uiResult = 0;
+
+    if constexpr ((Classes & (1u << Other)) != 0)
+      uiResult |= masks[Other];
+    if constexpr ((Classes & (1u << Newline)) != 0)
+      uiResult |= masks[Newline];
+    if constexpr ((Classes & (1u << Slash)) != 0)
+      uiResult |= masks[Slash];
+    if constexpr ((Classes & (1u << Star)) != 0)
+      uiResult |= masks[Star];
+    if constexpr ((Classes & (1u << DoubleQuote)) != 0)
+      uiResult |= masks[DoubleQuote];
+    if constexpr ((Classes & (1u << SingleQuote)) != 0)
+      uiResult |= masks[SingleQuote];
+    if constexpr ((Classes & (1u << Backslash)) != 0)
+      uiResult |= masks[Backslash];
+
+    return uiResult;
+  }
+
+  // A '/' in code only makes a difference if a '/' or a '*' follows it. For every other character, SlashSeen has to go
+  // where 'Other' followed by that character would, so that the blocks can treat such slashes as plain code.
+  constexpr bool SlashSeenActsLikeCode(const xiiUInt8 (&transitions)[StateCount][ClassCount])
+  {
+    if (transitions[Code][Slash] != SlashSeen)
+      return true;
+
+    for (xiiUInt32 c = 0; c < ClassCount; ++c)
+    {
+      const xiiUInt8 uiAfterOther = transitions[transitions[Code][Other] & s_uiStateMask][c] | (transitions[Code][Other] & ~s_uiStateMask);
+
+      if (c != Slash && c != Star && transitions[SlashSeen][c] != uiAfterOther)
+        return false;
+    }
+
+    return true;
+  }
+
+  static_assert(SlashSeenActsLikeCode(s_CTransitions), "Only slashes in front of '/' or '*' may be skipped");
+
+  constexpr xiiLineCountLanguageTable s_TextTable      = MakeTable(s_TextTransitions, false);
+  constexpr xiiLineCountLanguageTable s_CTable         = MakeTable(s_CTransitions, false);
+  constexpr xiiLineCountLanguageTable s_XiiShaderTable = MakeTable(s_CTransitions, true);
+
+  static_assert(s_CTable.m_uiEventClasses[BlockComment] == (1u << Star), "Only a '*' may end a block comment");
+  static_assert(s_TextTable.m_uiEventClasses[Code] == 0, "Text is handled in runs entirely");
+
+  constexpr bool IsSectionNameCharacter(xiiUInt8 uiChar)
+  {
+    return (uiChar >= 'A' && uiChar <= 'Z') || uiChar == '_';
+  }
+} // namespace
+
+xiiLineCountLexer::xiiLineCountLexer()
+{
+  SetLanguage(xiiLineCountLanguage::Text);
+}
+
+void xiiLineCountLexer::SetLanguage(xiiLineCountLanguage language)
+{
+  switch (language)
+  {
+    case xiiLineCountLanguage::C:
+      m_pTable           = &s_CTable;
+      m_ProcessBlockFunc = &ProcessAsciiBlock<s_CTable>;
+      break;
+    case xiiLineCountLanguage::XiiShader:
+      m_pTable           = &s_XiiShaderTable;
+      m_ProcessBlockFunc = &ProcessAsciiBlock<s_XiiShaderTable>;
+      break;
+    default:
+      m_pTable           = &s_TextTable;
+      m_ProcessBlockFunc = &ProcessAsciiBlock<s_TextTable>;
+      break;
+  }
+
+  Reset();
+}
+
+void xiiLineCountLexer::Reset()
+{
+  m_State             = {};
+  m_State.m_uiState   = Code;
+  m_State.m_uiSection = m_pTable->m_bSections ? LineStart : NoSection;
+}
+
+void xiiLineCountLexer::ProcessByte(xiiUInt8 uiChar)
+{
+  XII_ASSERT_DEBUG(uiChar < 0x80 && uiChar != '\r', "Invalid character");
+  Step(*m_pTable, m_State, s_Classes[uiChar], uiChar);
+}
+
+void xiiLineCountLexer::ProcessOther()
+{
+  Step(*m_pTable, m_State, Other, 0);
+}
+
+void xiiLineCountLexer::Finish(FileStats& inout_stats)
+{
+  // A '/' at the very end of the text is code after all
+  if (m_State.m_uiState == SlashSeen)
+    m_State.m_uiLineFlags |= IsCode;
+
+  EndLine(*m_pTable, m_State);
+
+  inout_stats.m_uiCodeLines += m_State.m_uiLineCounts[IsCode >> 4];
+  inout_stats.m_uiCommentLines += m_State.m_uiLineCounts[IsComment >> 4];
+  inout_stats.m_uiMixedLines += m_State.m_uiLineCounts[(IsCode | IsComment) >> 4];
+
+  Reset();
+}
+
+template <const xiiLineCountLanguageTable& Table>
+void xiiLineCountLexer::ProcessAsciiBlock(State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, const ClassMasks& classes)
+{
+  // A '/' that is not followed by another '/' or a '*' behaves just like 'Other' (see SlashSeenActsLikeCode()), so only
+  // the ones that may start a comment are events. What follows the last character of the block is not known yet.
+  const xiiUInt32 uiCommentSlashes = classes.m_uiSlashes & (((classes.m_uiSlashes | classes.m_uiStars) >> 1) | 0x80000000u);
+
+  // 'Other' stands for every character, it is only an event class of the pending states
+  const xiiUInt32 uiClassMasks[ClassCount] = {0xFFFFFFFFu, 0, uiNewlines, uiCommentSlashes, classes.m_uiStars, classes.m_uiDoubleQuotes, classes.m_uiSingleQuotes, classes.m_uiBackslashes};
+
+  // Most blocks are code without a single event in them, so they are one run. This is checked before anything else is
+  // prepared, the other states are handled by ProcessRegions() or ProcessEvents().
+  xiiUInt32 uiCodeEvents = CombineMasks<Table.m_uiEventClasses[Code]>(uiClassMasks) & ~uiSkip;
+
+  if constexpr (Table.m_bSections)
+  {
+    uiCodeEvents |= ref_state.m_uiSection != NoSection ? 0xFFFFFFFFu : 0;
+  }
+
+  if (ref_state.m_uiState == Code && uiCodeEvents == 0)
+  {
+    // The run is all code, and there is no section header that it could end (see MarkRun())
+    static_assert(Table.m_Transitions[Code][Other] == (Code | IsCode), "Code must stay code");
+    CountLines(ref_state, uiNewlines, uiContent, 0);
+    return;
+  }
+
+  if constexpr (Table.m_bCFamily && !Table.m_bSections)
+  {
+    ProcessRegions(ref_state, pBlock, uiNewlines, uiContent, uiSkip, classes, uiCommentSlashes);
+  }
+  else
+  {
+    ProcessEvents<Table>(ref_state, pBlock, uiNewlines, uiContent, uiSkip, classes.m_uiBrackets, uiClassMasks);
+  }
+}
+
+namespace
+{
+  // The characters from the given position to the end of the block, for positions up to 32
+  XII_ALWAYS_INLINE xiiUInt32 MaskFrom(xiiUInt32 uiPos)
+  {
+    return static_cast<xiiUInt32>(0xFFFFFFFFull << uiPos);
+  }
+
+  // The characters that the given backslashes escape in a string or character literal: the one after every run of an odd
+  // number of backslashes. Bit 32 tells whether the character after the block is escaped. The runs must not continue a
+  // run from before the block.
+  XII_ALWAYS_INLINE xiiUInt64 GetEscapedCharacters(xiiUInt32 uiBackslashes, xiiUInt32 uiSkip)
+  {
+    constexpr xiiUInt64 uiEvenBits = 0x5555555555555555ull;
+
+    // Adding the first backslash of a run carries over the whole run, to the character right after it. Runs starting on
+    // even and on odd bits are carried separately, the parity of that character tells the parity of the run length.
+    const xiiUInt64 uiRuns      = uiBackslashes;
+    const xiiUInt64 uiRunStarts = uiRuns & ~(uiRuns << 1);
+    const xiiUInt64 uiEvenEnds  = (uiRuns + (uiRunStarts & uiEvenBits)) & ~uiRuns;
+    const xiiUInt64 uiOddEnds   = (uiRuns + (uiRunStarts & ~uiEvenBits)) & ~uiRuns;
+    const xiiUInt64 uiEscaped   = (uiEvenEnds & ~uiEvenBits) | (uiOddEnds & uiEvenBits);
+
+    // Carriage returns are skipped, the newline behind them is escaped instead
+    return (uiEscaped & ~static_cast<xiiUInt64>(uiSkip)) | ((uiEscaped & uiSkip) << 1);
+  }
+} // namespace
+
+void xiiLineCountLexer::ProcessRegions(State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, const ClassMasks& classes, xiiUInt32 uiCommentSlashes)
+{
+  // In C, the text is split into regions: code, string and character literals, line and block comments. Each region ends
+  // at a character that can be found with a few bit operations, so a region is handled as a whole instead of stepping
+  // from one special character to the next. This follows s_CTransitions exactly, which the table checks (m_bCFamily).
+  xiiUInt32 uiCode    = 0;
+  xiiUInt32 uiComment = 0;
+
+  State     state   = ref_state;
+  xiiUInt32 uiStart = 0;
+
+  // Each of these marks its region from uiStart on. If the region ends in the block, they continue with the code behind
+  // it, otherwise they leave the state that the next block continues with.
+  auto EndLiteral = [&](xiiUInt32 uiQuotes, xiiUInt8 uiEscapeState) -> bool
+  {
+    const xiiUInt32 uiFrom        = MaskFrom(uiStart);
+    const xiiUInt32 uiBackslashes = classes.m_uiBackslashes & uiFrom;
+    const xiiUInt64 uiEscaped     = uiBackslashes != 0 ? GetEscapedCharacters(uiBackslashes, uiSkip) : 0;
+
+    // A literal ends at its closing quote, or unterminated at the end of its line
+    const xiiUInt32 uiEnds = (uiQuotes | uiNewlines) & ~static_cast<xiiUInt32>(uiEscaped) & uiFrom;
+
+    if (uiEnds == 0)
+    {
+      uiCode |= uiContent & uiFrom;
+      state.m_uiState = (uiEscaped >> 32) != 0 ? uiEscapeState : state.m_uiState;
+      return false;
+    }
+
+    const xiiUInt32 uiPos = xiiMath::FirstBitLow(uiEnds);
+    const xiiUInt32 uiBit = 1u << uiPos;
+
+    uiCode |= uiContent & uiFrom & (uiBit | (uiBit - 1));
+    uiStart = uiPos + 1;
+    return true;
+  };
+
+  auto EndLineComment = [&]() -> bool
+  {
+    // Any backslash right in front of a newline continues the comment on the next line
+    const xiiUInt32 uiFrom            = MaskFrom(uiStart);
+    const xiiUInt32 uiBackslashes     = classes.m_uiBackslashes & uiFrom;
+    const xiiUInt32 uiEscapedNewlines = (uiBackslashes << 1) | ((uiBackslashes << 2) & (uiSkip << 1));
+    const xiiUInt32 uiEnds            = uiNewlines & ~uiEscapedNewlines & uiFrom;
+
+    if (uiEnds == 0)
+    {
+      uiComment |= uiContent & uiFrom;
+
+      // A carriage return at the end of the block is skipped, the backslash in front of it may escape the newline
+      if (((uiBackslashes | ((uiBackslashes << 1) & uiSkip)) >> 31) != 0)
+        state.m_uiState = LineCommentEscape;
+      return false;
+    }
+
+    const xiiUInt32 uiPos = xiiMath::FirstBitLow(uiEnds);
+
+    uiComment |= uiContent & uiFrom & ((1u << uiPos) - 1);
+    uiStart = uiPos + 1;
+    return true;
+  };
+
+  auto EndBlockComment = [&]() -> bool
+  {
+    // The '*' of every '*/'
+    const xiiUInt32 uiFrom = MaskFrom(uiStart);
+    const xiiUInt32 uiEnds = classes.m_uiStars & (classes.m_uiSlashes >> 1) & uiFrom;
+
+    if (uiEnds == 0)
+    {
+      uiComment |= uiContent & uiFrom;
+
+      if (((classes.m_uiStars & uiFrom) >> 31) != 0)
+        state.m_uiState = StarSeen;
+      return false;
+    }
+
+    // The '/' comes right after the '*', so it is still in the block
+    const xiiUInt32 uiSlashPos = xiiMath::FirstBitLow(uiEnds) + 1;
+    const xiiUInt32 uiSlashBit = 1u << uiSlashPos;
+
+    uiComment |= uiContent & uiFrom & (uiSlashBit | (uiSlashBit - 1));
+    uiStart = uiSlashPos + 1;
+    return true;
+  };
+
+  // The pending states depend on a character of the last block, so they only occur at the start of a block. Stepping
+  // through the next characters one by one resolves them.
+  while (state.m_uiState >= FirstPendingState)
+  {
+    const xiiUInt32 uiNext = ~uiSkip & MaskFrom(uiStart);
+    if (uiNext == 0)
+    {
+      CountLines(state, uiNewlines, uiCode, uiComment);
+      ref_state = state;
+      return;
+    }
+
+    const xiiUInt32 uiPos = xiiMath::FirstBitLow(uiNext);
+    StepAt(s_CTable, state, pBlock, uiPos, uiCode, uiComment);
+    uiStart = uiPos + 1;
+  }
+
+  // The region that was open at the end of the last block
+  bool bInCode = true;
+
+  switch (state.m_uiState)
+  {
+    case String:
+      bInCode = EndLiteral(classes.m_uiDoubleQuotes, StringEscape);
+      break;
+    case Character:
+      bInCode = EndLiteral(classes.m_uiSingleQuotes, CharacterEscape);
+      break;
+    case LineComment:
+      bInCode = EndLineComment();
+      break;
+    case BlockComment:
+      bInCode = EndBlockComment();
+      break;
+    default:
+      break;
+  }
+
+  if (bInCode)
+  {
+    const xiiUInt32 uiCodeEvents = uiCommentSlashes | classes.m_uiDoubleQuotes | classes.m_uiSingleQuotes;
+    state.m_uiState              = Code;
+
+    while (true)
+    {
+      const xiiUInt32 uiFrom   = MaskFrom(uiStart);
+      const xiiUInt32 uiEvents = uiCodeEvents & uiFrom;
+
+      if (uiEvents == 0)
+      {
+        uiCode |= uiContent & uiFrom;
+        break;
+      }
+
+      const xiiUInt32 uiPos = xiiMath::FirstBitLow(uiEvents);
+      const xiiUInt32 uiBit = 1u << uiPos;
+
+      // The quotes are part of their literal, a '/' that starts a comment doesn't mark its line on its own
+      uiCode |= uiContent & uiFrom & (uiBit - 1);
+      uiStart = uiPos + 1;
+
+      if ((classes.m_uiDoubleQuotes & uiBit) != 0)
+      {
+        uiCode |= uiBit;
+        state.m_uiState = String;
+
+        if (!EndLiteral(classes.m_uiDoubleQuotes, StringEscape))
+          break;
+      }
+      else if ((classes.m_uiSingleQuotes & uiBit) != 0)
+      {
+        uiCode |= uiBit;
+        state.m_uiState = Character;
+
+        if (!EndLiteral(classes.m_uiSingleQuotes, CharacterEscape))
+          break;
+      }
+      else if (uiPos == 31)
+      {
+        // Only the next block tells whether this starts a comment
+        state.m_uiState = SlashSeen;
+        break;
+      }
+      else if ((classes.m_uiSlashes & (uiBit << 1)) != 0)
+      {
+        state.m_uiState = LineComment;
+
+        if (!EndLineComment())
+          break;
+      }
+      else
+      {
+        // The '*' may not end the comment right away, '/*/' is still open
+        uiComment |= uiBit << 1;
+        state.m_uiState = BlockComment;
+        uiStart         = uiPos + 2;
+
+        if (!EndBlockComment())
+          break;
+      }
+
+      state.m_uiState = Code;
+    }
+  }
+
+  CountLines(state, uiNewlines, uiCode, uiComment);
+  ref_state = state;
+}
+
+template <const xiiLineCountLanguageTable& Table>
+void xiiLineCountLexer::ProcessEvents(State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, xiiUInt32 uiBrackets, const xiiUInt32 (&classMasks)[8])
+{
+  // The characters that make a difference in each state
+  const xiiUInt32 uiStateEvents[StateCount] = {
+    CombineMasks<Table.m_uiEventClasses[Code]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[LineComment]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[BlockComment]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[String]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[Character]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[SlashSeen]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[StarSeen]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[StringEscape]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[CharacterEscape]>(classMasks),
+    CombineMasks<Table.m_uiEventClasses[LineCommentEscape]>(classMasks),
+  };
+
+  // The characters that make a difference in the given state, from the given position on
+  auto GetEvents = [&](const State& state, xiiUInt32 uiStart)
+  {
+    xiiUInt32 uiEvents = uiStateEvents[state.m_uiState];
+
+    // At the start of a line '[' matters as well, and once a section header started, every character does
+    if constexpr (Table.m_bSections)
+    {
+      uiEvents |= state.m_uiSection == LineStart ? uiBrackets : 0;
+      uiEvents |= state.m_uiSection >= OpenBracket ? 0xFFFFFFFFu : 0;
+    }
+
+    return uiEvents & ~uiSkip & static_cast<xiiUInt32>(0xFFFFFFFFull << uiStart);
+  };
+
+  // The positions of the characters that make their line code or comment. Lines are only counted once at the end, every
+  // run and every step just marks its characters.
+  xiiUInt32 uiCode    = 0;
+  xiiUInt32 uiComment = 0;
+
+  State     state       = ref_state;
+  xiiUInt32 uiStart     = 0;
+  xiiUInt32 uiLineStart = 0; // Only tracked with sections, which step through every newline
+
+  // Steps through the character at the given position and marks what it makes its line
+  auto StepAt = [&](xiiUInt32 uiPos)
+  {
+    if (!xiiLineCountLexer::StepAt(Table, state, pBlock, uiPos, uiCode, uiComment))
+      return;
+
+    if constexpr (Table.m_bSections)
+    {
+      // A section header is code, no matter what the lexer made of it, and nothing carries over into the new section
+      if (state.m_uiSection == CloseBracket)
+      {
+        const xiiUInt32 uiLineMask = static_cast<xiiUInt32>(((xiiUInt64(1) << uiPos) - 1) & ~((xiiUInt64(1) << uiLineStart) - 1));
+        uiCode &= ~uiLineMask;
+        uiComment &= ~uiLineMask;
+
+        if (uiLineStart == 0)
+          state.m_uiLineFlags = IsCode;
+        else
+          uiCode |= 1u << uiLineStart;
+
+        state.m_uiState = Code;
+      }
+
+      state.m_uiSection = LineStart;
+      uiLineStart       = uiPos + 1;
+    }
+  };
+
+  while (true)
+  {
+    const xiiUInt32 uiEvents = GetEvents(state, uiStart);
+    const xiiUInt32 uiEnd    = uiEvents != 0 ? xiiMath::FirstBitLow(uiEvents) : 32;
+    const xiiUInt32 uiRun    = static_cast<xiiUInt32>(((xiiUInt64(1) << uiEnd) - 1) & ~((xiiUInt64(1) << uiStart) - 1));
+
+    MarkRun(Table, state, uiContent & uiRun, uiCode, uiComment);
+
+    if (uiEvents == 0)
+      break;
+
+    StepAt(uiEnd);
+    uiStart = uiEnd + 1;
+
+  }
+
+  CountLines(state, uiNewlines, uiCode, uiComment);
+  ref_state = state;
+}
+
+XII_ALWAYS_INLINE bool xiiLineCountLexer::StepAt(const xiiLineCountLanguageTable& table, State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiPos, xiiUInt32& ref_uiCode, xiiUInt32& ref_uiComment)
+{
+  const xiiUInt32 uiClass = s_Classes[pBlock[uiPos]];
+  const xiiUInt32 uiFlags = Transition(table, ref_state, uiClass, pBlock[uiPos]);
+
+  if (uiClass != Newline)
+  {
+    ref_uiCode |= ((uiFlags & IsCode) != 0 ? 1u : 0u) << uiPos;
+    ref_uiComment |= ((uiFlags & IsComment) != 0 ? 1u : 0u) << uiPos;
+    return false;
+  }
+
+  // A newline only decides what the character in front of it is (e.g. a '/' at the end of the line), which belongs to
+  // the line that ends here. That character is in front of the newline or in an earlier block.
+  const xiiUInt32 uiLineBit = uiPos > 0 ? 1u << (uiPos - 1) : 0;
+  ref_uiCode |= (uiFlags & IsCode) != 0 ? uiLineBit : 0;
+  ref_uiComment |= (uiFlags & IsComment) != 0 ? uiLineBit : 0;
+  ref_state.m_uiLineFlags |= uiPos == 0 ? uiFlags : 0;
+  return true;
+}
+
+XII_ALWAYS_INLINE void xiiLineCountLexer::MarkRun(const xiiLineCountLanguageTable& table, State& ref_state, xiiUInt32 uiRunContent, xiiUInt32& ref_uiCode, xiiUInt32& ref_uiComment)
+{
+  // All content in the run is code or comment, just like 'Other' would be, and newlines don't change the state
+  const xiiUInt32 uiFlags = table.m_Transitions[ref_state.m_uiState][Other];
+
+  ref_uiCode |= uiRunContent & (0u - ((uiFlags & IsCode) != 0 ? 1u : 0u));
+  ref_uiComment |= uiRunContent & (0u - ((uiFlags & IsComment) != 0 ? 1u : 0u));
+
+  // Only languages with sections step through newlines one by one, so a run that contains content ends a possible section header
+  if (table.m_bSections)
+  {
+    ref_state.m_uiSection = uiRunContent != 0 ? NoSection : ref_state.m_uiSection;
+  }
+}
+
+XII_ALWAYS_INLINE void xiiLineCountLexer::CountLines(State& ref_state, xiiUInt32 uiNewlines, xiiUInt32 uiCode, xiiUInt32 uiComment)
+{
+  // Moves every marked bit up to the next newline, carrying it over everything in between. The newlines that receive a
+  // bit that way end a line with code or comment. The marks are never on newlines themselves.
+  const xiiUInt32 uiCodeLines    = static_cast<xiiUInt32>((xiiUInt64(uiCode) << 1) + ~xiiUInt64(uiCode | uiNewlines)) & uiNewlines;
+  const xiiUInt32 uiCommentLines = static_cast<xiiUInt32>((xiiUInt64(uiComment) << 1) + ~xiiUInt64(uiComment | uiNewlines)) & uiNewlines;
+  const xiiUInt32 uiFirstNewline = uiNewlines & (0u - uiNewlines);
+  const xiiUInt32 uiInnerLines   = uiNewlines & ~uiFirstNewline;
+
+  // Everything is computed without branches, the positions of newlines and comments are hardly predictable. The selects
+  // are spelled out as masks, compilers tend to turn conditionals into jumps here. The first line started before the
+  // block, the last one continues after it.
+  const xiiUInt32 uiEndsLines     = uiNewlines != 0 ? 1u : 0u;
+  const xiiUInt32 uiEndsLinesMask = 0u - uiEndsLines;
+  const xiiUInt32 uiFirstCode     = (uiCodeLines & uiFirstNewline & uiEndsLinesMask) | (uiCode & ~uiEndsLinesMask);
+  const xiiUInt32 uiFirstComment  = (uiCommentLines & uiFirstNewline & uiEndsLinesMask) | (uiComment & ~uiEndsLinesMask);
+  const xiiUInt32 uiLineFlags     = ref_state.m_uiLineFlags | (IsCode & (0u - (uiFirstCode != 0 ? 1u : 0u))) | (IsComment & (0u - (uiFirstComment != 0 ? 1u : 0u)));
+
+  ref_state.m_uiLineCounts[uiLineFlags >> 4] += uiEndsLines;
+  ref_state.m_uiLineCounts[IsCode >> 4] += xiiMath::CountBits(uiCodeLines & ~uiCommentLines & uiInnerLines);
+  ref_state.m_uiLineCounts[IsComment >> 4] += xiiMath::CountBits(uiCommentLines & ~uiCodeLines & uiInnerLines);
+  ref_state.m_uiLineCounts[(IsCode | IsComment) >> 4] += xiiMath::CountBits(uiCodeLines & uiCommentLines & uiInnerLines);
+
+  // Marks after the last newline are the highest bits of all, if there are any
+  const xiiUInt32 uiLastLineFlags = (IsCode & (0u - (uiCode > uiNewlines ? 1u : 0u))) | (IsComment & (0u - (uiComment > uiNewlines ? 1u : 0u)));
+  ref_state.m_uiLineFlags         = (uiLastLineFlags & uiEndsLinesMask) | (uiLineFlags & ~uiEndsLinesMask);
+}
+
+XII_ALWAYS_INLINE xiiUInt32 xiiLineCountLexer::Transition(const xiiLineCountLanguageTable& table, State& ref_state, xiiUInt32 uiClass, xiiUInt8 uiChar)
+{
+  const xiiUInt8 uiTransition = table.m_Transitions[ref_state.m_uiState][uiClass];
+
+  ref_state.m_uiState = uiTransition & s_uiStateMask;
+
+  if (table.m_bSections)
+  {
+    switch (ref_state.m_uiSection)
+    {
+      case LineStart:
+        if (uiClass != Blank && uiClass != Newline)
+          ref_state.m_uiSection = uiChar == '[' ? OpenBracket : NoSection;
+        break;
+
+      case OpenBracket:
+      case SectionName:
+        if (IsSectionNameCharacter(uiChar))
+          ref_state.m_uiSection = SectionName;
+        else if (uiChar == ']' && ref_state.m_uiSection == SectionName)
+          ref_state.m_uiSection = CloseBracket;
+        else if (uiClass != Newline)
+          ref_state.m_uiSection = NoSection;
+        break;
+
+      case CloseBracket:
+        if (uiClass != Blank && uiClass != Newline)
+          ref_state.m_uiSection = NoSection;
+        break;
+    }
+  }
+
+  return uiTransition & ~s_uiStateMask;
+}
+
+XII_ALWAYS_INLINE void xiiLineCountLexer::Step(const xiiLineCountLanguageTable& table, State& ref_state, xiiUInt32 uiClass, xiiUInt8 uiChar)
+{
+  ref_state.m_uiLineFlags |= Transition(table, ref_state, uiClass, uiChar);
+
+  if (table.m_bSections)
+  {
+    if (uiClass == Newline)
+      EndLine(table, ref_state);
+
+    return;
+  }
+
+  // Without sections, a newline only ends the line. This happens without branches, since newlines are frequent.
+  const bool bNewline = uiClass == Newline;
+
+  ref_state.m_uiLineCounts[ref_state.m_uiLineFlags >> 4] += bNewline ? 1 : 0;
+  ref_state.m_uiLineFlags = bNewline ? 0 : ref_state.m_uiLineFlags;
+}
+
+void xiiLineCountLexer::EndLine(const xiiLineCountLanguageTable& table, State& ref_state)
+{
+  // A section header is code, no matter what the lexer made of it, and nothing carries over into the new section
+  if (ref_state.m_uiSection == CloseBracket)
+  {
+    ref_state.m_uiLineFlags = IsCode;
+    ref_state.m_uiState     = Code;
+  }
+
+  // Lines without any flags only consist of blanks, xiiLineCountScanner counts those already
+  ++ref_state.m_uiLineCounts[ref_state.m_uiLineFlags >> 4];
+
+  ref_state.m_uiLineFlags = 0;
+  ref_state.m_uiSection   = table.m_bSections ? LineStart : NoSection;
+}
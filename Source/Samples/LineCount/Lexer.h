@@ -0,0 +1,91 @@
+#pragma once
+
+#include <LineCount/FileStats.h>
+
+// The languages that xiiLineCountLexer can tell comments from code in
+enum class xiiLineCountLanguage : xiiUInt8
+{
+  Text,      // Everything is code
+  C,         // C, C++, HLSL and GLSL: '//' and '/* */' comments, "string" and 'c'haracter literals
+  XiiShader, // Like C, but a line like '[VERTEXSHADER]' starts a new section and is always code
+  None,      // Lines are not classified at all, the code, comment and mixed line counts stay zero
+};
+
+struct xiiLineCountLanguageTable;
+
+// Classifies every non-empty line as code, comment or mixed (both code and comments), like cloc.
+//
+// The lexer is a state machine, which is driven by a transition table per language: for every state and character
+// class the table holds the next state and whether the character is code or comment. From the table it also knows
+// which classes can make a difference in each state (e.g. only '*' in a block comment), so within the SIMD blocks of
+// xiiLineCountScanner it jumps from one of those characters to the next and handles everything in between as a whole.
+// For C, blocks go one step further and find the end of each comment or literal with bit operations on the masks.
+//
+// Empty lines (only spaces and tabs) are not counted here, xiiLineCountScanner already counts them.
+class xiiLineCountLexer
+{
+public:
+  // The positions of the characters in a block of 32 ASCII characters that may change the state, one bit per character
+  struct ClassMasks
+  {
+    xiiUInt32 m_uiSlashes;
+    xiiUInt32 m_uiStars;
+    xiiUInt32 m_uiDoubleQuotes;
+    xiiUInt32 m_uiSingleQuotes;
+    xiiUInt32 m_uiBackslashes;
+    xiiUInt32 m_uiBrackets; // '[', which may start a section header
+  };
+
+  xiiLineCountLexer();
+
+  // Sets the language of the next text. Also resets the state.
+  void SetLanguage(xiiLineCountLanguage language);
+
+  // Resets all counters and the state, so that the next file can be scanned.
+  void Reset();
+
+  // Processes one ASCII character. Carriage returns must not be passed in.
+  void ProcessByte(xiiUInt8 uiChar);
+
+  // Processes one non-ASCII character.
+  void ProcessOther();
+
+  // Processes a block of 32 ASCII characters, given the masks of its newlines, its content (everything but spaces, tabs,
+  // carriage returns and newlines), the characters to skip (carriage returns) and the special characters.
+  void ProcessAsciiBlock(const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, const ClassMasks& classes) { m_ProcessBlockFunc(m_State, pBlock, uiNewlines, uiContent, uiSkip, classes); }
+
+  // Finishes the last line and adds the counters to the given stats.
+  void Finish(FileStats& inout_stats);
+
+private:
+  // Everything that changes while scanning. Blocks work on a local copy, which the compiler can keep in registers.
+  struct State
+  {
+    xiiUInt32 m_uiState;
+    xiiUInt32 m_uiSection;       // How much of a section header ('[NAME]') the current line matches so far
+    xiiUInt32 m_uiLineFlags;     // Whether the current line has code and / or comments
+    xiiUInt64 m_uiLineCounts[4]; // The finished lines by their flags: neither (only blanks), code, comment and mixed
+  };
+
+  using ProcessBlockFunc = void (*)(State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, const ClassMasks& classes);
+
+  // Instantiated for every language, so that the compiler can fold the table into the code
+  template <const xiiLineCountLanguageTable& Table>
+  static void ProcessAsciiBlock(State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, const ClassMasks& classes);
+
+  template <const xiiLineCountLanguageTable& Table>
+  static void ProcessEvents(State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, xiiUInt32 uiBrackets, const xiiUInt32 (&classMasks)[8]);
+
+  static void ProcessRegions(State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiNewlines, xiiUInt32 uiContent, xiiUInt32 uiSkip, const ClassMasks& classes, xiiUInt32 uiCommentSlashes);
+
+  static bool      StepAt(const xiiLineCountLanguageTable& table, State& ref_state, const xiiUInt8* pBlock, xiiUInt32 uiPos, xiiUInt32& ref_uiCode, xiiUInt32& ref_uiComment);
+  static void      MarkRun(const xiiLineCountLanguageTable& table, State& ref_state, xiiUInt32 uiRunContent, xiiUInt32& ref_uiCode, xiiUInt32& ref_uiComment);
+  static void      CountLines(State& ref_state, xiiUInt32 uiNewlines, xiiUInt32 uiCode, xiiUInt32 uiComment);
+  static xiiUInt32 Transition(const xiiLineCountLanguageTable& table, State& ref_state, xiiUInt32 uiClass, xiiUInt8 uiChar);
+  static void      Step(const xiiLineCountLanguageTable& table, State& ref_state, xiiUInt32 uiClass, xiiUInt8 uiChar);
+  static void      EndLine(const xiiLineCountLanguageTable& table, State& ref_state);
+
+  const xiiLineCountLanguageTable* m_pTable            = nullptr;
+  ProcessBlockFunc                 m_ProcessBlockFunc = nullptr;
+  State                            m_State;
+};
@@ -1,16 +1,48 @@
+#include <LineCount/Archive.h>
+#include <LineCount/AsyncLogWriter.h>
+#include <LineCount/AsyncReader.h>
+#include <LineCount/Benchmark.h>
+#include <LineCount/DedupTable.h>
+#include <LineCount/DirectoryTree.h>
+#include <LineCount/FileTypes.h>
+#include <LineCount/GitRepository.h>
+#include <LineCount/IgnoreRules.h>
+#include <LineCount/JobQueue.h>
+#include <LineCount/Report.h>
+#include <LineCount/Scanner.h>
+#include <LineCount/ScratchArena.h>
+#include <LineCount/StatsCache.h>
+#include <LineCount/StreamScanner.h>
+
+#include <Foundation/Algorithm/HashStream.h>
+#include <Foundation/Algorithm/HashingUtils.h>
 #include <Foundation/Application/Application.h>
 #include <Foundation/Configuration/Startup.h>
+#include <Foundation/Containers/Deque.h>
 #include <Foundation/Containers/Map.h>
+#include <Foundation/Containers/Set.h>
+#include <Foundation/IO/DirectoryWatcher.h>
 #include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
 #include <Foundation/IO/FileSystem/FileReader.h>
 #include <Foundation/IO/FileSystem/FileSystem.h>
+#include <Foundation/IO/MemoryMappedFile.h>
+#include <Foundation/IO/OSFile.h>
 #include <Foundation/Logging/ConsoleWriter.h>
 #include <Foundation/Logging/HTMLWriter.h>
 #include <Foundation/Logging/Log.h>
 #include <Foundation/Logging/VisualStudioWriter.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Profiling/ProfilingUtils.h>
 #include <Foundation/Strings/PathUtils.h>
 #include <Foundation/Strings/String.h>
 #include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Lock.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Threading/ThreadSignal.h>
+#include <Foundation/Time/Time.h>
+#include <Foundation/Utilities/ConversionUtils.h>
 
 // In general it is not possible to have global or static variables that (indirectly) require an allocator.
 // If you create a variable that somehow needs to have an allocator, an assert will fail.
@@ -21,287 +53,2025 @@
 // at shutdown.
 xiiLogWriter::HTML g_HtmlLog;
 
-struct FileStats
+// Gives read-only access to the complete content of a file.
+// Whenever possible the file is memory-mapped, so its content never has to be copied. Otherwise the file size is
+// queried up front and the whole file is read with a single read call into a buffer that is reused for the next file.
+class FileContent
 {
-  FileStats()
+public:
+  xiiResult Open(const char* szFile)
+  {
+    Close();
+
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE)
+    if (m_MappedFile.Open(szFile, xiiMemoryMappedFile::Mode::ReadOnly).Succeeded())
+    {
+      m_Data = xiiArrayPtr<const xiiUInt8>(static_cast<const xiiUInt8*>(m_MappedFile.GetReadPointer()), (xiiUInt32)m_MappedFile.GetFileSize());
+      return XII_SUCCESS;
+    }
+#endif
+
+    return ReadCompleteFile(szFile);
+  }
+
+  // Uses content that was already read by someone else (e.g. read ahead), which must stay valid until Close().
+  void Use(xiiArrayPtr<const xiiUInt8> data)
+  {
+    Close();
+
+    m_Data = data;
+  }
+
+  void Close()
+  {
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE)
+    m_MappedFile.Close();
+#endif
+
+    m_Data.Clear();
+    m_Arena.Reset();
+  }
+
+  xiiArrayPtr<const xiiUInt8> GetData() const { return m_Data; }
+
+  // Returns a buffer for reading a file piece by piece. Like the content of complete files, it is valid until the next file.
+  xiiArrayPtr<xiiUInt8> GetChunkBuffer(xiiUInt32 uiSize)
   {
-    m_uiFileCount  = 0;
-    m_uiLines      = 0;
-    m_uiEmptyLines = 0;
-    m_uiBytes      = 0;
-    m_uiCharacters = 0;
-    m_uiWords      = 0;
+    Close();
+
+    return m_Arena.AllocateArray<xiiUInt8>(uiSize);
   }
 
-  void operator+=(const FileStats& rhs)
+  const xiiLineCountScratchArena::Stats& GetScratchStats() const { return m_Arena.GetStats(); }
+
+private:
+  xiiResult ReadCompleteFile(const char* szFile)
   {
-    m_uiFileCount += rhs.m_uiFileCount;
-    m_uiLines += rhs.m_uiLines;
-    m_uiEmptyLines += rhs.m_uiEmptyLines;
-    m_uiBytes += rhs.m_uiBytes;
-    m_uiCharacters += rhs.m_uiCharacters;
-    m_uiWords += rhs.m_uiWords;
+    xiiFileReader File;
+    if (File.Open(szFile) == XII_FAILURE)
+      return XII_FAILURE;
+
+    const xiiArrayPtr<xiiUInt8> buffer = m_Arena.AllocateArray<xiiUInt8>((xiiUInt32)File.GetFileSize());
+
+    const xiiUInt64 uiRead = File.ReadBytes(buffer.GetPtr(), buffer.GetCount());
+    m_Data                 = buffer.GetSubArray(0, (xiiUInt32)uiRead);
+
+    return XII_SUCCESS; // file is automatically closed here
   }
 
-  xiiUInt32 m_uiFileCount;
-  xiiUInt32 m_uiLines;
-  xiiUInt32 m_uiEmptyLines;
-  xiiUInt32 m_uiBytes;
-  xiiUInt32 m_uiCharacters;
-  xiiUInt32 m_uiWords;
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE)
+  xiiMemoryMappedFile m_MappedFile;
+#endif
+
+  xiiLineCountScratchArena    m_Arena; // Everything that is only needed while scanning the current file
+  xiiArrayPtr<const xiiUInt8> m_Data;
+};
+
+// A single file that was found during enumeration and still needs to be scanned
+// Every job is only ever processed by a single worker, which also writes the results back into it.
+struct FileJob
+{
+  xiiString            m_sPath;
+  xiiUInt32            m_uiFileType        = 0; // Index into xiiLineCountFileTypes
+  xiiLineCountLanguage m_Language          = xiiLineCountLanguage::Text;
+  xiiUInt64            m_uiFileSize        = 0;
+  xiiInt64             m_iModificationTime = 0; // In microseconds
+
+  // The content, if it was read ahead before the job reached a worker
+  xiiLineCountReadRequest m_ReadAhead;
+
+  // Archives are not counted themselves, the files in them are counted by their own extensions
+  bool                              m_bArchive      = false;
+  xiiLineCountArchiveReader::Format m_ArchiveFormat = xiiLineCountArchiveReader::Format::Zip;
+
+  // Results. For archives, m_Stats is the sum over the files in it, including m_uiFileCount.
+  FileStats m_Stats;
+  xiiUInt64 m_uiContentHash  = 0;
+  bool      m_bValid         = false; // Whether m_Stats could be determined (i.e. the file could be read)
+  bool      m_bCached        = false; // Whether m_Stats was taken from the cache
+  xiiUInt32 m_uiArchiveFiles = 0;     // How many files in the archive were counted
+  xiiTime   m_ScanTime;               // How long the worker took for the file, reading ahead is not included
+};
+
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE) && XII_ENABLED(XII_SUPPORTS_FILE_ITERATORS)
+// A blob of a git repository as it was counted. The same content is counted differently in another language.
+struct GitBlobKey
+{
+  xiiLineCountGitRepository::ObjectId m_Id;
+  xiiLineCountLanguage                m_Language = xiiLineCountLanguage::Text;
+};
+
+struct GitBlobKeyHash
+{
+  static xiiUInt32 Hash(const GitBlobKey& key) { return xiiLineCountGitRepository::ObjectIdHash::Hash(key.m_Id) ^ static_cast<xiiUInt32>(key.m_Language); }
+  static bool      Equal(const GitBlobKey& a, const GitBlobKey& b) { return a.m_Id == b.m_Id && a.m_Language == b.m_Language; }
 };
+#endif
+
+// Settings that are shared by all workers while scanning
+struct ScanSettings
+{
+  const xiiLineCountStatsCache* m_pCache       = nullptr; // Stats of the previous run, if available
+  xiiLineCountDedupTable*       m_pDedup       = nullptr; // If available, files with the same content as an earlier one are not counted again
+  bool                          m_bHashContent = false;   // Whether to hash the content of all files that have to be read
+  xiiUInt32                     m_uiChunkSize  = 0;       // If not zero, all files are read piece by piece in chunks of this size
+  xiiUInt32                     m_uiReadAhead  = 0;       // If not zero, this many files are read at the same time, before they reach the workers
+  bool                          m_bReadThreads = false;   // Whether files are read ahead with threads, even if io_uring is available
+  const xiiLineCountFileTypes*  m_pFileTypes   = nullptr; // Which files in archives are counted
+  bool                          m_bClassify    = false;   // Whether the lines of files in archives are classified as code, comment or mixed
+};
+
+// Only files up to this size are read ahead. Small files are where the disk needs many requests in flight, larger ones
+// are memory-mapped and read ahead by the OS anyway. This also limits the memory that the read-ahead buffers take up.
+constexpr xiiUInt64 s_uiMaxReadAheadSize = 1024 * 1024;
+
+// Returns the stats of the previous run, unless the file has a different size now.
+const xiiLineCountStatsCache::Entry* FindCachedStats(const FileJob& job, const ScanSettings& settings)
+{
+  const xiiLineCountStatsCache::Entry* pCached = settings.m_pCache ? settings.m_pCache->Find(job.m_sPath) : nullptr;
+
+  if (pCached != nullptr && pCached->m_uiFileSize != job.m_uiFileSize)
+    return nullptr;
 
-xiiResult ReadCompleteFile(const char* szFile, xiiDynamicArray<xiiUInt8>& out_fileContent)
+  return pCached;
+}
+
+// Files that are too large to be addressed as a whole are always read piece by piece, in chunks of this size
+constexpr xiiUInt32 s_uiDefaultChunkSize = 1024 * 1024;
+
+// Reads the file in chunks and computes its stats (and the hash of its content, if needed) on the fly.
+// The memory usage only depends on the chunk size, no matter how large the file is.
+xiiResult StreamFile(FileJob& ref_job, const ScanSettings& settings, FileContent& ref_content, ScanTimings& ref_timings)
 {
-  out_fileContent.Clear();
+  XII_PROFILE_SCOPE("StreamFile");
+
+  xiiTime readStartTime = xiiTime::Now();
 
   xiiFileReader File;
-  if (File.Open(szFile) == XII_FAILURE)
+  if (File.Open(ref_job.m_sPath) == XII_FAILURE)
     return XII_FAILURE;
 
-  xiiUInt8 uiTemp[1024];
+  xiiArrayPtr<xiiUInt8>     buffer = ref_content.GetChunkBuffer(settings.m_uiChunkSize > 0 ? settings.m_uiChunkSize : s_uiDefaultChunkSize);
+  xiiLineCountStreamScanner scanner;
+  xiiHashStreamWriter64     hash;
+
+  scanner.SetLanguage(ref_job.m_Language);
+
   while (true)
   {
-    const xiiUInt64 uiRead = File.ReadBytes(uiTemp, 1023);
+    const xiiUInt32 uiRead = (xiiUInt32)File.ReadBytes(buffer.GetPtr(), buffer.GetCount());
+    ref_timings.m_Read += xiiTime::Now() - readStartTime;
 
     if (uiRead == 0)
-      return XII_SUCCESS; // file is automatically closed here
+      break;
+
+    const xiiArrayPtr<const xiiUInt8> chunk = buffer.GetSubArray(0, uiRead);
+
+    if (settings.m_bHashContent)
+    {
+      hash.WriteBytes(chunk.GetPtr(), chunk.GetCount()).IgnoreResult();
+    }
+
+    // After the end of the text, the rest of the file is only needed for the hash
+    if (!scanner.Process(chunk, &ref_timings) && !settings.m_bHashContent)
+      break;
+
+    readStartTime = xiiTime::Now();
+  }
+
+  if (!scanner.Finish(ref_job.m_Stats))
+  {
+    xiiLog::Warning("File is not valid Utf-8: '{0}'", ref_job.m_sPath);
+  }
 
-    out_fileContent.PushBackRange(xiiArrayPtr<xiiUInt8>(uiTemp, (xiiUInt32)uiRead));
+  if (settings.m_bHashContent)
+  {
+    ref_job.m_uiContentHash = hash.GetHashValue();
   }
 
-  return XII_SUCCESS; // file is automatically closed here
+  return XII_SUCCESS;
 }
 
-// Removes all spaces and tabs from the front and end of a line
-void TrimWhitespaces(xiiStringBuilder& ref_sLine)
+// Counts the files in an archive by their own extensions, as if they were in a directory with the name of the archive.
+// Each file is decompressed piece by piece into the chunk buffer, so nothing is written to disk and the memory usage
+// does not depend on the size of the files. The archive as a whole is not cached, and its files are not deduplicated.
+void ScanArchive(FileJob& ref_job, const ScanSettings& settings, FileContent& ref_content, xiiArrayPtr<FileStats> typeStats, ScanTimings& ref_timings)
 {
-  bool b = true;
+  XII_PROFILE_SCOPE("ScanArchive");
+
+  xiiTime readStartTime = xiiTime::Now();
 
-  while (b)
+  // Much larger than the other state of a worker, so it is not kept on the stack
+  xiiUniquePtr<xiiLineCountArchiveReader> pArchive = XII_DEFAULT_NEW(xiiLineCountArchiveReader);
+
+  if (pArchive->Open(ref_job.m_sPath, ref_job.m_ArchiveFormat).Failed())
   {
-    b = false;
+    xiiLog::Warning("Could not open the archive '{0}'", ref_job.m_sPath);
+    return;
+  }
 
-    if (ref_sLine.EndsWith(" "))
-    {
-      b = true;
-      ref_sLine.Shrink(0, 1);
-    }
-    if (ref_sLine.EndsWith("\t"))
-    {
-      b = true;
-      ref_sLine.Shrink(0, 1);
-    }
-    if (ref_sLine.StartsWith(" "))
+  xiiArrayPtr<xiiUInt8>     buffer = ref_content.GetChunkBuffer(settings.m_uiChunkSize > 0 ? settings.m_uiChunkSize : s_uiDefaultChunkSize);
+  xiiLineCountStreamScanner scanner;
+  xiiStringBuilder          sPath;
+
+  while (pArchive->NextFile())
+  {
+    const xiiUInt32 uiFileType = settings.m_pFileTypes->Find(xiiPathUtils::GetFileExtension(pArchive->GetPath()));
+
+    if (uiFileType == xiiLineCountFileTypes::InvalidIndex)
+      continue;
+
+    scanner.Reset();
+    scanner.SetLanguage(settings.m_bClassify ? settings.m_pFileTypes->GetLanguage(uiFileType) : xiiLineCountLanguage::None);
+
+    while (true)
     {
-      b = true;
-      ref_sLine.Shrink(1, 0);
+      const xiiUInt32 uiRead = (xiiUInt32)pArchive->ReadBytes(buffer.GetPtr(), buffer.GetCount());
+      ref_timings.m_Read += xiiTime::Now() - readStartTime;
+
+      // Whatever follows the end of the text is skipped by the next NextFile()
+      if (uiRead == 0 || !scanner.Process(buffer.GetSubArray(0, uiRead), &ref_timings))
+        break;
+
+      readStartTime = xiiTime::Now();
     }
-    if (ref_sLine.StartsWith("\t"))
+
+    // A file that the damage cut short is dropped, its stats would only cover a part of it
+    if (pArchive->HasFailed())
+      break;
+
+    FileStats stats;
+    stats.m_uiFileCount = 1;
+
+    if (!scanner.Finish(stats))
     {
-      b = true;
-      ref_sLine.Shrink(1, 0);
+      sPath.Set(ref_job.m_sPath, "/", pArchive->GetPath());
+      xiiLog::Warning("File is not valid Utf-8: '{0}'", sPath);
     }
+
+    typeStats[uiFileType] += stats;
+    ref_job.m_Stats += stats;
+    ++ref_job.m_uiArchiveFiles;
+
+    readStartTime = xiiTime::Now();
   }
+
+  if (pArchive->HasFailed())
+    xiiLog::Warning("The archive '{0}' is damaged, only the {1} files before the damage were counted", ref_job.m_sPath, ref_job.m_uiArchiveFiles);
+
+  if (pArchive->GetSkippedFiles() > 0)
+    xiiLog::Warning("{0} files in the archive '{1}' are encrypted or compressed with an unsupported method and were skipped", pArchive->GetSkippedFiles(), ref_job.m_sPath);
 }
 
-FileStats GetFileStats(const char* szFile)
+// Scans the given file and adds its stats to the entry for its extension.
+// Files that did not change since the previous run are not read at all, their stats are taken from the cache.
+// Copies of files that were already counted are only read and hashed. Files that are read in chunks are counted while
+// they are read, before their hash is known, so they are never skipped as duplicates.
+void ScanFile(FileJob& ref_job, const ScanSettings& settings, FileContent& ref_content, xiiArrayPtr<FileStats> typeStats, ScanTimings& ref_timings)
 {
-  FileStats s;
+  XII_PROFILE_SCOPE("ScanFile");
+
+  if (ref_job.m_bArchive)
+  {
+    ScanArchive(ref_job, settings, ref_content, typeStats, ref_timings);
+    return;
+  }
 
-  xiiDynamicArray<xiiUInt8> FileContent;
-  if (ReadCompleteFile(szFile, FileContent) == XII_FAILURE)
-    return s;
+  FileStats& TypeStats = typeStats[ref_job.m_uiFileType];
+  ++TypeStats.m_uiFileCount;
 
-  FileContent.PushBack('\0');
+  const xiiLineCountStatsCache::Entry* pCached = FindCachedStats(ref_job, settings);
 
-  if (!xiiUnicodeUtils::IsValidUtf8((const char*)&FileContent[0]))
+  if (pCached != nullptr && pCached->m_iModificationTime == ref_job.m_iModificationTime)
   {
-    xiiLog::Warning("File is not valid Utf-8: '{0}'", szFile);
-    return s;
-  }
+    ref_job.m_Stats         = pCached->m_Stats;
+    ref_job.m_uiContentHash = pCached->m_uiContentHash;
+    ref_job.m_bValid        = true;
+    ref_job.m_bCached       = true;
 
-  // We should not append that directly at the xiiStringBuilder, as the file read operations may end
-  // in between a Utf8 sequence and then xiiStringBuilder will complain about invalid Utf8 strings.
-  xiiStringBuilder sContent = (const char*)&FileContent[0];
+    TypeStats += ref_job.m_Stats;
+    return;
+  }
 
-  // Count the number of lines
+  if (settings.m_uiChunkSize > 0 || ref_job.m_uiFileSize > xiiMath::MaxValue<xiiUInt32>())
   {
-    xiiDynamicArray<xiiString> Lines;
-    sContent.ReplaceAll("\r", ""); // Remove carriage return
+    if (StreamFile(ref_job, settings, ref_content, ref_timings).Failed())
+      return;
+
+    ref_job.m_bValid  = true;
+    ref_job.m_bCached = pCached != nullptr && pCached->m_uiContentHash != 0 && pCached->m_uiContentHash == ref_job.m_uiContentHash;
 
-    // Splits the string at occurrence of '\n' and adds each line to the 'Lines' container
-    sContent.Split(true, Lines, "\n");
+    TypeStats += ref_job.m_Stats;
+    return;
+  }
 
-    xiiStringBuilder sLine;
+  const xiiTime readStartTime = xiiTime::Now();
 
-    for (xiiUInt32 l = 0; l < Lines.GetCount(); ++l)
-    {
-      sLine = Lines[l].GetData();
+  if (ref_job.m_ReadAhead.m_bSucceeded)
+  {
+    ref_content.Use(ref_job.m_ReadAhead.m_Data.GetArrayPtr());
+  }
+  else
+  {
+    XII_PROFILE_SCOPE("Read");
 
-      TrimWhitespaces(sLine);
+    if (ref_content.Open(ref_job.m_sPath).Failed())
+      return;
+  }
 
-      if (sLine.IsEmpty())
-        ++s.m_uiEmptyLines;
-      else
-      {
-        ++s.m_uiLines;
+  ref_timings.m_Read += xiiTime::Now() - readStartTime;
+  ref_job.m_bValid = true;
 
-        xiiStringView LineIt = sLine;
+  // The file was touched, but maybe its content is still the same (e.g. after switching branches)
+  if (settings.m_bHashContent || settings.m_pDedup != nullptr)
+  {
+    {
+      XII_PROFILE_SCOPE("Hash");
 
-        bool bIsInWord = false;
-        while (!LineIt.IsEmpty())
-        {
-          const bool bNewWord = xiiStringUtils::IsIdentifierDelimiter_C_Code(LineIt.GetCharacter());
+      const xiiTime hashStartTime = xiiTime::Now();
+      ref_job.m_uiContentHash     = xiiHashingUtils::xxHash64(ref_content.GetData().GetPtr(), ref_content.GetData().GetCount());
+      ref_timings.m_Hash += xiiTime::Now() - hashStartTime;
+    }
 
-          if (bIsInWord != bNewWord)
-          {
-            // Count every whole word as one word and everything in between as another word
-            ++s.m_uiWords;
-            bIsInWord = bNewWord;
-          }
+    if (pCached != nullptr && pCached->m_uiContentHash != 0 && pCached->m_uiContentHash == ref_job.m_uiContentHash)
+    {
+      ref_job.m_Stats   = pCached->m_Stats;
+      ref_job.m_bCached = true;
 
-          ++LineIt;
-        }
-      }
+      TypeStats += ref_job.m_Stats;
+      ref_content.Close();
+      return;
+    }
+
+    // Or it is a copy of another file
+    if (settings.m_pDedup != nullptr && settings.m_pDedup->Find(ref_content.GetData().GetCount(), ref_job.m_uiContentHash, ref_job.m_Language, ref_job.m_Stats))
+    {
+      TypeStats += ref_job.m_Stats;
+      ref_content.Close();
+      return;
     }
   }
 
-  s.m_uiBytes += sContent.GetElementCount();
-  s.m_uiCharacters += sContent.GetCharacterCount();
+  // Get additional stats and add them to the overall stats
+  const xiiTime countStartTime = xiiTime::Now();
+  ref_job.m_Stats              = GetFileStats(ref_content.GetData(), ref_job.m_sPath, ref_job.m_Language, &ref_timings);
+  TypeStats += ref_job.m_Stats;
 
-  return s;
-}
+  if (settings.m_pDedup != nullptr)
+  {
+    settings.m_pDedup->Store(ref_content.GetData().GetCount(), ref_job.m_uiContentHash, ref_job.m_Language, ref_job.m_Stats, xiiTime::Now() - countStartTime);
+  }
 
+  ref_content.Close();
+}
 
-class xiiLineCountApp : public xiiApplication
+// Scans files while they are still being enumerated.
+//
+// The enumerating thread pushes every file into a bounded lock-free queue, from which the workers of
+// xiiLineCountTask pull them. This way slow directory reads (e.g. on network drives) overlap with reading and
+// counting file content. Every worker writes only into its own shard, so no locking is needed while scanning.
+// Since all counters are simply summed up, the result is identical to the serial path.
+//
+// To keep memory usage flat, the enumerator stalls while the files in the queue and in the workers add up to more
+// than the configured number of bytes. A single file is always accepted, no matter how large it is.
+//
+// Optionally, small files are read ahead with xiiLineCountAsyncReader before they are handed to the workers. Then the
+// disk always has many reads in flight, instead of one per worker, and the workers only count. The enumerator submits
+// the reads and forwards the completed files, so the order in which files reach the workers can change.
+class xiiLineCountPipeline
 {
+public:
+  // With a single thread there are no workers, every file is scanned right away when it is pushed.
+  xiiLineCountPipeline(const ScanSettings& settings, xiiUInt32 uiFileTypes, xiiUInt32 uiThreads, xiiUInt64 uiMaxBytesInFlight);
+
+  // Hands the file over to the workers, possibly after reading it ahead. The job must stay at the same address until Finish() was called.
+  void Push(FileJob& ref_job);
+
+  // Waits until all files are scanned and merges the stats of all workers. out_typeStats is indexed by file type.
+  void Finish(xiiArrayPtr<FileStats> out_typeStats, ScanTimings& out_timings);
+
+  bool      IsParallel() const { return m_pTask != nullptr; }
+  xiiUInt32 GetMaxQueueDepth() const { return m_uiMaxQueueDepth; }
+  double    GetAverageQueueDepth() const { return m_uiPushed > 0 ? (double)m_uiQueueDepthSum / m_uiPushed : 0.0; }
+  xiiTime   GetEnumeratorStallTime() const { return m_EnumeratorStallTime; }
+  xiiTime   GetWorkerStallTime() const { return xiiTime::Nanoseconds((double)m_iWorkerStallNanoseconds); }
+
+  const xiiLineCountAsyncReader* GetReader() const { return m_pReader.Borrow(); }
+  xiiUInt32                      GetReadAheadFiles() const { return m_uiReadAheadFiles; }
+  xiiTime                        GetReadAheadWaitTime() const { return m_ReadAheadWaitTime; }
+  xiiUInt32                      GetReadBufferAllocations() const { return m_uiReadBufferAllocations; }
+
+  // Summed over all workers, only complete after Finish()
+  xiiLineCountScratchArena::Stats GetScratchStats() const;
+
+  void RunWorker(xiiUInt32 uiWorker);
+
 private:
-  xiiString m_sSearchDir;
+  static constexpr xiiUInt32 s_uiQueueCapacity = 1024;
+
+  bool CanReadAhead(const FileJob& job) const;
+  void PushToWorkers(FileJob& ref_job);
+  bool TryPushToWorkers(FileJob& ref_job);
+  void ScanJob(FileJob& ref_job, FileContent& ref_content, xiiArrayPtr<FileStats> typeStats, ScanTimings& ref_timings);
+  void ForwardCompletedReads(bool bWait);
+  void TakeReadBuffer(xiiDynamicArray<xiiUInt8>& out_buffer, xiiUInt64 uiSize);
+  void ReturnReadBuffer(xiiDynamicArray<xiiUInt8>& ref_buffer);
+
+  ScanSettings                                      m_Settings;
+  xiiInt64                                          m_iMaxBytesInFlight;
+  xiiDynamicArray<xiiDynamicArray<FileStats>>       m_Shards; // Stats per file type, one array per worker
+  xiiDynamicArray<ScanTimings>                      m_Timings;
+  xiiDynamicArray<xiiLineCountScratchArena::Stats>  m_ScratchStats;
+  xiiSharedPtr<xiiTask>                             m_pTask;
+  xiiTaskGroupID                                    m_TaskGroup;
+  xiiLineCountJobQueue<FileJob*, s_uiQueueCapacity> m_Queue;
+  xiiAtomicInteger64                                m_iBytesInFlight;
+  xiiAtomicBool                                     m_bEnumerationDone;
+  FileContent                                       m_SerialContent;
 
+  // Waiting instead of spinning: workers wait for jobs while the queue is empty, the enumerator waits for room while it
+  // is full. Either side is only woken up while the other one announced that it waits.
+  xiiThreadSignal    m_JobsSignal;
+  xiiThreadSignal    m_RoomSignal;
+  xiiAtomicInteger32 m_iWaitingWorkers;
+  xiiAtomicBool      m_bEnumeratorWaiting;
+
+  // Statistics
+  xiiUInt32          m_uiPushed        = 0;
+  xiiUInt32          m_uiMaxQueueDepth = 0;
+  xiiUInt64          m_uiQueueDepthSum = 0;
+  xiiTime            m_EnumeratorStallTime;
+  xiiAtomicInteger64 m_iWorkerStallNanoseconds;
+
+  // Read-ahead, only used by the enumerating thread
+  xiiUniquePtr<xiiLineCountAsyncReader>     m_pReader;
+  xiiDynamicArray<xiiLineCountReadRequest*> m_CompletedReads;
+  xiiUInt32                                 m_uiReadAheadFiles        = 0;
+  xiiUInt32                                 m_uiReadBufferAllocations = 0;
+  xiiTime                                   m_ReadAheadWaitTime;
+
+  // Read-ahead buffers that the workers gave back, so that reading ahead stops allocating once there are enough of them
+  xiiMutex                                   m_ReadBufferMutex;
+  xiiDynamicArray<xiiDynamicArray<xiiUInt8>> m_FreeReadBuffers;          // Protected by m_ReadBufferMutex
+  xiiUInt64                                  m_uiFreeReadBufferBytes = 0; // Protected by m_ReadBufferMutex
+};
+
+// Every invocation of this task represents one worker of the pipeline.
+class xiiLineCountTask final : public xiiTask
+{
 public:
-  using SUPER = xiiApplication;
+  xiiLineCountTask(xiiLineCountPipeline* pPipeline, xiiUInt32 uiWorkers) :
+    m_pPipeline(pPipeline)
+  {
+    ConfigureTask("LineCount", xiiTaskNesting::Never);
+    SetMultiplicity(uiWorkers);
+  }
 
-  xiiLineCountApp() :
-    xiiApplication("LineCountApp")
+private:
+  virtual void ExecuteWithMultiplicity(xiiUInt32 uiInvocation) const override { m_pPipeline->RunWorker(uiInvocation); }
+
+  xiiLineCountPipeline* m_pPipeline;
+};
+
+xiiLineCountPipeline::xiiLineCountPipeline(const ScanSettings& settings, xiiUInt32 uiFileTypes, xiiUInt32 uiThreads, xiiUInt64 uiMaxBytesInFlight) :
+  m_Settings(settings),
+  m_iMaxBytesInFlight((xiiInt64)uiMaxBytesInFlight)
+{
+  m_Shards.SetCount(xiiMath::Max(uiThreads, 1u));
+  for (xiiDynamicArray<FileStats>& shard : m_Shards)
   {
-    m_sSearchDir = "";
+    shard.SetCount(uiFileTypes);
   }
 
-  virtual void AfterCoreSystemsStartup() override
+  m_Timings.SetCount(m_Shards.GetCount());
+  m_ScratchStats.SetCount(m_Shards.GetCount());
+
+  if (uiThreads > 1)
   {
-    auto pCmd = xiiCommandLineUtils::GetGlobalInstance();
+    m_pTask     = XII_DEFAULT_NEW(xiiLineCountTask, this, uiThreads);
+    m_TaskGroup = xiiTaskSystem::StartSingleTask(m_pTask, xiiTaskPriority::LongRunningHighPriority);
+  }
 
-    // Pass the absolute path to the directory that should be scanned as the first parameter to this application
-    if (pCmd->GetParameterCount() > 1)
-      m_sSearchDir = pCmd->GetParameter(1);
+  if (settings.m_uiReadAhead > 0)
+  {
+    m_pReader = XII_DEFAULT_NEW(xiiLineCountAsyncReader);
+    m_pReader->Start(settings.m_uiReadAhead, !settings.m_bReadThreads);
+  }
+}
 
-    if (m_sSearchDir.IsEmpty())
-    {
-      xiiStringBuilder sXIISource = xiiFileSystem::GetSdkRootDirectory();
-      sXIISource.AppendPath("Source");
-      sXIISource.MakeCleanPath();
+bool xiiLineCountPipeline::CanReadAhead(const FileJob& job) const
+{
+  if (m_Settings.m_uiChunkSize > 0 || job.m_uiFileSize > s_uiMaxReadAheadSize || job.m_bArchive)
+    return false;
 
-      m_sSearchDir = sXIISource;
-    }
+  // Unchanged files are not read at all
+  const xiiLineCountStatsCache::Entry* pCached = FindCachedStats(job, m_Settings);
+  return pCached == nullptr || pCached->m_iModificationTime != job.m_iModificationTime;
+}
 
-    xiiLog::Info("Search-dir: {}", m_sSearchDir);
+void xiiLineCountPipeline::Push(FileJob& ref_job)
+{
+  if (m_pReader == nullptr || !CanReadAhead(ref_job))
+  {
+    PushToWorkers(ref_job);
+    return;
+  }
 
-    // Then add a folder as a data directory (the previously registered Factory will take care of creating the proper handler)
-    // As we only need access to files through global paths, we add the "empty data directory"
-    // This data dir will manage all accesses through absolute paths, unless any other data directory can handle them
-    // since we don't add any further data dirs, this is it
-    xiiFileSystem::AddDataDirectory("", "", ":", xiiFileSystem::AllowWrites).IgnoreResult();
+  xiiLineCountReadRequest& request = ref_job.m_ReadAhead;
+  request.m_szPath                 = ref_job.m_sPath.GetData();
+  request.m_uiSize                 = ref_job.m_uiFileSize;
+  request.m_pUserData              = &ref_job;
+  TakeReadBuffer(request.m_Data, request.m_uiSize);
 
+  // While all reads are in flight, the next one has to wait for a file to complete
+  while (!m_pReader->Submit(&request))
+  {
+    ForwardCompletedReads(true);
+  }
 
-    // Now we can set up the logging system (we could do it earlier, but the HTML writer needs access to the file system)
+  ++m_uiReadAheadFiles;
+  ForwardCompletedReads(false);
+}
 
-    xiiStringBuilder sLogPath = m_sSearchDir;
-    sLogPath.PathParentDirectory(); // Go one folder up
-    sLogPath.AppendPath("CodeStatistics.htm");
+void xiiLineCountPipeline::ForwardCompletedReads(bool bWait)
+{
+  const xiiTime waitStartTime = xiiTime::Now();
+  m_pReader->TakeCompleted(m_CompletedReads, bWait);
 
-    // The console log writer will pass all log messages to the standard console window
-    xiiGlobalLog::AddLogWriter(xiiLogWriter::Console::LogMessageHandler);
-    // The Visual Studio log writer will pass all messages to the output window in VS
-    xiiGlobalLog::AddLogWriter(xiiLogWriter::VisualStudio::LogMessageHandler);
-    // The HTML log writer will write all log messages to an HTML file
-    g_HtmlLog.BeginLog(sLogPath.GetData(), "Code Statistics");
-    xiiGlobalLog::AddLogWriter(xiiLoggingEvent::Handler(&xiiLogWriter::HTML::LogMessageHandler, &g_HtmlLog));
+  if (bWait)
+  {
+    m_ReadAheadWaitTime += xiiTime::Now() - waitStartTime;
   }
 
-  virtual void BeforeCoreSystemsShutdown() override
+  // Files that could not be read are passed on as well, the workers try again and report them like any other
+  for (xiiLineCountReadRequest* pRequest : m_CompletedReads)
   {
-    // Close the HTML log, from now on no more log messages are written to the file
-    g_HtmlLog.EndLog();
+    PushToWorkers(*static_cast<FileJob*>(pRequest->m_pUserData));
   }
 
-  virtual xiiApplication::Execution Run() override
+  m_CompletedReads.Clear();
+}
+
+void xiiLineCountPipeline::TakeReadBuffer(xiiDynamicArray<xiiUInt8>& out_buffer, xiiUInt64 uiSize)
+{
   {
-#if XII_ENABLED(XII_SUPPORTS_FILE_ITERATORS) || defined(XII_DOCS)
+    XII_LOCK(m_ReadBufferMutex);
 
-    xiiUInt32                    uiDirectories = 0;
-    xiiUInt32                    uiFiles       = 0;
-    xiiMap<xiiString, FileStats> FileTypeStatistics;
+    if (!m_FreeReadBuffers.IsEmpty())
+    {
+      out_buffer.Swap(m_FreeReadBuffers.PeekBack());
+      m_FreeReadBuffers.PopBack();
+      m_uiFreeReadBufferBytes -= out_buffer.GetCapacity();
+    }
+  }
 
-    // Get a directory iterator for the search directory
-    xiiFileSystemIterator it;
-    it.StartSearch(m_sSearchDir);
+  // The reader resizes the buffer to the size of the file
+  if (out_buffer.GetCapacity() < uiSize)
+  {
+    ++m_uiReadBufferAllocations;
+  }
+}
+
+void xiiLineCountPipeline::ReturnReadBuffer(xiiDynamicArray<xiiUInt8>& ref_buffer)
+{
+  if (ref_buffer.GetCapacity() == 0)
+    return;
+
+  XII_LOCK(m_ReadBufferMutex);
+
+  // More than the workers can have queued at once is never needed again
+  if (m_uiFreeReadBufferBytes + ref_buffer.GetCapacity() > (xiiUInt64)m_iMaxBytesInFlight)
+  {
+    ref_buffer.Clear();
+    ref_buffer.Compact();
+    return;
+  }
+
+  m_uiFreeReadBufferBytes += ref_buffer.GetCapacity();
+  m_FreeReadBuffers.ExpandAndGetRef().Swap(ref_buffer);
+}
+
+void xiiLineCountPipeline::ScanJob(FileJob& ref_job, FileContent& ref_content, xiiArrayPtr<FileStats> typeStats, ScanTimings& ref_timings)
+{
+  const xiiTime scanStartTime = xiiTime::Now();
+  ScanFile(ref_job, m_Settings, ref_content, typeStats, ref_timings);
+  ref_job.m_ScanTime = xiiTime::Now() - scanStartTime;
+
+  ReturnReadBuffer(ref_job.m_ReadAhead.m_Data);
+}
+
+bool xiiLineCountPipeline::TryPushToWorkers(FileJob& ref_job)
+{
+  const xiiInt64 iFileSize      = (xiiInt64)ref_job.m_uiFileSize;
+  const xiiInt64 iBytesInFlight = m_iBytesInFlight;
+
+  if (iBytesInFlight != 0 && iBytesInFlight + iFileSize > m_iMaxBytesInFlight)
+    return false;
+
+  m_iBytesInFlight.Add(iFileSize);
+
+  if (m_Queue.TryPush(&ref_job))
+    return true;
+
+  m_iBytesInFlight.Subtract(iFileSize);
+  return false;
+}
+
+void xiiLineCountPipeline::PushToWorkers(FileJob& ref_job)
+{
+  if (m_pTask == nullptr)
+  {
+    ScanJob(ref_job, m_SerialContent, m_Shards[0], m_Timings[0]);
+    return;
+  }
+
+  // Wait until the workers have finished enough files, or the queue has room again
+  if (!TryPushToWorkers(ref_job))
+  {
+    XII_PROFILE_SCOPE("EnumeratorStall");
 
-    if (it.IsValid())
+    const xiiTime stallStartTime = xiiTime::Now();
+
+    // Workers only wake up the enumerator once it announced that it waits, so it has to try again after that
+    m_bEnumeratorWaiting.Set(true);
+
+    while (!TryPushToWorkers(ref_job))
     {
-      xiiStringBuilder b, sExt;
+      m_RoomSignal.WaitForSignal();
+    }
 
-      // While there are additional files / folders
-      for (; it.IsValid(); it.Next())
-      {
-        // Build the absolute path to the current file
-        b = it.GetCurrentPath();
-        b.AppendPath(it.GetStats().m_sName.GetData());
+    m_bEnumeratorWaiting.Set(false);
+    m_EnumeratorStallTime += xiiTime::Now() - stallStartTime;
+  }
 
-        // Log some info
-        xiiLog::Info("{0}: {1}", it.GetStats().m_bIsDirectory ? "Directory" : "File", b);
+  if (m_iWaitingWorkers > 0)
+  {
+    m_JobsSignal.RaiseSignal();
+  }
 
-        if (it.GetStats().m_bIsDirectory)
-        {
-          ++uiDirectories;
-        }
-        else
-        {
-          // File extensions are always converted to lower-case actually
-          sExt = b.GetFileExtension();
+  const xiiUInt32 uiDepth = m_Queue.GetCount();
+  m_uiMaxQueueDepth       = xiiMath::Max(m_uiMaxQueueDepth, uiDepth);
+  m_uiQueueDepthSum += uiDepth;
+  ++m_uiPushed;
+}
 
-          if (sExt.IsEqual_NoCase("cpp") || sExt.IsEqual_NoCase("h") || sExt.IsEqual_NoCase("hpp") || sExt.IsEqual_NoCase("inl"))
-          {
-            ++uiFiles;
+void xiiLineCountPipeline::RunWorker(xiiUInt32 uiWorker)
+{
+  xiiArrayPtr<FileStats> shard   = m_Shards[uiWorker];
+  ScanTimings&           timings = m_Timings[uiWorker];
+  FileContent            content;
+  FileJob*               pJob = nullptr;
+  xiiTime                stallTime;
 
-            // Get additional stats and add them to the overall stats
-            FileStats& TypeStats = FileTypeStatistics[sExt.GetData()];
-            ++TypeStats.m_uiFileCount;
+  while (true)
+  {
+    // Must be read before trying to pop, otherwise the last files could be missed
+    const bool bEnumerationDone = m_bEnumerationDone;
 
-            TypeStats += GetFileStats(b.GetData());
-          }
-        }
+    if (m_Queue.TryPop(pJob))
+    {
+      // A push wakes up only one worker, so the others are woken up one after the other while jobs are left
+      if (m_iWaitingWorkers > 0 && m_Queue.GetCount() > 0)
+      {
+        m_JobsSignal.RaiseSignal();
       }
 
-      // Now output some statistics
-      xiiLog::Info("Directories: {0}, Files: {1}, Avg. Files per Dir: {2}", uiDirectories, uiFiles, xiiArgF(uiFiles / (float)uiDirectories, 1));
+      ScanJob(*pJob, content, shard, timings);
+      m_iBytesInFlight.Subtract((xiiInt64)pJob->m_uiFileSize);
 
-      FileStats AllTypes;
-
-      // Iterate over all elements in the amp
-      xiiMap<xiiString, FileStats>::Iterator MapIt = FileTypeStatistics.GetIterator();
-      while (MapIt.IsValid())
+      if (m_bEnumeratorWaiting)
       {
-        xiiLog::Info("File Type: '{0}': {1} Files, {2} Lines, {3} Empty Lines, Bytes: {4}, Non-ASCII Characters: {5}, Words: {6}", MapIt.Key(), MapIt.Value().m_uiFileCount, MapIt.Value().m_uiLines, MapIt.Value().m_uiEmptyLines, MapIt.Value().m_uiBytes,
-                     MapIt.Value().m_uiBytes - MapIt.Value().m_uiCharacters, MapIt.Value().m_uiWords);
+        m_RoomSignal.RaiseSignal();
+      }
 
-        AllTypes += MapIt.Value();
+      continue;
+    }
 
-        ++MapIt;
+    if (bEnumerationDone)
+    {
+      // The end of the enumeration also wakes up only one worker, which passes it on
+      if (m_iWaitingWorkers > 0)
+      {
+        m_JobsSignal.RaiseSignal();
+      }
+
+      break;
+    }
+
+    // The enumerator is not fast enough to keep this worker busy
+    XII_PROFILE_SCOPE("WorkerStall");
+
+    const xiiTime stallStartTime = xiiTime::Now();
+
+    // Pushes only wake up workers that announced that they wait, so the queue has to be checked again after that
+    m_iWaitingWorkers.Increment();
+
+    if (m_Queue.GetCount() == 0 && !m_bEnumerationDone)
+    {
+      m_JobsSignal.WaitForSignal();
+    }
+
+    m_iWaitingWorkers.Decrement();
+    stallTime += xiiTime::Now() - stallStartTime;
+  }
+
+  m_iWorkerStallNanoseconds.Add((xiiInt64)stallTime.GetNanoseconds());
+  m_ScratchStats[uiWorker] = content.GetScratchStats();
+}
+
+void xiiLineCountPipeline::Finish(xiiArrayPtr<FileStats> out_typeStats, ScanTimings& out_timings)
+{
+  // The files that are still being read have to reach the workers before they can be told that nothing follows
+  if (m_pReader != nullptr)
+  {
+    while (m_pReader->GetPendingCount() > 0)
+    {
+      ForwardCompletedReads(true);
+    }
+
+    m_pReader->Stop();
+  }
+
+  m_bEnumerationDone.Set(true);
+
+  if (m_iWaitingWorkers > 0)
+  {
+    m_JobsSignal.RaiseSignal();
+  }
+
+  if (m_pTask != nullptr)
+  {
+    XII_PROFILE_SCOPE("WaitForWorkers");
+    xiiTaskSystem::WaitForGroup(m_TaskGroup);
+  }
+  else
+  {
+    m_ScratchStats[0] = m_SerialContent.GetScratchStats();
+  }
+
+  // Merge the shards
+  for (const xiiDynamicArray<FileStats>& shard : m_Shards)
+  {
+    for (xiiUInt32 i = 0; i < shard.GetCount(); ++i)
+    {
+      out_typeStats[i] += shard[i];
+    }
+  }
+
+  for (const ScanTimings& timings : m_Timings)
+  {
+    out_timings += timings;
+  }
+}
+
+xiiLineCountScratchArena::Stats xiiLineCountPipeline::GetScratchStats() const
+{
+  xiiLineCountScratchArena::Stats total;
+
+  for (const xiiLineCountScratchArena::Stats& stats : m_ScratchStats)
+  {
+    total += stats;
+  }
+
+  return total;
+}
+
+class xiiLineCountApp : public xiiApplication
+{
+private:
+  xiiString m_sSearchDir;
+  xiiString m_sBenchmark;
+  xiiString m_sCacheFile;
+  xiiString m_sJsonReport;
+  xiiString m_sCsvReport;
+  xiiString m_sIgnorePatterns;
+  xiiString m_sGitDir;
+  xiiString m_sRevisions;
+  xiiString m_sShardFile;
+  xiiString m_sMergeFiles;
+  xiiString m_sTraceFile;
+  xiiUInt32 m_uiShard            = 0;
+  xiiUInt32 m_uiShardCount       = 1;
+  xiiUInt32 m_uiThreads          = 1;
+  xiiUInt64 m_uiMaxBytesInFlight = 0;
+  xiiUInt32 m_uiChunkSize        = 0;
+  xiiUInt32 m_uiReadAhead        = 0;
+  xiiUInt32 m_uiDirectoryDepth   = 0;
+  xiiUInt32 m_uiSlowestFiles     = 0;
+  bool      m_bRebuild           = false;
+  bool      m_bHashContent       = false;
+  bool      m_bDeduplicate       = false;
+  bool      m_bQuiet             = false;
+  bool      m_bUseIgnoreFiles    = true;
+  bool      m_bWatch             = false;
+  bool      m_bReadThreads       = false;
+  bool      m_bArchives          = false;
+  bool      m_bClassify          = false;
+
+  xiiLineCountFileTypes                    m_FileTypes;
+  xiiUniquePtr<xiiLineCountAsyncLogWriter> m_pHtmlLogWriter;
+
+#if XII_ENABLED(XII_SUPPORTS_DIRECTORY_WATCHER)
+  // Watch mode: the stats of every file, so that only the changed ones have to be scanned again
+  xiiUniquePtr<xiiDirectoryWatcher> m_pDirectoryWatcher;
+  xiiHashTable<xiiString, FileJob>  m_WatchedFiles; // By absolute path
+  xiiDynamicArray<FileStats>        m_WatchedTypeStats;
+  xiiLineCountIgnoreRules           m_WatchIgnoreRules;
+  xiiLineCountReport                m_WatchReport;
+  xiiSet<xiiString>                 m_ChangedFiles;
+  xiiSet<xiiString>                 m_ChangedDirectories;
+  FileContent                       m_WatchContent;
+#endif
+
+public:
+  using SUPER = xiiApplication;
+
+  xiiLineCountApp() :
+    xiiApplication("LineCountApp")
+  {
+    m_sSearchDir = "";
+  }
+
+  virtual void AfterCoreSystemsStartup() override
+  {
+    auto pCmd = xiiCommandLineUtils::GetGlobalInstance();
+
+    // Pass the absolute path to the directory that should be scanned as the first parameter to this application
+    if (pCmd->GetParameterCount() > 1 && !pCmd->GetParameter(1).StartsWith("-"))
+      m_sSearchDir = pCmd->GetParameter(1);
+
+    // Pass '-threads N' to scan the files with N worker threads
+    m_uiThreads = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-threads", 1), 1);
+
+    if (m_uiThreads > 1)
+    {
+      xiiTaskSystem::SetWorkerThreadCount(-1, (xiiInt32)m_uiThreads);
+    }
+
+    // Pass '-inflight N' to limit the size of the files that are queued for scanning to N MB
+    m_uiMaxBytesInFlight = (xiiUInt64)xiiMath::Max(pCmd->GetIntOption("-inflight", 64), 1) * 1024 * 1024;
+
+    // Pass '-stream N' to read all files in chunks of N KB, instead of loading each of them completely
+    m_uiChunkSize = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-stream", 0), 0) * 1024;
+
+    // Pass '-readahead N' to read up to N small files at the same time before they reach the workers (io_uring on Linux)
+    m_uiReadAhead = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-readahead", 0), 0);
+
+    // Pass '-readthreads' to read ahead with a pool of threads, even where io_uring is available
+    m_bReadThreads = pCmd->GetBoolOption("-readthreads");
+
+    // Pass '-kernel Scalar|SSE2|AVX2' to override the automatically detected text classification kernel
+    const xiiStringView sKernel = pCmd->GetStringOption("-kernel");
+    for (xiiUInt32 k = 0; k <= (xiiUInt32)xiiLineCountScanner::Kernel::AVX2; ++k)
+    {
+      if (sKernel.IsEqual_NoCase(xiiLineCountScanner::GetKernelName((xiiLineCountScanner::Kernel)k)))
+        xiiLineCountScanner::SetKernel((xiiLineCountScanner::Kernel)k);
+    }
+
+    if (m_sSearchDir.IsEmpty())
+    {
+      xiiStringBuilder sXIISource = xiiFileSystem::GetSdkRootDirectory();
+      sXIISource.AppendPath("Source");
+      sXIISource.MakeCleanPath();
+
+      m_sSearchDir = sXIISource;
+    }
+
+    // Pass '-benchmark utf8' or '-benchmark corpus' to run a benchmark instead of scanning a directory
+    m_sBenchmark = pCmd->GetStringOption("-benchmark");
+
+    // Pass '-quiet' to not log every directory and file that is found
+    m_bQuiet = pCmd->GetBoolOption("-quiet");
+
+    // Pass '-ext "cpp;h;cs"' to scan files with other extensions than the default ones
+    if (pCmd->GetOptionIndex("-ext") >= 0 && m_FileTypes.SetExtensions(pCmd->GetStringOption("-ext")).Failed())
+    {
+      xiiLog::Error("Invalid '-ext' option, at most {0} extensions with up to {1} characters are supported", xiiLineCountFileTypes::MaxTypes, xiiLineCountFileTypes::MaxExtensionLength);
+    }
+
+    // Pass '-ignore "Output;*.generated.h"' to skip more files and directories, with the same patterns as in .gitignore files
+    m_sIgnorePatterns = pCmd->GetStringOption("-ignore");
+
+    // Pass '-noignorefiles' to not skip what .gitignore and .ignore files exclude (the .git directory is always skipped)
+    m_bUseIgnoreFiles = !pCmd->GetBoolOption("-noignorefiles");
+
+    // Pass '-watch' to keep running after the first scan and update the stats whenever files change
+    m_bWatch = pCmd->GetBoolOption("-watch");
+
+    // Pass '-git <dir>' to count the files of a commit straight from the git repository in that directory, without checking it out
+    m_sGitDir = pCmd->GetStringOption("-git");
+
+    // Pass '-rev "HEAD;v1.0;<commit id>"' together with '-git' to count several commits, each one with its own report
+    m_sRevisions = pCmd->GetStringOption("-rev", 0, "HEAD");
+
+    // Pass '-json <file>' and/or '-csv <file>' to additionally write the results in a machine-readable format
+    m_sJsonReport = pCmd->GetStringOption("-json");
+    m_sCsvReport  = pCmd->GetStringOption("-csv");
+
+    // Pass '-rebuild' to ignore the stats of the previous run and scan every file again
+    m_bRebuild = pCmd->GetBoolOption("-rebuild");
+
+    // Pass '-cachehash' to also detect files whose modification time changed, but whose content did not
+    m_bHashContent = pCmd->GetBoolOption("-cachehash");
+
+    // Pass '-dedup' to count files with the same content (e.g. copies of the same headers) only once
+    m_bDeduplicate = pCmd->GetBoolOption("-dedup");
+
+    // Pass '-classify' to also count code, comment and mixed lines. Telling comments from code makes counting C-family
+    // sources about a third slower, so it is only done on request.
+    m_bClassify = pCmd->GetBoolOption("-classify");
+
+    // Pass '-archives' to also count the files in .zip, .tar, .tar.gz and .tgz archives, without extracting them
+    m_bArchives = pCmd->GetBoolOption("-archives");
+
+    if (m_bArchives && m_bWatch)
+    {
+      xiiLog::Error("'-archives' can't be combined with '-watch', archives are not opened");
+      m_bArchives = false;
+    }
+
+    // Pass '-dirdepth N' to also report the stats of every directory up to N levels below the search directory
+    m_uiDirectoryDepth = xiiMath::Min((xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-dirdepth", 0), 0), xiiLineCountDirectoryTree::MaxDepth);
+
+    if (m_uiDirectoryDepth > 0 && (m_bWatch || !m_sGitDir.IsEmpty()))
+    {
+      xiiLog::Error("'-dirdepth' can't be combined with '-watch' or '-git', only directory scans have stats per directory");
+      m_uiDirectoryDepth = 0;
+    }
+
+    // Pass '-slowest N' to list the N files of a directory scan that took the longest to scan
+    m_uiSlowestFiles = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-slowest", 0), 0);
+
+    // Pass '-trace <file>' to write the profiling scopes of the run as a Chrome trace (JSON, which Perfetto loads as well),
+    // with one track per thread. Every thread only keeps its most recent scopes, so for large trees this is the end of the run.
+    m_sTraceFile = pCmd->GetStringOption("-trace");
+
+    // Pass '-shard i/N' to only count the i-th of N parts of the tree (starting at 0), e.g. to split a huge tree over several machines.
+    // Files are assigned by a hash of their path relative to the search directory, so every process gets the same parts.
+    const xiiStringView sShard = pCmd->GetStringOption("-shard");
+    if (!sShard.IsEmpty() && ParseShard(sShard).Failed())
+    {
+      xiiLog::Error("Invalid '-shard' option '{0}', expected 'i/N' with i < N <= {1}", sShard, xiiLineCountReport::MaxShardCount);
+      m_uiShard      = 0;
+      m_uiShardCount = 1;
+    }
+
+    // Pass '-shardfile <file>' to choose where the result of a shard is written, by default it goes next to the log
+    m_sShardFile = pCmd->GetStringOption("-shardfile");
+
+    // Pass '-merge "a.shard;b.shard"' to combine the results of all shards into one report, instead of scanning a directory
+    m_sMergeFiles = pCmd->GetStringOption("-merge");
+
+    if (m_uiShardCount > 1 && (m_bWatch || !m_sGitDir.IsEmpty()))
+    {
+      xiiLog::Error("'-shard' can't be combined with '-watch' or '-git', the whole tree is counted");
+      m_uiShard      = 0;
+      m_uiShardCount = 1;
+    }
+
+    xiiLog::Info("Search-dir: {}", m_sSearchDir);
+    xiiLog::Info("Threads: {}", m_uiThreads);
+
+    if (m_uiShardCount > 1)
+      xiiLog::Info("Shard: {0} of {1}", m_uiShard, m_uiShardCount);
+    xiiLog::Info("Kernel: {}", xiiLineCountScanner::GetKernelName(xiiLineCountScanner::GetKernel()));
+
+    // Then add a folder as a data directory (the previously registered Factory will take care of creating the proper handler)
+    // As we only need access to files through global paths, we add the "empty data directory"
+    // This data dir will manage all accesses through absolute paths, unless any other data directory can handle them
+    // since we don't add any further data dirs, this is it
+    xiiFileSystem::AddDataDirectory("", "", ":", xiiFileSystem::AllowWrites).IgnoreResult();
+
+
+    // Now we can set up the logging system (we could do it earlier, but the HTML writer needs access to the file system)
+
+    xiiStringBuilder sLogPath = m_sSearchDir;
+    sLogPath.PathParentDirectory(); // Go one folder up
+    sLogPath.AppendPath("CodeStatistics.htm");
+
+    // Shards may run on the same machine, each of them needs its own log and cache
+    if (m_uiShardCount > 1)
+    {
+      xiiStringBuilder sName;
+      sName.AppendFormat("CodeStatistics-Shard{0}of{1}", m_uiShard, m_uiShardCount);
+      sLogPath.ChangeFileName(sName);
+
+      if (m_sShardFile.IsEmpty())
+      {
+        xiiStringBuilder sShardPath = sLogPath;
+        sShardPath.ChangeFileExtension("shard");
+        m_sShardFile = sShardPath;
+      }
+    }
+
+    // The stats of all files are cached next to the log, to only scan files that changed on the next run
+    xiiStringBuilder sCachePath = sLogPath;
+    sCachePath.ChangeFileExtension("cache");
+    m_sCacheFile = sCachePath;
+
+    // The console log writer will pass all log messages to the standard console window
+    xiiGlobalLog::AddLogWriter(xiiLogWriter::Console::LogMessageHandler);
+    // The Visual Studio log writer will pass all messages to the output window in VS
+    xiiGlobalLog::AddLogWriter(xiiLogWriter::VisualStudio::LogMessageHandler);
+    // The HTML log writer will write all log messages to an HTML file
+    // Writing the file happens on a background thread, so that logging doesn't slow down the scan
+    g_HtmlLog.BeginLog(sLogPath.GetData(), "Code Statistics");
+    m_pHtmlLogWriter = XII_DEFAULT_NEW(xiiLineCountAsyncLogWriter);
+    m_pHtmlLogWriter->Start(xiiLoggingEvent::Handler(&xiiLogWriter::HTML::LogMessageHandler, &g_HtmlLog));
+    xiiGlobalLog::AddLogWriter(xiiLoggingEvent::Handler(&xiiLineCountAsyncLogWriter::LogMessageHandler, m_pHtmlLogWriter.Borrow()));
+  }
+
+  virtual void BeforeCoreSystemsShutdown() override
+  {
+#if XII_ENABLED(XII_SUPPORTS_DIRECTORY_WATCHER)
+    if (m_pDirectoryWatcher != nullptr)
+    {
+      m_pDirectoryWatcher->CloseDirectory();
+      m_pDirectoryWatcher.Clear();
+    }
+#endif
+
+    // Write all remaining messages to the HTML log
+    xiiGlobalLog::RemoveLogWriter(xiiLoggingEvent::Handler(&xiiLineCountAsyncLogWriter::LogMessageHandler, m_pHtmlLogWriter.Borrow()));
+    m_pHtmlLogWriter->Stop();
+    m_pHtmlLogWriter.Clear();
+
+    // Close the HTML log, from now on no more log messages are written to the file
+    g_HtmlLog.EndLog();
+  }
+
+  // The language that the files of the given type are scanned as. Without '-classify', no file is classified at all.
+  xiiLineCountLanguage GetLanguage(xiiUInt32 uiFileType) const
+  {
+    return m_bClassify ? m_FileTypes.GetLanguage(uiFileType) : xiiLineCountLanguage::None;
+  }
+
+  // Enumerates and scans all files in the given directory and fills out the report. Returns false if the directory can't be searched.
+  // If out_pFiles is given, it receives every scanned file with its stats.
+  bool ScanDirectory(xiiStringView sSearchDir, bool bUseCache, xiiLineCountReport& out_report, xiiDeque<FileJob>* out_pFiles = nullptr) const
+  {
+    XII_PROFILE_SCOPE("ScanDirectory");
+
+    xiiDeque<FileJob>      Files; // Jobs must not move while the workers access them
+    xiiTime                PushTime; // Time the enumerating thread spent handing files over (or scanning them, with a single thread)
+    xiiLineCountStatsCache Cache;
+    xiiLineCountDedupTable Dedup;
+    ScanSettings           Settings;
+
+    Settings.m_pDedup       = m_bDeduplicate ? &Dedup : nullptr;
+    Settings.m_bHashContent = m_bHashContent;
+    Settings.m_uiChunkSize  = m_uiChunkSize;
+    Settings.m_uiReadAhead  = m_uiReadAhead;
+    Settings.m_bReadThreads = m_bReadThreads;
+    Settings.m_pFileTypes   = &m_FileTypes;
+    Settings.m_bClassify    = m_bClassify;
+
+    if (bUseCache && !m_bRebuild && Cache.Load(m_sCacheFile, sSearchDir, m_bClassify).Succeeded())
+    {
+      Settings.m_pCache = &Cache;
+    }
+
+    // Get a directory iterator for the search directory
+    xiiFileSystemIterator it;
+    it.StartSearch(sSearchDir);
+
+    if (!it.IsValid())
+      return false;
+
+    out_report.m_sSearchDir  = sSearchDir;
+    out_report.m_uiThreads   = m_uiThreads;
+    out_report.m_bClassified = m_bClassify;
+
+    xiiStringBuilder b;
+
+    // Files are scanned while the enumeration continues
+    const xiiUInt64         uiHeapAllocations = xiiFoundation::GetDefaultAllocator()->GetStats().m_uiNumAllocations;
+    const xiiTime           scanStartTime     = xiiTime::Now();
+    xiiLineCountPipeline    Pipeline(Settings, m_FileTypes.GetCount(), m_uiThreads, m_uiMaxBytesInFlight);
+    xiiLineCountIgnoreRules IgnoreRules;
+
+    xiiStringBuilder sRootDir = sSearchDir;
+    sRootDir.MakeCleanPath();
+    IgnoreRules.Reset(sRootDir, m_sIgnorePatterns, m_bUseIgnoreFiles);
+
+    // With '-dirdepth', every file is also recorded in the directory that it counts for
+    xiiLineCountDirectoryTree Tree;
+    Tree.Reset(sRootDir, m_uiDirectoryDepth);
+
+    // While there are additional files / folders
+    while (it.IsValid())
+    {
+      // Build the absolute path to the current file
+      b = it.GetCurrentPath();
+      b.AppendPath(it.GetStats().m_sName.GetData());
+
+      // With '-shard', every process walks the whole tree, but only counts its own files and directories
+      const bool bInShard = IsInShard(sRootDir, b);
+
+      // Ignored directories are skipped as a whole, the iterator doesn't even enter them
+      if (IgnoreRules.IsIgnored(it.GetCurrentPath(), it.GetStats().m_sName, it.GetStats().m_bIsDirectory))
+      {
+        if (it.GetStats().m_bIsDirectory)
+        {
+          if (bInShard)
+            ++out_report.m_uiIgnoredDirectories;
+
+          it.SkipFolder();
+        }
+        else
+        {
+          if (bInShard)
+            ++out_report.m_uiIgnoredFiles;
+
+          it.Next();
+        }
+
+        continue;
+      }
+
+      // The tree also needs the directories of other shards, for the files in them that belong to this one
+      if (m_uiDirectoryDepth > 0 && it.GetStats().m_bIsDirectory)
+      {
+        Tree.AddDirectory(it.GetCurrentPath(), it.GetStats().m_sName);
+      }
+
+      // Directories of other shards are still entered, their content may belong to this one
+      if (!bInShard)
+      {
+        it.Next();
+        continue;
+      }
+
+      // Log some info
+      if (!m_bQuiet)
+        xiiLog::Info("{0}: {1}", it.GetStats().m_bIsDirectory ? "Directory" : "File", b);
+
+      if (it.GetStats().m_bIsDirectory)
+      {
+        ++out_report.m_uiDirectories;
+      }
+      else
+      {
+        // Extensions are compared case-insensitively
+        const xiiUInt32                   uiFileType    = m_FileTypes.Find(b.GetFileExtension());
+        xiiLineCountArchiveReader::Format ArchiveFormat = xiiLineCountArchiveReader::Format::Zip;
+        const bool                        bArchive      = uiFileType == xiiLineCountFileTypes::InvalidIndex && m_bArchives && xiiLineCountArchiveReader::GetFormat(b, ArchiveFormat);
+
+        if (uiFileType != xiiLineCountFileTypes::InvalidIndex || bArchive)
+        {
+          FileJob& job            = Files.ExpandAndGetRef();
+          job.m_sPath             = b;
+          job.m_uiFileSize        = it.GetStats().m_uiFileSize;
+          job.m_iModificationTime = it.GetStats().m_LastModificationTime.GetInt64(xiiSIUnitOfTime::Microsecond);
+
+          // The tree numbers the files in the same order as Files
+          if (m_uiDirectoryDepth > 0)
+            Tree.AddFile(it.GetCurrentPath());
+
+          if (bArchive)
+          {
+            job.m_bArchive      = true;
+            job.m_ArchiveFormat = ArchiveFormat;
+          }
+          else
+          {
+            job.m_uiFileType = uiFileType;
+            job.m_Language   = GetLanguage(uiFileType);
+          }
+
+          const xiiTime pushStartTime = xiiTime::Now();
+          Pipeline.Push(job);
+          PushTime += xiiTime::Now() - pushStartTime;
+        }
+      }
+
+      it.Next();
+    }
+
+    out_report.m_EnumerateTime = xiiTime::Now() - scanStartTime - PushTime;
+    out_report.m_uiIgnoreFiles = IgnoreRules.GetIgnoreFileCount();
+
+    // Wait for the files that are still being scanned
+    xiiDynamicArray<FileStats> TypeStats;
+    TypeStats.SetCount(m_FileTypes.GetCount());
+
+    Pipeline.Finish(TypeStats, out_report.m_ScanTimings);
+    out_report.m_TotalTime         = xiiTime::Now() - scanStartTime;
+    out_report.m_uiHeapAllocations = xiiFoundation::GetDefaultAllocator()->GetStats().m_uiNumAllocations - uiHeapAllocations;
+
+    const xiiLineCountScratchArena::Stats ScratchStats = Pipeline.GetScratchStats();
+    out_report.m_uiScratchAllocations                  = ScratchStats.m_uiAllocations;
+    out_report.m_uiScratchHeapAllocations              = ScratchStats.m_uiHeapAllocations;
+    out_report.m_uiScratchPeakBytes                    = ScratchStats.m_uiPeakBytes;
+    out_report.m_uiReadBufferAllocations               = Pipeline.GetReadBufferAllocations();
+
+    SetTypeStats(TypeStats, out_report);
+
+    if (m_bDeduplicate)
+    {
+      out_report.m_bDeduplicated      = true;
+      out_report.m_uiDuplicateFiles   = Dedup.GetDuplicateFiles();
+      out_report.m_uiDuplicateBytes   = Dedup.GetDuplicateBytes();
+      out_report.m_DuplicateTimeSaved = Dedup.GetTimeSaved();
+    }
+
+    if (Pipeline.IsParallel())
+    {
+      out_report.m_bPipelined          = true;
+      out_report.m_uiMaxQueueDepth     = Pipeline.GetMaxQueueDepth();
+      out_report.m_fAverageQueueDepth  = Pipeline.GetAverageQueueDepth();
+      out_report.m_EnumeratorStallTime = Pipeline.GetEnumeratorStallTime();
+      out_report.m_WorkerStallTime     = Pipeline.GetWorkerStallTime();
+    }
+
+    if (const xiiLineCountAsyncReader* pReader = Pipeline.GetReader())
+    {
+      out_report.m_sReadAheadBackend     = xiiLineCountAsyncReader::GetBackendName(pReader->GetBackend());
+      out_report.m_uiReadAheadQueueDepth = m_uiReadAhead;
+      out_report.m_uiReadAheadFiles      = Pipeline.GetReadAheadFiles();
+      out_report.m_ReadAheadWaitTime     = Pipeline.GetReadAheadWaitTime();
+    }
+
+    for (const FileJob& job : Files)
+    {
+      if (job.m_bArchive)
+      {
+        ++out_report.m_uiArchives;
+        out_report.m_uiArchiveFiles += job.m_uiArchiveFiles;
+      }
+    }
+
+    if (m_uiSlowestFiles > 0)
+    {
+      out_report.m_uiSlowFileCount = m_uiSlowestFiles;
+
+      for (const FileJob& job : Files)
+      {
+        out_report.AddSlowFile(job.m_sPath, job.m_uiFileSize, job.m_ScanTime);
+      }
+    }
+
+    if (m_uiDirectoryDepth > 0)
+    {
+      const xiiTime reduceStartTime = xiiTime::Now();
+
+      // Like in the stats per file type, files that could not be read still count as files
+      Tree.Reduce([&Files](xiiUInt32 uiFile, FileStats& inout_stats)
+        {
+          const FileJob& job = Files[uiFile];
+          inout_stats += job.m_Stats;
+
+          if (!job.m_bArchive)
+            ++inout_stats.m_uiFileCount;
+        },
+        m_uiThreads);
+
+      // The root is the search directory itself, its stats are the total
+      out_report.m_uiDirectoryDepth = m_uiDirectoryDepth;
+      for (xiiUInt32 i = 1; i < Tree.GetCount(); ++i)
+      {
+        out_report.m_DirectoryStats[Tree.GetPath(i)] = Tree.GetStats(i);
+      }
+
+      out_report.m_DirectoryTime = xiiTime::Now() - reduceStartTime;
+    }
+
+    if (bUseCache)
+    {
+      out_report.m_bUsedCache = Settings.m_pCache != nullptr;
+
+      for (const FileJob& job : Files)
+      {
+        if (job.m_bCached)
+          ++out_report.m_uiCachedFiles;
+      }
+
+      // Replace the cache with the stats of this run, which also drops all files that were deleted in the meantime
+      UpdateCache(sSearchDir, Files, Cache);
+    }
+
+    if (out_pFiles != nullptr)
+    {
+      *out_pFiles = std::move(Files);
+    }
+
+    return true;
+  }
+
+  xiiResult ParseShard(xiiStringView sShard)
+  {
+    xiiStringBuilder               sText = sShard;
+    xiiDynamicArray<xiiStringView> Parts;
+    sText.Split(false, Parts, "/");
+
+    if (Parts.GetCount() != 2)
+      return XII_FAILURE;
+
+    XII_SUCCEED_OR_RETURN(xiiConversionUtils::StringToUInt(Parts[0], m_uiShard));
+    XII_SUCCEED_OR_RETURN(xiiConversionUtils::StringToUInt(Parts[1], m_uiShardCount));
+
+    return m_uiShard < m_uiShardCount && m_uiShardCount <= xiiLineCountReport::MaxShardCount ? XII_SUCCESS : XII_FAILURE;
+  }
+
+  // Whether the file or directory is counted by this process, see '-shard'
+  bool IsInShard(xiiStringView sRootDir, xiiStringView sPath) const
+  {
+    if (m_uiShardCount <= 1)
+      return true;
+
+    // Only the relative path is hashed, so machines that have the tree in different places still agree on the parts
+    if (sPath.StartsWith(sRootDir))
+      sPath.Shrink(sRootDir.GetCharacterCount(), 0);
+
+    while (sPath.StartsWith("/"))
+      sPath.Shrink(1, 0);
+
+    return xiiHashingUtils::xxHash64(sPath.GetStartPointer(), sPath.GetElementCount()) % m_uiShardCount == m_uiShard;
+  }
+
+  // Combines the results that were written with '-shard' into one report
+  void MergeShards() const
+  {
+    xiiStringBuilder               sFiles = m_sMergeFiles;
+    xiiDynamicArray<xiiStringView> Files;
+    sFiles.Split(false, Files, ";");
+
+    xiiLineCountReport    Report;
+    xiiDynamicArray<bool> ShardsFound;
+
+    for (xiiStringView sFile : Files)
+    {
+      xiiLineCountReport Shard;
+      xiiUInt32          uiShard      = 0;
+      xiiUInt32          uiShardCount = 0;
+
+      if (Shard.ReadShard(sFile, uiShard, uiShardCount).Failed())
+      {
+        xiiLog::Error("Could not read the shard result '{0}'", sFile);
+        continue;
+      }
+
+      if (ShardsFound.IsEmpty())
+      {
+        ShardsFound.SetCount(uiShardCount);
+      }
+      else if (uiShardCount != ShardsFound.GetCount())
+      {
+        xiiLog::Error("'{0}' is shard {1} of {2}, but the other results are shards of {3}, it is skipped", sFile, uiShard, uiShardCount, ShardsFound.GetCount());
+        continue;
+      }
+
+      if (ShardsFound[uiShard])
+      {
+        xiiLog::Warning("Shard {0} was already merged, '{1}' is skipped", uiShard, sFile);
+        continue;
+      }
+
+      if (!Report.m_sSearchDir.IsEmpty() && Report.m_sSearchDir != Shard.m_sSearchDir)
+        xiiLog::Warning("'{0}' was counted in '{1}', the other shards in '{2}'", sFile, Shard.m_sSearchDir, Report.m_sSearchDir);
+
+      if (!Report.m_sSearchDir.IsEmpty() && Report.m_bClassified != Shard.m_bClassified)
+        xiiLog::Warning("'{0}' and the other shards differ in '-classify', the code, comment and mixed lines are incomplete", sFile);
+
+      if (!m_bQuiet)
+        xiiLog::Info("Shard {0} of {1}: {2} Files, '{3}'", uiShard, uiShardCount, Shard.m_Total.m_uiFileCount, sFile);
+
+      ShardsFound[uiShard] = true;
+      Report.Merge(Shard);
+    }
+
+    if (ShardsFound.IsEmpty())
+    {
+      xiiLog::Error("No shard results to merge, pass them with '-merge \"a.shard;b.shard\"'");
+      return;
+    }
+
+    for (xiiUInt32 i = 0; i < ShardsFound.GetCount(); ++i)
+    {
+      if (!ShardsFound[i])
+        xiiLog::Warning("Shard {0} of {1} is missing, the report is incomplete", i, ShardsFound.GetCount());
+    }
+
+    LogReport(Report);
+    WriteReports(Report);
+  }
+
+  // Replaces the stats per file type and the total stats of the report
+  void SetTypeStats(xiiArrayPtr<const FileStats> typeStats, xiiLineCountReport& out_report) const
+  {
+    out_report.m_FileTypes.Clear();
+    out_report.m_Total = FileStats();
+
+    // Only the file types that were actually found are reported, sorted by extension
+    for (xiiUInt32 i = 0; i < typeStats.GetCount(); ++i)
+    {
+      if (typeStats[i].m_uiFileCount > 0)
+      {
+        out_report.m_FileTypes[m_FileTypes.GetExtension(i)] = typeStats[i];
+        out_report.m_Total += typeStats[i];
+      }
+    }
+  }
+
+#if XII_ENABLED(XII_SUPPORTS_DIRECTORY_WATCHER)
+  // Keeps the stats of all files of the first scan and starts watching the search directory for changes
+  xiiResult StartWatching(const xiiLineCountReport& report, xiiDeque<FileJob>& ref_files)
+  {
+    xiiStringBuilder sSearchDir = m_sSearchDir;
+    sSearchDir.MakeCleanPath();
+
+    m_pDirectoryWatcher = XII_DEFAULT_NEW(xiiDirectoryWatcher);
+    if (m_pDirectoryWatcher->OpenDirectory(sSearchDir, xiiDirectoryWatcher::Watch::Writes | xiiDirectoryWatcher::Watch::Creates | xiiDirectoryWatcher::Watch::Deletes | xiiDirectoryWatcher::Watch::Renames | xiiDirectoryWatcher::Watch::Subdirectories).Failed())
+    {
+      xiiLog::Error("Could not watch the directory '{0}'", sSearchDir);
+      m_pDirectoryWatcher.Clear();
+      return XII_FAILURE;
+    }
+
+    m_WatchReport = report;
+    m_WatchIgnoreRules.Reset(sSearchDir, m_sIgnorePatterns, m_bUseIgnoreFiles);
+    m_WatchedTypeStats.Clear();
+    m_WatchedTypeStats.SetCount(m_FileTypes.GetCount());
+    m_WatchedFiles.Clear();
+    m_WatchedFiles.Reserve(ref_files.GetCount());
+
+    for (FileJob& job : ref_files)
+    {
+      ++m_WatchedTypeStats[job.m_uiFileType].m_uiFileCount;
+      m_WatchedTypeStats[job.m_uiFileType] += job.m_Stats;
+
+      m_WatchedFiles.Insert(job.m_sPath, std::move(job));
+    }
+
+    ref_files.Clear();
+
+    xiiLog::Info("Watching '{0}' for changes", sSearchDir);
+    return XII_SUCCESS;
+  }
+
+  // Waits until files changed, scans them again and publishes the updated stats. Returns without changes after waitUpTo.
+  void UpdateWatchedFiles(xiiTime waitUpTo)
+  {
+    // The watcher waits for the OS to report changes and returns as soon as OnFileChanged() received some
+    m_pDirectoryWatcher->EnumerateChanges(xiiMakeDelegate(&xiiLineCountApp::OnFileChanged, this), waitUpTo);
+
+    if (m_ChangedFiles.IsEmpty() && m_ChangedDirectories.IsEmpty())
+      return;
+
+    const xiiTime startTime = xiiTime::Now();
+    xiiUInt32     uiFiles   = 0;
+
+    // Whatever happened to a directory, its old files are dropped and its current ones are added again
+    for (const xiiString& sDirectory : m_ChangedDirectories)
+    {
+      uiFiles += UpdateWatchedDirectory(sDirectory);
+    }
+
+    // Editors often write a file several times, every file is scanned only once per update
+    for (const xiiString& sFile : m_ChangedFiles)
+    {
+      UpdateWatchedFile(sFile);
+      ++uiFiles;
+    }
+
+    m_ChangedFiles.Clear();
+    m_ChangedDirectories.Clear();
+
+    SetTypeStats(m_WatchedTypeStats, m_WatchReport);
+
+    const FileStats& AllTypes = m_WatchReport.m_Total;
+    xiiLog::Info("Updated {0} Files in {1} ms: {2} Files, {3} Lines, {4} Empty Lines", uiFiles, xiiArgF((xiiTime::Now() - startTime).GetMilliseconds(), 1), AllTypes.m_uiFileCount, AllTypes.m_uiLines, AllTypes.m_uiEmptyLines);
+
+    if (m_bClassify)
+    {
+      xiiLog::Info("Updated: {0} Code Lines, {1} Comment Lines, {2} Mixed Lines", AllTypes.m_uiCodeLines, AllTypes.m_uiCommentLines, AllTypes.m_uiMixedLines);
+    }
+
+    WriteReports(m_WatchReport);
+  }
+
+  void OnFileChanged(xiiStringView sFilename, xiiDirectoryWatcherAction action, xiiDirectoryWatcherType type)
+  {
+    xiiStringBuilder sPath = sFilename;
+
+    if (!xiiPathUtils::IsAbsolutePath(sPath))
+    {
+      sPath = m_sSearchDir;
+      sPath.AppendPath(sFilename);
+    }
+
+    sPath.MakeCleanPath();
+
+    if (type == xiiDirectoryWatcherType::Directory)
+    {
+      // Only the files in directories that appear or disappear as a whole need to be updated, the files report their own changes
+      if (action != xiiDirectoryWatcherAction::Modified)
+        m_ChangedDirectories.Insert(sPath);
+    }
+    else
+    {
+      m_ChangedFiles.Insert(sPath);
+    }
+  }
+
+  // Takes the current content of the file into account, or drops it if it does not exist anymore or isn't counted
+  void UpdateWatchedFile(xiiStringView sFile)
+  {
+    if (const FileJob* pOld = m_WatchedFiles.GetValue(sFile))
+    {
+      FileStats& TypeStats = m_WatchedTypeStats[pOld->m_uiFileType];
+      --TypeStats.m_uiFileCount;
+      TypeStats -= pOld->m_Stats;
+
+      m_WatchedFiles.Remove(sFile);
+    }
+
+    const xiiUInt32 uiFileType = m_FileTypes.Find(xiiPathUtils::GetFileExtension(sFile));
+
+    xiiFileStats stats;
+    if (uiFileType == xiiLineCountFileTypes::InvalidIndex || xiiOSFile::GetFileStats(sFile, stats).Failed() || stats.m_bIsDirectory || m_WatchIgnoreRules.IsPathIgnored(sFile, false))
+      return;
+
+    FileJob job;
+    job.m_sPath             = sFile;
+    job.m_uiFileType        = uiFileType;
+    job.m_Language          = GetLanguage(uiFileType);
+    job.m_uiFileSize        = stats.m_uiFileSize;
+    job.m_iModificationTime = stats.m_LastModificationTime.GetInt64(xiiSIUnitOfTime::Microsecond);
+
+    ScanSettings Settings;
+    Settings.m_uiChunkSize = m_uiChunkSize;
+
+    ScanTimings Timings;
+    ScanFile(job, Settings, m_WatchContent, m_WatchedTypeStats, Timings);
+
+    m_WatchedFiles.Insert(sFile, std::move(job));
+  }
+
+  // Drops all known files below the directory and adds the ones that are there now. Returns the number of affected files.
+  xiiUInt32 UpdateWatchedDirectory(xiiStringView sDirectory)
+  {
+    xiiStringBuilder sPrefix = sDirectory;
+    sPrefix.Append("/");
+
+    // Files that were known and still exist are found twice, but only updated once
+    xiiSet<xiiString> Files;
+
+    for (auto it = m_WatchedFiles.GetIterator(); it.IsValid(); ++it)
+    {
+      if (it.Key().StartsWith(sPrefix))
+        Files.Insert(it.Key());
+    }
+
+    if (!m_WatchIgnoreRules.IsPathIgnored(sDirectory, true))
+    {
+      xiiFileSystemIterator it;
+      it.StartSearch(sDirectory);
+
+      xiiStringBuilder b;
+
+      while (it.IsValid())
+      {
+        if (m_WatchIgnoreRules.IsIgnored(it.GetCurrentPath(), it.GetStats().m_sName, it.GetStats().m_bIsDirectory))
+        {
+          if (it.GetStats().m_bIsDirectory)
+            it.SkipFolder();
+          else
+            it.Next();
+
+          continue;
+        }
+
+        if (!it.GetStats().m_bIsDirectory)
+        {
+          b = it.GetCurrentPath();
+          b.AppendPath(it.GetStats().m_sName.GetData());
+          Files.Insert(b);
+        }
+
+        it.Next();
+      }
+    }
+
+    for (const xiiString& sFile : Files)
+    {
+      UpdateWatchedFile(sFile);
+    }
+
+    return Files.GetCount();
+  }
+#endif
+
+  void UpdateCache(xiiStringView sSearchDir, const xiiDeque<FileJob>& files, xiiLineCountStatsCache& ref_cache) const
+  {
+    XII_PROFILE_SCOPE("UpdateCache");
+
+    ref_cache.Clear();
+    ref_cache.SetSearchDir(sSearchDir);
+    ref_cache.SetClassified(m_bClassify);
+
+    for (const FileJob& job : files)
+    {
+      if (!job.m_bValid)
+        continue;
+
+      xiiLineCountStatsCache::Entry entry;
+      entry.m_uiFileSize        = job.m_uiFileSize;
+      entry.m_iModificationTime = job.m_iModificationTime;
+      entry.m_uiContentHash     = job.m_uiContentHash;
+      entry.m_Stats             = job.m_Stats;
+
+      ref_cache.Store(job.m_sPath, entry);
+    }
+
+    if (ref_cache.Save(m_sCacheFile).Failed())
+    {
+      xiiLog::Warning("Could not write the stats cache '{0}'", m_sCacheFile);
+    }
+  }
+
+  void LogReport(const xiiLineCountReport& report) const
+  {
+    const FileStats& AllTypes = report.m_Total;
+    const xiiUInt64  uiFiles  = AllTypes.m_uiFileCount;
+
+    // Now output some statistics
+    xiiLog::Info("Directories: {0}, Files: {1}, Avg. Files per Dir: {2}", report.m_uiDirectories, uiFiles, xiiArgF(uiFiles / (float)report.m_uiDirectories, 1));
+
+    // Iterate over all elements in the amp
+    FileTypeStatsMap::ConstIterator MapIt = report.m_FileTypes.GetIterator();
+    while (MapIt.IsValid())
+    {
+      xiiLog::Info("File Type: '{0}': {1} Files, {2} Lines, {3} Empty Lines, Bytes: {4}, Non-ASCII Characters: {5}, Words: {6}", MapIt.Key(), MapIt.Value().m_uiFileCount, MapIt.Value().m_uiLines, MapIt.Value().m_uiEmptyLines, MapIt.Value().m_uiBytes,
+                   MapIt.Value().m_uiBytes - MapIt.Value().m_uiCharacters, MapIt.Value().m_uiWords);
+
+      if (report.m_bClassified)
+      {
+        xiiLog::Info("File Type: '{0}': {1} Code Lines, {2} Comment Lines, {3} Mixed Lines", MapIt.Key(), MapIt.Value().m_uiCodeLines, MapIt.Value().m_uiCommentLines, MapIt.Value().m_uiMixedLines);
+      }
+
+      ++MapIt;
+    }
+
+    xiiLog::Info("File Type: '{0}': {1} Files, {2} Lines, {3} Empty Lines, All Lines: {4}, Bytes: {5}, Non-ASCII Characters: {6}, Words: {7}", "all", AllTypes.m_uiFileCount, AllTypes.m_uiLines, AllTypes.m_uiEmptyLines, AllTypes.m_uiLines + AllTypes.m_uiEmptyLines, AllTypes.m_uiBytes,
+                 AllTypes.m_uiBytes - AllTypes.m_uiCharacters, AllTypes.m_uiWords);
+
+    if (report.m_bClassified)
+    {
+      xiiLog::Info("File Type: '{0}': {1} Code Lines, {2} Comment Lines, {3} Mixed Lines", "all", AllTypes.m_uiCodeLines, AllTypes.m_uiCommentLines, AllTypes.m_uiMixedLines);
+    }
+
+    xiiLog::Info("Ignored: {0} Directories, {1} Files ({2} Ignore Files read)", report.m_uiIgnoredDirectories, report.m_uiIgnoredFiles, report.m_uiIgnoreFiles);
+
+    for (auto it = report.m_DirectoryStats.GetIterator(); it.IsValid(); ++it)
+    {
+      xiiLog::Info("Directory: '{0}': {1} Files, {2} Lines, {3} Empty Lines, Bytes: {4}", it.Key(), it.Value().m_uiFileCount, it.Value().m_uiLines, it.Value().m_uiEmptyLines, it.Value().m_uiBytes);
+
+      if (report.m_bClassified)
+      {
+        xiiLog::Info("Directory: '{0}': {1} Code Lines, {2} Comment Lines, {3} Mixed Lines", it.Key(), it.Value().m_uiCodeLines, it.Value().m_uiCommentLines, it.Value().m_uiMixedLines);
+      }
+    }
+
+    if (report.m_uiDirectoryDepth > 0)
+    {
+      xiiLog::Info("Directory Stats: {0} Directories up to Depth {1}, summed up in {2} sec", report.m_DirectoryStats.GetCount(), report.m_uiDirectoryDepth, xiiArgF(report.m_DirectoryTime.GetSeconds(), 3));
+    }
+
+    for (const xiiLineCountReport::SlowFile& file : report.m_SlowFiles)
+    {
+      xiiLog::Info("Slow File: {0} ms, {1} KB: '{2}'", xiiArgF(file.m_ScanTime.GetMilliseconds(), 2), file.m_uiBytes / 1024, file.m_sPath);
+    }
+
+    if (report.m_uiArchives > 0)
+    {
+      xiiLog::Info("Archives: {0}, with {1} Files counted", report.m_uiArchives, report.m_uiArchiveFiles);
+    }
+
+    if (report.m_bUsedCache)
+    {
+      xiiLog::Info("Cache: {0} of {1} Files unchanged", report.m_uiCachedFiles, uiFiles);
+    }
+
+    if (report.m_bGitBlobs)
+    {
+      xiiLog::Info("Git: {0} of {1} Files with a Blob that was already counted", report.m_uiReusedBlobs, uiFiles);
+    }
+
+    if (report.m_bDeduplicated)
+    {
+      xiiLog::Info("Duplicates: {0} Files, {1} MB, {2} sec of counting saved (summed over all workers)", report.m_uiDuplicateFiles, xiiArgF(report.m_uiDuplicateBytes / (1024.0 * 1024.0), 1), xiiArgF(report.m_DuplicateTimeSaved.GetSeconds(), 3));
+    }
+
+    if (report.m_bPipelined)
+    {
+      xiiLog::Info("Queue Depth: Max {0}, Avg. {1}, Enumeration Stalled: {2} sec, Workers Stalled: {3} sec (summed over all workers)", report.m_uiMaxQueueDepth, xiiArgF(report.m_fAverageQueueDepth, 1),
+                   xiiArgF(report.m_EnumeratorStallTime.GetSeconds(), 3), xiiArgF(report.m_WorkerStallTime.GetSeconds(), 3));
+    }
+
+    if (!report.m_sReadAheadBackend.IsEmpty())
+    {
+      xiiLog::Info("Read-Ahead: {0} Files with {1}, Queue Depth {2}, Enumeration Waited: {3} sec", report.m_uiReadAheadFiles, report.m_sReadAheadBackend, report.m_uiReadAheadQueueDepth,
+                   xiiArgF(report.m_ReadAheadWaitTime.GetSeconds(), 3));
+    }
+
+    xiiLog::Info("Memory: {0} Scratch Allocations with {1} from the Heap (Peak {2} KB per File), {3} Read Buffers allocated, {4} Heap Allocations while scanning", report.m_uiScratchAllocations,
+                 report.m_uiScratchHeapAllocations, report.m_uiScratchPeakBytes / 1024, report.m_uiReadBufferAllocations, report.m_uiHeapAllocations);
+
+    xiiLog::Info("Enumerate: {0} sec, Read: {1} sec, Hash: {2} sec, Validate: {3} sec, Count: {4} sec (summed over all workers)", xiiArgF(report.m_EnumerateTime.GetSeconds(), 3), xiiArgF(report.m_ScanTimings.m_Read.GetSeconds(), 3),
+                 xiiArgF(report.m_ScanTimings.m_Hash.GetSeconds(), 3), xiiArgF(report.m_ScanTimings.m_Validate.GetSeconds(), 3), xiiArgF(report.m_ScanTimings.m_Count.GetSeconds(), 3));
+
+    // Throughput of enumerating, reading and counting
+    const double fScanSeconds = xiiMath::Max(report.m_TotalTime.GetSeconds(), 0.000001);
+    xiiLog::Info("Scanned {0} Files in {1} sec, {2} MB/sec, {3} Files/sec", uiFiles, xiiArgF(report.m_TotalTime.GetSeconds(), 3), xiiArgF(AllTypes.m_uiBytes / (1024.0 * 1024.0) / fScanSeconds, 1), xiiArgF(uiFiles / fScanSeconds, 0));
+  }
+
+  // A suffix is appended to the name of every report file, e.g. 'Stats.json' becomes 'Stats-v1.0.json'
+  void WriteReports(const xiiLineCountReport& report, xiiStringView sSuffix = {}) const
+  {
+    xiiStringBuilder sFile;
+
+    if (!m_sJsonReport.IsEmpty() && report.WriteJson(GetReportFile(m_sJsonReport, sSuffix, sFile)).Failed())
+      xiiLog::Error("Could not write the report '{0}'", sFile);
+
+    if (!m_sCsvReport.IsEmpty() && report.WriteCsv(GetReportFile(m_sCsvReport, sSuffix, sFile)).Failed())
+      xiiLog::Error("Could not write the report '{0}'", sFile);
+  }
+
+  void WriteTrace() const
+  {
+    if (m_sTraceFile.IsEmpty())
+      return;
+
+#if XII_ENABLED(XII_USE_PROFILING)
+    if (xiiProfilingUtils::SaveProfilingCapture(m_sTraceFile).Succeeded())
+      xiiLog::Info("Trace: '{0}'", m_sTraceFile);
+    else
+      xiiLog::Error("Could not write the trace '{0}'", m_sTraceFile);
+#else
+    xiiLog::Error("No profiling support, '-trace' is not available.");
+#endif
+  }
+
+  static xiiStringView GetReportFile(xiiStringView sFile, xiiStringView sSuffix, xiiStringBuilder& out_sFile)
+  {
+    out_sFile = sFile;
+
+    if (!sSuffix.IsEmpty())
+    {
+      xiiStringBuilder sName = out_sFile.GetFileName();
+      sName.Append("-", sSuffix);
+
+      // Revisions like 'origin/main' must not turn into directories
+      sName.ReplaceAll("/", "_");
+      sName.ReplaceAll("\\", "_");
+      sName.ReplaceAll(":", "_");
+
+      out_sFile.ChangeFileName(sName);
+    }
+
+    return out_sFile;
+  }
+
+#if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE) && XII_ENABLED(XII_SUPPORTS_FILE_ITERATORS)
+  // Counts the files of every revision straight from the git object database.
+  // The stats of every blob are kept, so files that are the same in several revisions (or several times in one) are read
+  // and counted only once. The report lists them as reused blobs.
+  void ScanGitRevisions() const
+  {
+    xiiLineCountGitRepository Repository;
+
+    if (Repository.Open(m_sGitDir).Failed())
+    {
+      xiiLog::Error("Could not open the git repository '{0}'", m_sGitDir);
+      return;
+    }
+
+    xiiLog::Info("Git-dir: {0} ({1} Packs)", Repository.GetGitDir(), Repository.GetPackCount());
+
+    xiiStringBuilder               sRevisions = m_sRevisions;
+    xiiDynamicArray<xiiStringView> Revisions;
+    sRevisions.Split(false, Revisions, ";");
+
+    xiiHashTable<GitBlobKey, FileStats, GitBlobKeyHash> BlobStats;
+    xiiDynamicArray<xiiLineCountGitRepository::File>    Files;
+    xiiDynamicArray<xiiUInt8>                           Content;
+    xiiDynamicArray<FileStats>                          TypeStats;
+    xiiStringBuilder                                    sName;
+
+    for (xiiStringView sRevision : Revisions)
+    {
+      xiiLineCountGitRepository::ObjectId CommitId;
+
+      if (Repository.ResolveRevision(sRevision, CommitId).Failed())
+      {
+        xiiLog::Error("Could not find the commit '{0}'", sRevision);
+        continue;
+      }
+
+      xiiLineCountReport Report;
+      sName.Set(Repository.GetGitDir(), "@", sRevision);
+      Report.m_sSearchDir  = sName;
+      Report.m_bClassified = m_bClassify;
+
+      const xiiTime scanStartTime = xiiTime::Now();
+
+      if (Repository.ListFiles(CommitId, Files, Report.m_uiDirectories).Failed())
+      {
+        xiiLog::Error("Could not read the tree of the commit '{0}'", sRevision);
+        continue;
+      }
+
+      Report.m_EnumerateTime = xiiTime::Now() - scanStartTime;
+      Report.m_bGitBlobs     = true;
+
+      TypeStats.Clear();
+      TypeStats.SetCount(m_FileTypes.GetCount());
+
+      for (const xiiLineCountGitRepository::File& file : Files)
+      {
+        const xiiUInt32 uiFileType = m_FileTypes.Find(xiiPathUtils::GetFileExtension(file.m_sPath));
+
+        if (uiFileType == xiiLineCountFileTypes::InvalidIndex)
+          continue;
+
+        if (!m_bQuiet)
+          xiiLog::Info("File: {0}", file.m_sPath);
+
+        // Like in ScanFile(), files that can't be read are still counted
+        ++TypeStats[uiFileType].m_uiFileCount;
+
+        GitBlobKey Key;
+        Key.m_Id       = file.m_Id;
+        Key.m_Language = GetLanguage(uiFileType);
+
+        const FileStats* pStats = BlobStats.GetValue(Key);
+
+        if (pStats != nullptr)
+        {
+          ++Report.m_uiReusedBlobs;
+        }
+        else
+        {
+          const xiiTime readStartTime = xiiTime::Now();
+
+          xiiLineCountGitRepository::ObjectType type = xiiLineCountGitRepository::ObjectType::Invalid;
+          if (Repository.ReadObject(file.m_Id, type, Content).Failed() || type != xiiLineCountGitRepository::ObjectType::Blob)
+          {
+            xiiLog::Warning("Could not read '{0}' from the repository", file.m_sPath);
+            continue;
+          }
+
+          Report.m_ScanTimings.m_Read += xiiTime::Now() - readStartTime;
+
+          BlobStats.Insert(Key, GetFileStats(Content, file.m_sPath, Key.m_Language, &Report.m_ScanTimings));
+          pStats = BlobStats.GetValue(Key);
+        }
+
+        TypeStats[uiFileType] += *pStats;
+      }
+
+      Report.m_TotalTime = xiiTime::Now() - scanStartTime;
+
+      SetTypeStats(TypeStats, Report);
+      LogReport(Report);
+      WriteReports(Report, Revisions.GetCount() > 1 ? sRevision : xiiStringView());
+    }
+
+    xiiLog::Info("Git: {0} Blobs counted, {1} Loose and {2} Packed Objects read, {3} Deltas resolved", BlobStats.GetCount(), Repository.GetLooseObjectReads(), Repository.GetPackedObjectReads(), Repository.GetDeltaCount());
+  }
+#endif
+
+  // Generates a synthetic source tree and measures GetFileStats() on its files and a complete scan of it
+  void RunCorpusBenchmark() const
+  {
+    auto pCmd = xiiCommandLineUtils::GetGlobalInstance();
+
+    // The corpus can be configured with '-corpusfiles', '-corpusminsize', '-corpusmaxsize' (in bytes), '-corpuslinelength',
+    // '-corpuscrlf', '-corpusnonascii' (in percent), '-corpusdepth' and '-corpusseed', see xiiLineCountCorpusDesc
+    xiiLineCountCorpusDesc desc;
+    desc.m_uiFileCount          = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-corpusfiles", (xiiInt32)desc.m_uiFileCount), 1);
+    desc.m_uiMinFileSize        = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-corpusminsize", (xiiInt32)desc.m_uiMinFileSize), 1);
+    desc.m_uiMaxFileSize        = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-corpusmaxsize", (xiiInt32)desc.m_uiMaxFileSize), (xiiInt32)desc.m_uiMinFileSize);
+    desc.m_uiLineLength         = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-corpuslinelength", (xiiInt32)desc.m_uiLineLength), 1);
+    desc.m_uiCrlfPercentage     = (xiiUInt32)xiiMath::Clamp(pCmd->GetIntOption("-corpuscrlf", (xiiInt32)desc.m_uiCrlfPercentage), 0, 100);
+    desc.m_uiNonAsciiPercentage = (xiiUInt32)xiiMath::Clamp(pCmd->GetIntOption("-corpusnonascii", (xiiInt32)desc.m_uiNonAsciiPercentage), 0, 100);
+    desc.m_uiDirectoryDepth     = (xiiUInt32)xiiMath::Max(pCmd->GetIntOption("-corpusdepth", (xiiInt32)desc.m_uiDirectoryDepth), 0);
+    desc.m_uiSeed               = (xiiUInt32)pCmd->GetIntOption("-corpusseed", (xiiInt32)desc.m_uiSeed);
+
+    // Pass '-corpusdir <dir>' to choose where the corpus is generated, by default it goes into the temp folder
+    xiiStringBuilder sRootDir = pCmd->GetStringOption("-corpusdir");
+    if (sRootDir.IsEmpty())
+    {
+      sRootDir = xiiOSFile::GetTempDataFolder();
+      sRootDir.AppendPath("LineCountCorpus");
+    }
+
+    xiiStringBuilder sCorpusDir;
+    if (GenerateCorpus(desc, sRootDir, sCorpusDir).Failed())
+    {
+      xiiLog::Error("Could not generate the corpus in '{0}'", sRootDir);
+      return;
+    }
+
+    RunFileStatsBenchmark(desc);
+
+    // The first scan warms up the file system caches, the best of the following ones is reported
+    constexpr xiiUInt32 uiRuns = 5;
+
+    xiiLineCountReport BestReport;
+
+    for (xiiUInt32 i = 0; i <= uiRuns; ++i)
+    {
+      xiiLineCountReport Report;
+      if (!ScanDirectory(sCorpusDir, false, Report))
+      {
+        xiiLog::Error("Could not search the directory '{0}'", sCorpusDir);
+        return;
+      }
+
+      if (i == 1 || (i > 1 && Report.m_TotalTime < BestReport.m_TotalTime))
+        BestReport = Report;
+    }
+
+    LogBenchmarkResult("Run", xiiLineCountScanner::GetKernelName(xiiLineCountScanner::GetKernel()), BestReport.m_Total.m_uiFileCount, BestReport.m_Total.m_uiBytes, BestReport.m_TotalTime);
+    xiiLog::Info("LineCountBenchmark: name=RunPhases threads={0} enumerate={1} read={2} validate={3} count={4}", m_uiThreads, xiiArgF(BestReport.m_EnumerateTime.GetSeconds(), 6), xiiArgF(BestReport.m_ScanTimings.m_Read.GetSeconds(), 6),
+                 xiiArgF(BestReport.m_ScanTimings.m_Validate.GetSeconds(), 6), xiiArgF(BestReport.m_ScanTimings.m_Count.GetSeconds(), 6));
+
+    WriteReports(BestReport);
+  }
+
+  virtual xiiApplication::Execution Run() override
+  {
+    if (m_sBenchmark.IsEqual_NoCase("utf8"))
+    {
+      RunUtf8Benchmark();
+      return xiiApplication::Execution::Quit;
+    }
+
+    if (!m_sMergeFiles.IsEmpty())
+    {
+      MergeShards();
+      return xiiApplication::Execution::Quit;
+    }
+
+#if XII_ENABLED(XII_SUPPORTS_FILE_ITERATORS) || defined(XII_DOCS)
+
+#  if XII_ENABLED(XII_SUPPORTS_DIRECTORY_WATCHER)
+    if (m_pDirectoryWatcher != nullptr)
+    {
+      // Nothing runs until a file changes. The wait still ends now and then, so that a request to quit isn't held up.
+      UpdateWatchedFiles(xiiTime::Milliseconds(500));
+      return xiiApplication::Execution::Continue;
+    }
+#  endif
+
+    if (m_sBenchmark.IsEqual_NoCase("corpus"))
+    {
+      RunCorpusBenchmark();
+      WriteTrace();
+      return xiiApplication::Execution::Quit;
+    }
+
+#  if XII_ENABLED(XII_SUPPORTS_MEMORY_MAPPED_FILE)
+    if (!m_sGitDir.IsEmpty())
+    {
+      ScanGitRevisions();
+      WriteTrace();
+      return xiiApplication::Execution::Quit;
+    }
+#  else
+    if (!m_sGitDir.IsEmpty())
+    {
+      xiiLog::Error("No memory-mapped file support, '-git' is not available.");
+      return xiiApplication::Execution::Quit;
+    }
+#  endif
+
+    xiiLineCountReport Report;
+    xiiDeque<FileJob>  Files;
+
+    if (ScanDirectory(m_sSearchDir, true, Report, m_bWatch ? &Files : nullptr))
+    {
+      LogReport(Report);
+      WriteReports(Report);
+      WriteTrace();
+
+      if (m_uiShardCount > 1)
+      {
+        if (Report.WriteShard(m_sShardFile, m_uiShard, m_uiShardCount).Succeeded())
+          xiiLog::Info("Shard result: '{0}'", m_sShardFile);
+        else
+          xiiLog::Error("Could not write the shard result '{0}'", m_sShardFile);
       }
 
-      xiiLog::Info("File Type: '{0}': {1} Files, {2} Lines, {3} Empty Lines, All Lines: {4}, Bytes: {5}, Non-ASCII Characters: {6}, Words: {7}", "all", AllTypes.m_uiFileCount, AllTypes.m_uiLines, AllTypes.m_uiEmptyLines, AllTypes.m_uiLines + AllTypes.m_uiEmptyLines, AllTypes.m_uiBytes,
-                   AllTypes.m_uiBytes - AllTypes.m_uiCharacters, AllTypes.m_uiWords);
+#  if XII_ENABLED(XII_SUPPORTS_DIRECTORY_WATCHER)
+      if (m_bWatch && StartWatching(Report, Files).Succeeded())
+        return xiiApplication::Execution::Continue;
+#  else
+      if (m_bWatch)
+        xiiLog::Error("No directory watcher support, '-watch' is not available.");
+#  endif
     }
     else
     {
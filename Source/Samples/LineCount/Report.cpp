@@ -0,0 +1,615 @@
+#include <LineCount/CheckedReader.h>
+#include <LineCount/Report.h>
+
+#include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/IO/JSONWriter.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+namespace
+{
+  double GetMegaBytesPerSecond(xiiUInt64 uiBytes, xiiTime duration)
+  {
+    return uiBytes / (1024.0 * 1024.0) / xiiMath::Max(duration.GetSeconds(), 0.000001);
+  }
+
+  void WriteStats(xiiStandardJSONWriter& ref_json, const FileStats& stats, bool bClassified)
+  {
+    ref_json.AddVariableUInt64("files", stats.m_uiFileCount);
+    ref_json.AddVariableUInt64("lines", stats.m_uiLines);
+    ref_json.AddVariableUInt64("emptyLines", stats.m_uiEmptyLines);
+    ref_json.AddVariableUInt64("bytes", stats.m_uiBytes);
+    ref_json.AddVariableUInt64("characters", stats.m_uiCharacters);
+    ref_json.AddVariableUInt64("nonAsciiCharacters", stats.m_uiBytes - stats.m_uiCharacters);
+    ref_json.AddVariableUInt64("words", stats.m_uiWords);
+
+    if (bClassified)
+    {
+      ref_json.AddVariableUInt64("codeLines", stats.m_uiCodeLines);
+      ref_json.AddVariableUInt64("commentLines", stats.m_uiCommentLines);
+      ref_json.AddVariableUInt64("mixedLines", stats.m_uiMixedLines);
+    }
+  }
+
+  void AppendStats(xiiStringBuilder& ref_sCsv, xiiStringView sCategory, xiiStringView sName, const FileStats& stats, bool bClassified)
+  {
+    ref_sCsv.AppendFormat("{0},{1},files,{2}\n", sCategory, sName, stats.m_uiFileCount);
+    ref_sCsv.AppendFormat("{0},{1},lines,{2}\n", sCategory, sName, stats.m_uiLines);
+    ref_sCsv.AppendFormat("{0},{1},empty_lines,{2}\n", sCategory, sName, stats.m_uiEmptyLines);
+    ref_sCsv.AppendFormat("{0},{1},bytes,{2}\n", sCategory, sName, stats.m_uiBytes);
+    ref_sCsv.AppendFormat("{0},{1},characters,{2}\n", sCategory, sName, stats.m_uiCharacters);
+    ref_sCsv.AppendFormat("{0},{1},non_ascii_characters,{2}\n", sCategory, sName, stats.m_uiBytes - stats.m_uiCharacters);
+    ref_sCsv.AppendFormat("{0},{1},words,{2}\n", sCategory, sName, stats.m_uiWords);
+
+    if (bClassified)
+    {
+      ref_sCsv.AppendFormat("{0},{1},code_lines,{2}\n", sCategory, sName, stats.m_uiCodeLines);
+      ref_sCsv.AppendFormat("{0},{1},comment_lines,{2}\n", sCategory, sName, stats.m_uiCommentLines);
+      ref_sCsv.AppendFormat("{0},{1},mixed_lines,{2}\n", sCategory, sName, stats.m_uiMixedLines);
+    }
+  }
+
+  // Paths may contain commas and quotes, unlike extensions. Returns sText, or its quoted form in ref_sStorage.
+  xiiStringView EscapeCsv(xiiStringView sText, xiiStringBuilder& ref_sStorage)
+  {
+    if (sText.FindSubString(",") == nullptr && sText.FindSubString("\"") == nullptr && sText.FindSubString("\n") == nullptr)
+      return sText;
+
+    ref_sStorage = sText;
+    ref_sStorage.ReplaceAll("\"", "\"\"");
+    ref_sStorage.Prepend("\"");
+    ref_sStorage.Append("\"");
+    return ref_sStorage;
+  }
+
+  constexpr xiiUInt32 s_uiShardMagic = 0x5253434C; // 'LCSR'
+
+  // Must be increased whenever the shard format changes, results of different versions can't be merged
+  constexpr xiiUInt32 s_uiShardVersion = 5;
+
+  // The least that a stats entry (the length of its name and the nine counters) and a slow file (the length of its path,
+  // its size and its scan time) take up in a shard result
+  constexpr xiiUInt32 s_uiMinStatsEntrySize = sizeof(xiiUInt32) + 9 * sizeof(xiiUInt64);
+  constexpr xiiUInt32 s_uiMinSlowFileSize   = sizeof(xiiUInt32) + sizeof(xiiUInt64) + sizeof(double);
+
+  void WriteShardStats(xiiStreamWriter& inout_stream, const FileStats& stats)
+  {
+    inout_stream << stats.m_uiFileCount;
+    inout_stream << stats.m_uiLines;
+    inout_stream << stats.m_uiEmptyLines;
+    inout_stream << stats.m_uiBytes;
+    inout_stream << stats.m_uiCharacters;
+    inout_stream << stats.m_uiWords;
+    inout_stream << stats.m_uiCodeLines;
+    inout_stream << stats.m_uiCommentLines;
+    inout_stream << stats.m_uiMixedLines;
+  }
+
+  void ReadShardStats(xiiLineCountCheckedReader& inout_file, FileStats& out_stats)
+  {
+    inout_file.Read(out_stats.m_uiFileCount);
+    inout_file.Read(out_stats.m_uiLines);
+    inout_file.Read(out_stats.m_uiEmptyLines);
+    inout_file.Read(out_stats.m_uiBytes);
+    inout_file.Read(out_stats.m_uiCharacters);
+    inout_file.Read(out_stats.m_uiWords);
+    inout_file.Read(out_stats.m_uiCodeLines);
+    inout_file.Read(out_stats.m_uiCommentLines);
+    inout_file.Read(out_stats.m_uiMixedLines);
+  }
+
+  // Times are stored in seconds, which keeps sub-microsecond precision for anything below a few years
+  void WriteShardTime(xiiStreamWriter& inout_stream, xiiTime time)
+  {
+    inout_stream << time.GetSeconds();
+  }
+
+  xiiTime ReadShardTime(xiiLineCountCheckedReader& inout_file)
+  {
+    double fSeconds = 0.0;
+    inout_file.Read(fSeconds);
+    return xiiTime::Seconds(fSeconds);
+  }
+
+  // The whole report is built in memory first, so the file is written in one go
+  xiiResult WriteFile(xiiStringView sFile, const void* pData, xiiUInt64 uiSize)
+  {
+    xiiFileWriter file;
+    XII_SUCCEED_OR_RETURN(file.Open(sFile));
+
+    return file.WriteBytes(pData, uiSize);
+  }
+} // namespace
+
+void xiiLineCountReport::AddSlowFile(xiiStringView sPath, xiiUInt64 uiBytes, xiiTime scanTime)
+{
+  if (m_SlowFiles.GetCount() == m_uiSlowFileCount && (m_SlowFiles.IsEmpty() || m_SlowFiles.PeekBack().m_ScanTime >= scanTime))
+    return;
+
+  // The list is short, so the position is searched linearly
+  xiiUInt32 uiIndex = 0;
+  while (uiIndex < m_SlowFiles.GetCount() && m_SlowFiles[uiIndex].m_ScanTime >= scanTime)
+  {
+    ++uiIndex;
+  }
+
+  if (m_SlowFiles.GetCount() == m_uiSlowFileCount)
+  {
+    m_SlowFiles.PopBack();
+  }
+
+  SlowFile file;
+  file.m_sPath    = sPath;
+  file.m_uiBytes  = uiBytes;
+  file.m_ScanTime = scanTime;
+  m_SlowFiles.Insert(file, uiIndex);
+}
+
+xiiResult xiiLineCountReport::WriteJson(xiiStringView sFile) const
+{
+  xiiContiguousMemoryStreamStorage storage;
+  xiiMemoryStreamWriter            writer(&storage);
+
+  xiiStandardJSONWriter json;
+  json.SetOutputStream(&writer);
+
+  json.BeginObject();
+  {
+    json.AddVariableString("searchDir", m_sSearchDir);
+    json.AddVariableUInt32("threads", m_uiThreads);
+    json.AddVariableUInt32("directories", m_uiDirectories);
+    json.AddVariableBool("classified", m_bClassified);
+
+    json.BeginObject("ignored");
+    json.AddVariableUInt32("directories", m_uiIgnoredDirectories);
+    json.AddVariableUInt64("files", m_uiIgnoredFiles);
+    json.AddVariableUInt32("ignoreFiles", m_uiIgnoreFiles);
+    json.EndObject();
+
+    json.BeginArray("fileTypes");
+    for (auto it = m_FileTypes.GetIterator(); it.IsValid(); ++it)
+    {
+      json.BeginObject();
+      json.AddVariableString("extension", it.Key());
+      WriteStats(json, it.Value(), m_bClassified);
+      json.EndObject();
+    }
+    json.EndArray();
+
+    json.BeginObject("total");
+    WriteStats(json, m_Total, m_bClassified);
+    json.EndObject();
+
+    json.BeginObject("timing");
+    json.AddVariableDouble("totalSeconds", m_TotalTime.GetSeconds());
+    json.AddVariableDouble("enumerateSeconds", m_EnumerateTime.GetSeconds());
+    json.AddVariableDouble("readSeconds", m_ScanTimings.m_Read.GetSeconds());
+    json.AddVariableDouble("hashSeconds", m_ScanTimings.m_Hash.GetSeconds());
+    json.AddVariableDouble("validateSeconds", m_ScanTimings.m_Validate.GetSeconds());
+    json.AddVariableDouble("countSeconds", m_ScanTimings.m_Count.GetSeconds());
+    json.AddVariableDouble("megaBytesPerSecond", GetMegaBytesPerSecond(m_Total.m_uiBytes, m_TotalTime));
+    json.EndObject();
+
+    if (m_uiDirectoryDepth > 0)
+    {
+      json.BeginObject("directoryStats");
+      json.AddVariableUInt32("depth", m_uiDirectoryDepth);
+      json.AddVariableDouble("seconds", m_DirectoryTime.GetSeconds());
+
+      json.BeginArray("directories");
+      for (auto it = m_DirectoryStats.GetIterator(); it.IsValid(); ++it)
+      {
+        json.BeginObject();
+        json.AddVariableString("path", it.Key());
+        WriteStats(json, it.Value(), m_bClassified);
+        json.EndObject();
+      }
+      json.EndArray();
+
+      json.EndObject();
+    }
+
+    if (m_uiSlowFileCount > 0)
+    {
+      json.BeginArray("slowestFiles");
+      for (const SlowFile& file : m_SlowFiles)
+      {
+        json.BeginObject();
+        json.AddVariableString("path", file.m_sPath);
+        json.AddVariableUInt64("bytes", file.m_uiBytes);
+        json.AddVariableDouble("seconds", file.m_ScanTime.GetSeconds());
+        json.EndObject();
+      }
+      json.EndArray();
+    }
+
+    if (m_uiArchives > 0)
+    {
+      json.BeginObject("archives");
+      json.AddVariableUInt32("archives", m_uiArchives);
+      json.AddVariableUInt64("files", m_uiArchiveFiles);
+      json.EndObject();
+    }
+
+    if (m_bUsedCache)
+    {
+      json.AddVariableUInt64("cachedFiles", m_uiCachedFiles);
+    }
+
+    if (m_bGitBlobs)
+    {
+      json.AddVariableUInt64("reusedBlobs", m_uiReusedBlobs);
+    }
+
+    if (m_bDeduplicated)
+    {
+      json.BeginObject("duplicates");
+      json.AddVariableUInt64("files", m_uiDuplicateFiles);
+      json.AddVariableUInt64("bytes", m_uiDuplicateBytes);
+      json.AddVariableDouble("savedSeconds", m_DuplicateTimeSaved.GetSeconds());
+      json.EndObject();
+    }
+
+    if (m_bPipelined)
+    {
+      json.BeginObject("pipeline");
+      json.AddVariableUInt32("maxQueueDepth", m_uiMaxQueueDepth);
+      json.AddVariableDouble("averageQueueDepth", m_fAverageQueueDepth);
+      json.AddVariableDouble("enumeratorStallSeconds", m_EnumeratorStallTime.GetSeconds());
+      json.AddVariableDouble("workerStallSeconds", m_WorkerStallTime.GetSeconds());
+      json.EndObject();
+    }
+
+    if (!m_sReadAheadBackend.IsEmpty())
+    {
+      json.BeginObject("readAhead");
+      json.AddVariableString("backend", m_sReadAheadBackend);
+      json.AddVariableUInt32("queueDepth", m_uiReadAheadQueueDepth);
+      json.AddVariableUInt32("files", m_uiReadAheadFiles);
+      json.AddVariableDouble("waitSeconds", m_ReadAheadWaitTime.GetSeconds());
+      json.EndObject();
+    }
+
+    json.BeginObject("memory");
+    json.AddVariableUInt64("scratchAllocations", m_uiScratchAllocations);
+    json.AddVariableUInt64("scratchHeapAllocations", m_uiScratchHeapAllocations);
+    json.AddVariableUInt64("scratchPeakBytes", m_uiScratchPeakBytes);
+    json.AddVariableUInt32("readBufferAllocations", m_uiReadBufferAllocations);
+    json.AddVariableUInt64("heapAllocations", m_uiHeapAllocations);
+    json.EndObject();
+  }
+  json.EndObject();
+
+  return WriteFile(sFile, storage.GetData(), storage.GetStorageSize64());
+}
+
+xiiResult xiiLineCountReport::WriteCsv(xiiStringView sFile) const
+{
+  xiiStringBuilder sCsv;
+  sCsv.Append("category,name,metric,value\n");
+
+  for (auto it = m_FileTypes.GetIterator(); it.IsValid(); ++it)
+  {
+    AppendStats(sCsv, "filetype", it.Key(), it.Value(), m_bClassified);
+  }
+
+  AppendStats(sCsv, "total", "all", m_Total, m_bClassified);
+
+  xiiStringBuilder sPath;
+  for (auto it = m_DirectoryStats.GetIterator(); it.IsValid(); ++it)
+  {
+    AppendStats(sCsv, "directory", EscapeCsv(it.Key(), sPath), it.Value(), m_bClassified);
+  }
+
+  sCsv.AppendFormat("directories,all,count,{0}\n", m_uiDirectories);
+  sCsv.AppendFormat("ignored,directories,count,{0}\n", m_uiIgnoredDirectories);
+  sCsv.AppendFormat("ignored,files,count,{0}\n", m_uiIgnoredFiles);
+  sCsv.AppendFormat("ignored,ignore_files,count,{0}\n", m_uiIgnoreFiles);
+  sCsv.AppendFormat("timing,total,seconds,{0}\n", m_TotalTime.GetSeconds());
+  sCsv.AppendFormat("timing,enumerate,seconds,{0}\n", m_EnumerateTime.GetSeconds());
+  sCsv.AppendFormat("timing,read,seconds,{0}\n", m_ScanTimings.m_Read.GetSeconds());
+  sCsv.AppendFormat("timing,hash,seconds,{0}\n", m_ScanTimings.m_Hash.GetSeconds());
+  sCsv.AppendFormat("timing,validate,seconds,{0}\n", m_ScanTimings.m_Validate.GetSeconds());
+  sCsv.AppendFormat("timing,count,seconds,{0}\n", m_ScanTimings.m_Count.GetSeconds());
+  sCsv.AppendFormat("throughput,total,megabytes_per_second,{0}\n", GetMegaBytesPerSecond(m_Total.m_uiBytes, m_TotalTime));
+
+  if (m_uiDirectoryDepth > 0)
+  {
+    sCsv.AppendFormat("timing,directories,seconds,{0}\n", m_DirectoryTime.GetSeconds());
+    sCsv.AppendFormat("directories,all,depth,{0}\n", m_uiDirectoryDepth);
+  }
+
+  for (const SlowFile& file : m_SlowFiles)
+  {
+    const xiiStringView sFile = EscapeCsv(file.m_sPath, sPath);
+    sCsv.AppendFormat("slowest,{0},bytes,{1}\n", sFile, file.m_uiBytes);
+    sCsv.AppendFormat("slowest,{0},seconds,{1}\n", sFile, file.m_ScanTime.GetSeconds());
+  }
+
+  if (m_uiArchives > 0)
+  {
+    sCsv.AppendFormat("archives,all,count,{0}\n", m_uiArchives);
+    sCsv.AppendFormat("archives,all,files,{0}\n", m_uiArchiveFiles);
+  }
+
+  if (m_bUsedCache)
+  {
+    sCsv.AppendFormat("cache,all,unchanged_files,{0}\n", m_uiCachedFiles);
+  }
+
+  if (m_bGitBlobs)
+  {
+    sCsv.AppendFormat("git,all,reused_blobs,{0}\n", m_uiReusedBlobs);
+  }
+
+  if (m_bDeduplicated)
+  {
+    sCsv.AppendFormat("duplicates,all,files,{0}\n", m_uiDuplicateFiles);
+    sCsv.AppendFormat("duplicates,all,bytes,{0}\n", m_uiDuplicateBytes);
+    sCsv.AppendFormat("duplicates,all,saved_seconds,{0}\n", m_DuplicateTimeSaved.GetSeconds());
+  }
+
+  if (m_bPipelined)
+  {
+    sCsv.AppendFormat("pipeline,queue,max_depth,{0}\n", m_uiMaxQueueDepth);
+    sCsv.AppendFormat("pipeline,queue,average_depth,{0}\n", m_fAverageQueueDepth);
+    sCsv.AppendFormat("pipeline,enumerator,stall_seconds,{0}\n", m_EnumeratorStallTime.GetSeconds());
+    sCsv.AppendFormat("pipeline,workers,stall_seconds,{0}\n", m_WorkerStallTime.GetSeconds());
+  }
+
+  if (!m_sReadAheadBackend.IsEmpty())
+  {
+    sCsv.AppendFormat("readahead,{0},queue_depth,{1}\n", m_sReadAheadBackend, m_uiReadAheadQueueDepth);
+    sCsv.AppendFormat("readahead,{0},files,{1}\n", m_sReadAheadBackend, m_uiReadAheadFiles);
+    sCsv.AppendFormat("readahead,{0},wait_seconds,{1}\n", m_sReadAheadBackend, m_ReadAheadWaitTime.GetSeconds());
+  }
+
+  sCsv.AppendFormat("memory,scratch,allocations,{0}\n", m_uiScratchAllocations);
+  sCsv.AppendFormat("memory,scratch,heap_allocations,{0}\n", m_uiScratchHeapAllocations);
+  sCsv.AppendFormat("memory,scratch,peak_bytes,{0}\n", m_uiScratchPeakBytes);
+  sCsv.AppendFormat("memory,read_buffers,heap_allocations,{0}\n", m_uiReadBufferAllocations);
+  sCsv.AppendFormat("memory,all,heap_allocations,{0}\n", m_uiHeapAllocations);
+
+  return WriteFile(sFile, sCsv.GetData(), sCsv.GetElementCount());
+}
+
+xiiResult xiiLineCountReport::WriteShard(xiiStringView sFile, xiiUInt32 uiShard, xiiUInt32 uiShardCount) const
+{
+  xiiContiguousMemoryStreamStorage storage;
+  xiiMemoryStreamWriter            writer(&storage);
+
+  writer << s_uiShardMagic;
+  writer << s_uiShardVersion;
+  writer << uiShard;
+  writer << uiShardCount;
+  XII_SUCCEED_OR_RETURN(writer.WriteString(m_sSearchDir));
+
+  writer << m_uiThreads;
+  writer << static_cast<xiiUInt64>(m_uiDirectories);
+  writer << static_cast<xiiUInt64>(m_uiIgnoredDirectories);
+  writer << m_uiIgnoredFiles;
+  writer << static_cast<xiiUInt64>(m_uiIgnoreFiles);
+
+  writer << m_FileTypes.GetCount();
+  for (auto it = m_FileTypes.GetIterator(); it.IsValid(); ++it)
+  {
+    XII_SUCCEED_OR_RETURN(writer.WriteString(it.Key()));
+    WriteShardStats(writer, it.Value());
+  }
+
+  WriteShardTime(writer, m_TotalTime);
+  WriteShardTime(writer, m_EnumerateTime);
+  WriteShardTime(writer, m_ScanTimings.m_Read);
+  WriteShardTime(writer, m_ScanTimings.m_Hash);
+  WriteShardTime(writer, m_ScanTimings.m_Validate);
+  WriteShardTime(writer, m_ScanTimings.m_Count);
+
+  writer << m_uiDirectoryDepth;
+  WriteShardTime(writer, m_DirectoryTime);
+
+  writer << m_DirectoryStats.GetCount();
+  for (auto it = m_DirectoryStats.GetIterator(); it.IsValid(); ++it)
+  {
+    XII_SUCCEED_OR_RETURN(writer.WriteString(it.Key()));
+    WriteShardStats(writer, it.Value());
+  }
+
+  writer << m_uiSlowFileCount;
+  writer << m_SlowFiles.GetCount();
+  for (const SlowFile& file : m_SlowFiles)
+  {
+    XII_SUCCEED_OR_RETURN(writer.WriteString(file.m_sPath));
+    writer << file.m_uiBytes;
+    WriteShardTime(writer, file.m_ScanTime);
+  }
+
+  writer << static_cast<xiiUInt64>(m_uiArchives);
+  writer << m_uiArchiveFiles;
+
+  writer << m_bUsedCache;
+  writer << m_uiCachedFiles;
+
+  writer << m_bDeduplicated;
+  writer << m_uiDuplicateFiles;
+  writer << m_uiDuplicateBytes;
+  WriteShardTime(writer, m_DuplicateTimeSaved);
+
+  writer << m_bClassified;
+
+  return WriteFile(sFile, storage.GetData(), storage.GetStorageSize64());
+}
+
+xiiResult xiiLineCountReport::ReadShard(xiiStringView sFile, xiiUInt32& out_uiShard, xiiUInt32& out_uiShardCount)
+{
+  *this = xiiLineCountReport();
+
+  // The shard results come from other processes, possibly from other machines, so nothing in them is trusted. Each section
+  // is checked before its content is used, and every count has to fit into the rest of the file.
+  xiiLineCountCheckedReader file;
+  XII_SUCCEED_OR_RETURN(file.Open(sFile));
+
+  xiiUInt32 uiMagic   = 0;
+  xiiUInt32 uiVersion = 0;
+  file.Read(uiMagic);
+  file.Read(uiVersion);
+
+  if (uiMagic != s_uiShardMagic || uiVersion != s_uiShardVersion)
+    return XII_FAILURE;
+
+  file.Read(out_uiShard);
+  file.Read(out_uiShardCount);
+
+  // Whoever merges the shards keeps track of them by index
+  if (file.HasFailed() || out_uiShardCount > MaxShardCount || out_uiShard >= out_uiShardCount)
+    return XII_FAILURE;
+
+  xiiStringBuilder sString;
+  file.ReadString(sString);
+  m_sSearchDir = sString;
+
+  xiiUInt64 uiDirectories        = 0;
+  xiiUInt64 uiIgnoredDirectories = 0;
+  xiiUInt64 uiIgnoreFiles        = 0;
+  file.Read(m_uiThreads);
+  file.Read(uiDirectories);
+  file.Read(uiIgnoredDirectories);
+  file.Read(m_uiIgnoredFiles);
+  file.Read(uiIgnoreFiles);
+
+  m_uiDirectories        = static_cast<xiiUInt32>(uiDirectories);
+  m_uiIgnoredDirectories = static_cast<xiiUInt32>(uiIgnoredDirectories);
+  m_uiIgnoreFiles        = static_cast<xiiUInt32>(uiIgnoreFiles);
+
+  const xiiUInt32 uiFileTypes = file.ReadCount(s_uiMinStatsEntrySize);
+
+  for (xiiUInt32 i = 0; i < uiFileTypes; ++i)
+  {
+    file.ReadString(sString);
+
+    FileStats& stats = m_FileTypes[sString];
+    ReadShardStats(file, stats);
+    m_Total += stats;
+  }
+
+  if (file.HasFailed())
+    return XII_FAILURE;
+
+  m_TotalTime              = ReadShardTime(file);
+  m_EnumerateTime          = ReadShardTime(file);
+  m_ScanTimings.m_Read     = ReadShardTime(file);
+  m_ScanTimings.m_Hash     = ReadShardTime(file);
+  m_ScanTimings.m_Validate = ReadShardTime(file);
+  m_ScanTimings.m_Count    = ReadShardTime(file);
+
+  file.Read(m_uiDirectoryDepth);
+  m_DirectoryTime = ReadShardTime(file);
+
+  const xiiUInt32 uiDirectoryStats = file.ReadCount(s_uiMinStatsEntrySize);
+
+  for (xiiUInt32 i = 0; i < uiDirectoryStats; ++i)
+  {
+    file.ReadString(sString);
+    ReadShardStats(file, m_DirectoryStats[sString]);
+  }
+
+  if (file.HasFailed())
+    return XII_FAILURE;
+
+  file.Read(m_uiSlowFileCount);
+  const xiiUInt32 uiSlowFiles = file.ReadCount(s_uiMinSlowFileSize);
+
+  // Merge() relies on never keeping more slow files than m_uiSlowFileCount
+  if (file.HasFailed() || uiSlowFiles > m_uiSlowFileCount)
+    return XII_FAILURE;
+
+  m_SlowFiles.Reserve(uiSlowFiles);
+
+  for (xiiUInt32 i = 0; i < uiSlowFiles; ++i)
+  {
+    file.ReadString(sString);
+
+    SlowFile& slowFile = m_SlowFiles.ExpandAndGetRef();
+    file.Read(slowFile.m_uiBytes);
+    slowFile.m_sPath    = sString;
+    slowFile.m_ScanTime = ReadShardTime(file);
+  }
+
+  if (file.HasFailed())
+    return XII_FAILURE;
+
+  xiiUInt64 uiArchives = 0;
+  file.Read(uiArchives);
+  file.Read(m_uiArchiveFiles);
+
+  m_uiArchives = static_cast<xiiUInt32>(uiArchives);
+
+  file.Read(m_bUsedCache);
+  file.Read(m_uiCachedFiles);
+
+  file.Read(m_bDeduplicated);
+  file.Read(m_uiDuplicateFiles);
+  file.Read(m_uiDuplicateBytes);
+  m_DuplicateTimeSaved = ReadShardTime(file);
+
+  file.Read(m_bClassified);
+
+  // Anything after the last value means the file is not what it claims to be
+  if (file.HasFailed() || file.GetRemainingBytes() > 0)
+    return XII_FAILURE;
+
+  return XII_SUCCESS;
+}
+
+void xiiLineCountReport::Merge(const xiiLineCountReport& other)
+{
+  if (m_sSearchDir.IsEmpty())
+    m_sSearchDir = other.m_sSearchDir;
+
+  m_uiThreads += other.m_uiThreads;
+
+  // Every shard walks the whole tree and reads the same ignore files, but only counts its own part of it
+  m_uiDirectories += other.m_uiDirectories;
+  m_uiIgnoredDirectories += other.m_uiIgnoredDirectories;
+  m_uiIgnoredFiles += other.m_uiIgnoredFiles;
+  m_uiIgnoreFiles = xiiMath::Max(m_uiIgnoreFiles, other.m_uiIgnoreFiles);
+
+  for (auto it = other.m_FileTypes.GetIterator(); it.IsValid(); ++it)
+  {
+    m_FileTypes[it.Key()] += it.Value();
+  }
+
+  m_Total += other.m_Total;
+
+  m_TotalTime     = xiiMath::Max(m_TotalTime, other.m_TotalTime);
+  m_EnumerateTime = xiiMath::Max(m_EnumerateTime, other.m_EnumerateTime);
+  m_ScanTimings += other.m_ScanTimings;
+
+  // Every shard has all directories, each with the stats of its own files in them
+  m_uiDirectoryDepth = xiiMath::Max(m_uiDirectoryDepth, other.m_uiDirectoryDepth);
+  m_DirectoryTime    = xiiMath::Max(m_DirectoryTime, other.m_DirectoryTime);
+
+  for (auto it = other.m_DirectoryStats.GetIterator(); it.IsValid(); ++it)
+  {
+    m_DirectoryStats[it.Key()] += it.Value();
+  }
+
+  m_uiSlowFileCount = xiiMath::Max(m_uiSlowFileCount, other.m_uiSlowFileCount);
+  for (const SlowFile& file : other.m_SlowFiles)
+  {
+    AddSlowFile(file.m_sPath, file.m_uiBytes, file.m_ScanTime);
+  }
+
+  m_uiArchives += other.m_uiArchives;
+  m_uiArchiveFiles += other.m_uiArchiveFiles;
+
+  m_bUsedCache = m_bUsedCache || other.m_bUsedCache;
+  m_uiCachedFiles += other.m_uiCachedFiles;
+
+  // Each shard only finds the duplicates within its own files
+  m_bDeduplicated = m_bDeduplicated || other.m_bDeduplicated;
+  m_uiDuplicateFiles += other.m_uiDuplicateFiles;
+  m_uiDuplicateBytes += other.m_uiDuplicateBytes;
+  m_DuplicateTimeSaved += other.m_DuplicateTimeSaved;
+
+  m_bClassified = m_bClassified || other.m_bClassified;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <LineCount/FileStats.h>
+
+#include <Foundation/Containers/DynamicArray.h>
+
+// Everything that LineCount found out in one run, for writing machine-readable reports.
+struct xiiLineCountReport
+{
+  // The most processes that a run can be split into with '-shard i/N'
+  static constexpr xiiUInt32 MaxShardCount = 1024;
+
+  struct SlowFile
+  {
+    xiiString m_sPath;
+    xiiUInt64 m_uiBytes = 0;
+    xiiTime   m_ScanTime; // Of the worker that scanned it, including reading, unless the file was read ahead
+  };
+
+  xiiString        m_sSearchDir;
+  xiiUInt32        m_uiThreads            = 1;
+  xiiUInt32        m_uiDirectories        = 0;
+  xiiUInt32        m_uiIgnoredDirectories = 0; // Skipped with all their content, these are not part of m_uiDirectories
+  xiiUInt64        m_uiIgnoredFiles       = 0;
+  xiiUInt32        m_uiIgnoreFiles        = 0; // How many .gitignore and .ignore files were read
+  bool             m_bClassified          = false; // With '-classify', whether the lines were classified as code, comment or mixed
+  FileTypeStatsMap m_FileTypes;
+  FileStats        m_Total;
+
+  xiiTime     m_TotalTime;     // Wall-clock time of enumerating and scanning
+  xiiTime     m_EnumerateTime; // Time the enumerating thread spent iterating over directories
+  ScanTimings m_ScanTimings;   // Summed over all worker threads
+
+  xiiUInt32        m_uiDirectoryDepth = 0; // With '-dirdepth N', how many levels below the search directory have their own stats
+  FileTypeStatsMap m_DirectoryStats;       // By path relative to the search directory, each including all of its subdirectories
+  xiiTime          m_DirectoryTime;        // Wall-clock time of summing up the directories after scanning
+
+  xiiUInt32                 m_uiSlowFileCount = 0; // With '-slowest N', how many of the slowest files are kept
+  xiiDynamicArray<SlowFile> m_SlowFiles;           // Slowest first
+
+  xiiUInt32 m_uiArchives     = 0; // With '-archives', how many archives were opened
+  xiiUInt64 m_uiArchiveFiles = 0; // The files that were counted in them, these are part of the stats per file type
+
+  bool      m_bUsedCache    = false; // Whether the stats of a previous run were available
+  xiiUInt64 m_uiCachedFiles = 0;     // How many files were unchanged since the previous run
+
+  bool      m_bGitBlobs     = false; // Whether the files were read from a git revision ('-git'), which is never sharded
+  xiiUInt64 m_uiReusedBlobs = 0;     // How many files had a blob that was already counted, in this or an earlier revision
+
+  bool      m_bDeduplicated    = false; // Whether files with identical content were only counted once
+  xiiUInt64 m_uiDuplicateFiles = 0;
+  xiiUInt64 m_uiDuplicateBytes = 0;
+  xiiTime   m_DuplicateTimeSaved; // How long counting the duplicates would have taken, going by their originals
+
+  bool      m_bPipelined         = false; // Whether files were scanned on worker threads while enumerating
+  xiiUInt32 m_uiMaxQueueDepth    = 0;
+  double    m_fAverageQueueDepth = 0.0;
+  xiiTime   m_EnumeratorStallTime;
+  xiiTime   m_WorkerStallTime; // Summed over all worker threads
+
+  xiiString m_sReadAheadBackend;         // How files were read ahead of the workers ('io_uring' or 'threads'), empty if they were not
+  xiiUInt32 m_uiReadAheadQueueDepth = 0; // How many files were read at the same time
+  xiiUInt32 m_uiReadAheadFiles      = 0;
+  xiiTime   m_ReadAheadWaitTime; // Time the enumerating thread waited for reads to complete
+
+  xiiUInt64 m_uiScratchAllocations     = 0; // Served by the scratch arenas of the workers, which are reset after every file
+  xiiUInt64 m_uiScratchHeapAllocations = 0; // Blocks that the arenas allocated for that, this stops growing once the largest file was seen
+  xiiUInt64 m_uiScratchPeakBytes       = 0; // The most scratch memory that a single file needed
+  xiiUInt32 m_uiReadBufferAllocations  = 0; // Read-ahead buffers that had to be allocated or grown, instead of being reused
+  xiiUInt64 m_uiHeapAllocations        = 0; // Of the default allocator while scanning, including the enumeration. Zero if allocations are not tracked.
+
+  // Writes the report as a JSON object with the stats per file type (and directory), the total stats and the timings.
+  xiiResult WriteJson(xiiStringView sFile) const;
+
+  // Keeps the file if it is one of the m_uiSlowFileCount slowest ones so far
+  void AddSlowFile(xiiStringView sPath, xiiUInt64 uiBytes, xiiTime scanTime);
+
+  // Writes the report as CSV with the columns 'category,name,metric,value', one row per value.
+  // This keeps stats and timings in one table that can be loaded without knowing the file types up front.
+  xiiResult WriteCsv(xiiStringView sFile) const;
+
+  // Writes the result of one shard of a run that was split over several processes ('-shard i/N') in a compact binary
+  // format. All counters are stored with 64 bits. Pipeline, read-ahead and memory details are not stored, they only
+  // describe the individual processes.
+  xiiResult WriteShard(xiiStringView sFile, xiiUInt32 uiShard, xiiUInt32 uiShardCount) const;
+
+  // Replaces the report with a result that was written by WriteShard(). Fails if the file is not a valid shard result.
+  xiiResult ReadShard(xiiStringView sFile, xiiUInt32& out_uiShard, xiiUInt32& out_uiShardCount);
+
+  // Adds the result of another shard. Counters and the times that are summed over all workers are added up. The shards
+  // run at the same time, so for the wall-clock times the longest one is kept.
+  void Merge(const xiiLineCountReport& other);
+};
@@ -0,0 +1,490 @@
+#include <LineCount/Scanner.h>
+#include <LineCount/Simd.h>
+#include <LineCount/Utf8Validator.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Strings/StringUtils.h>
+#include <Foundation/Strings/UnicodeUtils.h>
+
+namespace
+{
+  constexpr xiiUInt32 s_uiBlockSize = 32;
+
+  // The classification of one block of s_uiBlockSize bytes, one bit per byte
+  struct BlockMasks
+  {
+    xiiUInt32 m_uiNonAscii;
+    xiiUInt32 m_uiNewlines;
+    xiiUInt32 m_uiCarriageReturns;
+    xiiUInt32 m_uiBlanks;
+    xiiUInt32 m_uiIdentifiers;
+
+    xiiLineCountLexer::ClassMasks m_LexerClasses;
+  };
+
+  using ClassifyBlockFunc = void (*)(const xiiUInt8* pData, BlockMasks& out_masks);
+
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+
+  // Classifies 16 bytes. Only the masks for ASCII bytes are meaningful, the signed compares misclassify everything else.
+  XII_ALWAYS_INLINE void ClassifySSE2(__m128i v, xiiUInt32& out_uiNonAscii, xiiUInt32& out_uiNewlines, xiiUInt32& out_uiCarriageReturns, xiiUInt32& out_uiBlanks, xiiUInt32& out_uiIdentifiers)
+  {
+    const __m128i lower   = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), lower));
+    const __m128i digits  = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    const __m128i blanks  = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+
+    out_uiNonAscii        = (xiiUInt32)_mm_movemask_epi8(v);
+    out_uiNewlines        = (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    out_uiCarriageReturns = (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+    out_uiBlanks          = (xiiUInt32)_mm_movemask_epi8(blanks);
+    out_uiIdentifiers     = (xiiUInt32)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letters, digits), _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))));
+  }
+
+  // Finds the special characters of xiiLineCountLexer in 16 bytes and adds them to the masks at the given bit offset
+  XII_ALWAYS_INLINE void ClassifyLexerSSE2(__m128i v, xiiUInt32 uiShift, xiiLineCountLexer::ClassMasks& ref_masks)
+  {
+    ref_masks.m_uiSlashes |= (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('/'))) << uiShift;
+    ref_masks.m_uiStars |= (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('*'))) << uiShift;
+    ref_masks.m_uiDoubleQuotes |= (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << uiShift;
+    ref_masks.m_uiSingleQuotes |= (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\''))) << uiShift;
+    ref_masks.m_uiBackslashes |= (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << uiShift;
+    ref_masks.m_uiBrackets |= (xiiUInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('['))) << uiShift;
+  }
+
+  // Without the lexer, its masks are left alone
+  template <bool Lexer>
+  void ClassifyBlockSSE2(const xiiUInt8* pData, BlockMasks& out_masks)
+  {
+    xiiUInt32 uiNonAscii[2], uiNewlines[2], uiCarriageReturns[2], uiBlanks[2], uiIdentifiers[2];
+
+    if constexpr (Lexer)
+    {
+      out_masks.m_LexerClasses = {};
+    }
+
+    for (xiiUInt32 i = 0; i < 2; ++i)
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i * 16));
+      ClassifySSE2(v, uiNonAscii[i], uiNewlines[i], uiCarriageReturns[i], uiBlanks[i], uiIdentifiers[i]);
+
+      if constexpr (Lexer)
+      {
+        ClassifyLexerSSE2(v, i * 16, out_masks.m_LexerClasses);
+      }
+    }
+
+    out_masks.m_uiNonAscii        = uiNonAscii[0] | (uiNonAscii[1] << 16);
+    out_masks.m_uiNewlines        = uiNewlines[0] | (uiNewlines[1] << 16);
+    out_masks.m_uiCarriageReturns = uiCarriageReturns[0] | (uiCarriageReturns[1] << 16);
+    out_masks.m_uiBlanks          = uiBlanks[0] | (uiBlanks[1] << 16);
+    out_masks.m_uiIdentifiers     = uiIdentifiers[0] | (uiIdentifiers[1] << 16);
+  }
+
+  template <bool Lexer>
+  XII_LINECOUNT_AVX2_FUNCTION void ClassifyBlockAVX2(const xiiUInt8* pData, BlockMasks& out_masks)
+  {
+    const __m256i v       = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData));
+    const __m256i lower   = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    const __m256i digits  = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    const __m256i blanks  = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+
+    out_masks.m_uiNonAscii        = (xiiUInt32)_mm256_movemask_epi8(v);
+    out_masks.m_uiNewlines        = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    out_masks.m_uiCarriageReturns = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+    out_masks.m_uiBlanks          = (xiiUInt32)_mm256_movemask_epi8(blanks);
+    out_masks.m_uiIdentifiers     = (xiiUInt32)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letters, digits), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'))));
+
+    if constexpr (Lexer)
+    {
+      out_masks.m_LexerClasses.m_uiSlashes      = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+      out_masks.m_LexerClasses.m_uiStars        = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')));
+      out_masks.m_LexerClasses.m_uiDoubleQuotes = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+      out_masks.m_LexerClasses.m_uiSingleQuotes = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\'')));
+      out_masks.m_LexerClasses.m_uiBackslashes  = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+      out_masks.m_LexerClasses.m_uiBrackets     = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')));
+    }
+  }
+
+#endif
+
+  // The SIMD kernels hard-code the identifier characters, make sure they agree with xiiStringUtils
+  bool IsAsciiClassificationSupported()
+  {
+    for (xiiUInt32 c = 0; c < 128; ++c)
+    {
+      const xiiUInt32 lower       = c | 0x20;
+      const bool      bIdentifier = (lower >= 'a' && lower <= 'z') || (c >= '0' && c <= '9') || c == '_';
+
+      if (xiiStringUtils::IsIdentifierDelimiter_C_Code(c) == bIdentifier)
+        return false;
+    }
+
+    return true;
+  }
+
+  xiiLineCountScanner::Kernel DetectBestKernel()
+  {
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+    if (IsAsciiClassificationSupported())
+    {
+      return IsAVX2Supported() ? xiiLineCountScanner::Kernel::AVX2 : xiiLineCountScanner::Kernel::SSE2;
+    }
+#endif
+
+    return xiiLineCountScanner::Kernel::Scalar;
+  }
+
+  xiiLineCountScanner::Kernel GetBestKernel()
+  {
+    static const xiiLineCountScanner::Kernel s_BestKernel = DetectBestKernel();
+    return s_BestKernel;
+  }
+
+  xiiLineCountScanner::Kernel& GetKernelStorage()
+  {
+    static xiiLineCountScanner::Kernel s_Kernel = GetBestKernel();
+    return s_Kernel;
+  }
+
+  // Text that isn't lexed doesn't need the masks of the lexer, which saves six compares per block
+  ClassifyBlockFunc GetClassifyBlockFunc(bool bLexer)
+  {
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+    switch (GetKernelStorage())
+    {
+      case xiiLineCountScanner::Kernel::SSE2:
+        return bLexer ? &ClassifyBlockSSE2<true> : &ClassifyBlockSSE2<false>;
+      case xiiLineCountScanner::Kernel::AVX2:
+        return bLexer ? &ClassifyBlockAVX2<true> : &ClassifyBlockAVX2<false>;
+      default:
+        break;
+    }
+#endif
+
+    return nullptr;
+  }
+} // namespace
+
+xiiLineCountScanner::Kernel xiiLineCountScanner::GetKernel()
+{
+  return GetKernelStorage();
+}
+
+void xiiLineCountScanner::SetKernel(Kernel kernel)
+{
+  // The kernels are ordered by the CPU features that they need, anything up to the best one is supported
+  GetKernelStorage() = (xiiUInt32)kernel <= (xiiUInt32)GetBestKernel() ? kernel : GetBestKernel();
+}
+
+const char* xiiLineCountScanner::GetKernelName(Kernel kernel)
+{
+  switch (kernel)
+  {
+    case Kernel::SSE2:
+      return "SSE2";
+    case Kernel::AVX2:
+      return "AVX2";
+    default:
+      return "Scalar";
+  }
+}
+
+xiiLineCountScanner::xiiLineCountScanner()
+{
+  Reset();
+}
+
+void xiiLineCountScanner::SetLanguage(xiiLineCountLanguage language)
+{
+  // Telling comments from code costs a good part of the throughput, so plain text doesn't pay for it. Every non-empty
+  // line of it is code, which the line count already says.
+  m_Language  = language;
+  m_bRunLexer = language != xiiLineCountLanguage::Text && language != xiiLineCountLanguage::None;
+
+  m_Lexer.SetLanguage(language);
+}
+
+void xiiLineCountScanner::Reset()
+{
+  m_uiLines           = 0;
+  m_uiEmptyLines      = 0;
+  m_uiBytes           = 0;
+  m_uiCarriageReturns = 0;
+  m_uiWords           = 0;
+
+  m_bLineHasContent  = false;
+  m_bPendingBlank    = false;
+  m_bLastIsDelimiter = false;
+
+  m_Lexer.Reset();
+}
+
+void xiiLineCountScanner::Process(xiiArrayPtr<const xiiUInt8> text)
+{
+  const char* szPos = reinterpret_cast<const char*>(text.GetPtr());
+  const char* szEnd = szPos + text.GetCount();
+
+  if (ClassifyBlockFunc classifyBlock = GetClassifyBlockFunc(m_bRunLexer))
+  {
+    BlockMasks masks;
+
+    while (static_cast<xiiUInt64>(szEnd - szPos) >= s_uiBlockSize)
+    {
+      classifyBlock(reinterpret_cast<const xiiUInt8*>(szPos), masks);
+
+      // Carriage returns are invisible. Right in front of a newline they behave exactly like a trailing blank,
+      // anywhere else (including the end of the block) the scalar path has to deal with them.
+      const bool bOnlyCRLF = (masks.m_uiCarriageReturns & ~(masks.m_uiNewlines >> 1)) == 0;
+
+      if (masks.m_uiNonAscii == 0 && bOnlyCRLF)
+      {
+        const xiiUInt32 uiCarriageReturns = xiiMath::CountBits(masks.m_uiCarriageReturns);
+        m_uiBytes += s_uiBlockSize - uiCarriageReturns;
+        m_uiCarriageReturns += uiCarriageReturns;
+
+        ProcessAsciiBlock(masks.m_uiNewlines, masks.m_uiBlanks | masks.m_uiCarriageReturns, masks.m_uiIdentifiers);
+
+        if (m_bRunLexer)
+        {
+          const xiiUInt32 uiContent = ~(masks.m_uiNewlines | masks.m_uiBlanks | masks.m_uiCarriageReturns);
+          m_Lexer.ProcessAsciiBlock(reinterpret_cast<const xiiUInt8*>(szPos), masks.m_uiNewlines, uiContent, masks.m_uiCarriageReturns, masks.m_LexerClasses);
+        }
+
+        szPos += s_uiBlockSize;
+      }
+      else
+      {
+        // A Utf-8 sequence may reach into the next block, so this may stop a few bytes after the block
+        ProcessScalar(szPos, szEnd, szPos + s_uiBlockSize);
+      }
+    }
+  }
+
+  ProcessScalar(szPos, szEnd, szEnd);
+}
+
+void xiiLineCountScanner::ProcessScalar(const char*& ref_szPos, const char* szEnd, const char* szStop)
+{
+  const char* szPos = ref_szPos;
+
+  while (szPos < szStop)
+  {
+    const xiiUInt8 c = static_cast<xiiUInt8>(*szPos);
+
+    switch (c)
+    {
+      case '\r':
+        ++szPos;
+        ++m_uiCarriageReturns;
+        break;
+
+      case '\n':
+        ++szPos;
+        ++m_uiBytes;
+        EndLine();
+
+        if (m_bRunLexer)
+          m_Lexer.ProcessByte(c);
+        break;
+
+      case ' ':
+      case '\t':
+        ++szPos;
+        ++m_uiBytes;
+
+        // Blanks at the start of a line are trimmed away, blanks at the end only count once the line continues
+        m_bPendingBlank = m_bLineHasContent;
+
+        if (m_bRunLexer)
+          m_Lexer.ProcessByte(c);
+        break;
+
+      default:
+        if (c < 0x80)
+        {
+          ++szPos;
+          ++m_uiBytes;
+          ProcessCharacter(xiiStringUtils::IsIdentifierDelimiter_C_Code(c));
+
+          if (m_bRunLexer)
+            m_Lexer.ProcessByte(c);
+        }
+        else
+        {
+          XII_ASSERT_DEBUG(szPos < szEnd, "Invalid Utf-8 sequence");
+
+          const char* szStart = szPos;
+          ProcessCharacter(xiiStringUtils::IsIdentifierDelimiter_C_Code(xiiUnicodeUtils::DecodeUtf8ToUtf32(szPos)));
+          m_uiBytes += static_cast<xiiUInt32>(szPos - szStart);
+
+          if (m_bRunLexer)
+            m_Lexer.ProcessOther();
+        }
+        break;
+    }
+  }
+
+  ref_szPos = szPos;
+}
+
+void xiiLineCountScanner::ProcessAsciiBlock(xiiUInt32 uiNewlines, xiiUInt32 uiBlanks, xiiUInt32 uiIdentifiers)
+{
+  xiiUInt32 uiSegmentStart = 0;
+
+  // Every newline splits the block into the end of one line and the start of the next one
+  while (uiNewlines != 0)
+  {
+    const xiiUInt32 uiNewline = xiiMath::FirstBitLow(uiNewlines);
+
+    ProcessSegment(uiSegmentStart, uiNewline, uiBlanks, uiIdentifiers);
+    EndLine();
+
+    uiSegmentStart = uiNewline + 1;
+    uiNewlines &= uiNewlines - 1;
+  }
+
+  ProcessSegment(uiSegmentStart, s_uiBlockSize, uiBlanks, uiIdentifiers);
+}
+
+void xiiLineCountScanner::ProcessSegment(xiiUInt32 uiStart, xiiUInt32 uiEnd, xiiUInt32 uiBlanks, xiiUInt32 uiIdentifiers)
+{
+  if (uiStart == uiEnd)
+    return;
+
+  const xiiUInt64 uiSegmentMask = ((xiiUInt64(1) << uiEnd) - 1) & ~((xiiUInt64(1) << uiStart) - 1);
+  const xiiUInt32 uiContent     = static_cast<xiiUInt32>(uiSegmentMask) & ~uiBlanks;
+
+  if (uiContent == 0)
+  {
+    m_bPendingBlank = m_bLineHasContent;
+    return;
+  }
+
+  const xiiUInt32 uiFirst = xiiMath::FirstBitLow(uiContent);
+  const xiiUInt32 uiLast  = xiiMath::FirstBitHigh(uiContent);
+
+  // The first character continues whatever came before it, just like in the scalar path
+  if (uiFirst > uiStart && m_bLineHasContent)
+    m_bPendingBlank = true;
+
+  ProcessCharacter((uiIdentifiers & (1u << uiFirst)) == 0);
+
+  // Within the trimmed part of the segment blanks are delimiters, so every change of the identifier bit is a word boundary
+  const xiiUInt64 uiInnerMask  = ((xiiUInt64(2) << uiLast) - 1) & ~((xiiUInt64(2) << uiFirst) - 1);
+  const xiiUInt32 uiBoundaries = (uiIdentifiers ^ (uiIdentifiers << 1)) & static_cast<xiiUInt32>(uiInnerMask);
+  m_uiWords += xiiMath::CountBits(uiBoundaries);
+
+  m_bLastIsDelimiter = (uiIdentifiers & (1u << uiLast)) == 0;
+  m_bPendingBlank    = uiLast + 1 < uiEnd;
+}
+
+void xiiLineCountScanner::Finish(FileStats& inout_stats, xiiUInt64 uiCodePoints)
+{
+  // Text that contains anything at all always has one more line than it has line breaks
+  if (m_uiBytes > 0)
+    EndLine();
+
+  inout_stats.m_uiLines += m_uiLines;
+  inout_stats.m_uiEmptyLines += m_uiEmptyLines;
+  inout_stats.m_uiBytes += m_uiBytes;
+  inout_stats.m_uiCharacters += uiCodePoints - m_uiCarriageReturns;
+  inout_stats.m_uiWords += m_uiWords;
+
+  if (m_bRunLexer)
+    m_Lexer.Finish(inout_stats);
+  else if (m_Language == xiiLineCountLanguage::Text)
+    inout_stats.m_uiCodeLines += m_uiLines;
+
+  Reset();
+}
+
+void xiiLineCountScanner::ProcessCharacter(bool bIsDelimiter)
+{
+  if (!m_bLineHasContent)
+  {
+    // A line is treated as if it was preceded by an identifier character
+    m_bLineHasContent = true;
+
+    if (bIsDelimiter)
+      ++m_uiWords;
+  }
+  else if (m_bPendingBlank)
+  {
+    // The blanks are delimiters themselves, so there may be a change before and after them
+    m_bPendingBlank = false;
+
+    if (!m_bLastIsDelimiter)
+      ++m_uiWords;
+    if (!bIsDelimiter)
+      ++m_uiWords;
+  }
+  else if (m_bLastIsDelimiter != bIsDelimiter)
+  {
+    ++m_uiWords;
+  }
+
+  m_bLastIsDelimiter = bIsDelimiter;
+}
+
+void xiiLineCountScanner::EndLine()
+{
+  if (m_bLineHasContent)
+    ++m_uiLines;
+  else
+    ++m_uiEmptyLines;
+
+  m_bLineHasContent  = false;
+  m_bPendingBlank    = false;
+  m_bLastIsDelimiter = false;
+}
+
+FileStats GetFileStats(xiiArrayPtr<const xiiUInt8> content, const char* szFile, xiiLineCountLanguage language, ScanTimings* pTimings)
+{
+  FileStats s;
+
+  // Validate the content and find its end (the first zero byte, if any) in one pass
+  const xiiTime validateStartTime = pTimings ? xiiTime::Now() : xiiTime();
+
+  xiiLineCountUtf8Validator validator;
+  xiiUInt32                 uiLength = 0;
+  bool                      bValid   = false;
+
+  {
+    XII_PROFILE_SCOPE("Validate");
+    uiLength = validator.Process(content);
+    bValid   = validator.Finish();
+  }
+
+  const xiiTime countStartTime = pTimings ? xiiTime::Now() : xiiTime();
+
+  if (pTimings)
+  {
+    pTimings->m_Validate += countStartTime - validateStartTime;
+  }
+
+  if (!bValid)
+  {
+    xiiLog::Warning("File is not valid Utf-8: '{0}'", szFile);
+    return s;
+  }
+
+  {
+    XII_PROFILE_SCOPE("Count");
+
+    xiiLineCountScanner scanner;
+    scanner.SetLanguage(language);
+    scanner.Process(content.GetSubArray(0, uiLength));
+    scanner.Finish(s, validator.GetCodePointCount());
+  }
+
+  if (pTimings)
+  {
+    pTimings->m_Count += xiiTime::Now() - countStartTime;
+  }
+
+  return s;
+}
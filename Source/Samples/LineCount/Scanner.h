@@ -0,0 +1,86 @@
+#pragma once
+
+#include <LineCount/FileStats.h>
+#include <LineCount/Lexer.h>
+
+#include <Foundation/Types/ArrayPtr.h>
+
+// Counts lines, empty lines, words and bytes of Utf-8 text in a single pass, without any allocations.
+// Characters are counted by xiiLineCountUtf8Validator while it validates the text.
+// In the same pass, xiiLineCountLexer classifies the non-empty lines as code, comment or mixed. It only runs for languages
+// with comments: plain text is all code, and xiiLineCountLanguage::None isn't classified at all.
+//
+// The counting rules are:
+//  * Carriage returns are ignored entirely, they don't count as bytes, characters or word delimiters.
+//  * Non-empty text consists of one line more than it contains '\n' characters. Text without any bytes (other than '\r') has no lines at all.
+//  * Leading and trailing spaces and tabs are not part of a line. A line that is empty after that is an empty line.
+//  * Within a line, every change between identifier characters and delimiters (see xiiStringUtils::IsIdentifierDelimiter_C_Code)
+//    counts as one word. A line that starts with a delimiter counts that first run of delimiters as a word as well.
+//
+// The scanner is a state machine, so the text may be passed in through several calls to Process(), as long as
+// every call contains only complete Utf-8 sequences.
+//
+// Pure ASCII text is classified 32 bytes at a time with SIMD instructions (SSE2, or AVX2 if the CPU supports it).
+// This yields bitmasks of newlines, blanks and identifier characters, from which lines and words are counted via
+// popcounts over the transitions. Everything else (non-ASCII characters, lone carriage returns) goes through
+// the scalar path, which decodes every character, so the results are always identical.
+class xiiLineCountScanner
+{
+public:
+  // The implementations that are available for classifying the text
+  enum class Kernel
+  {
+    Scalar,
+    SSE2,
+    AVX2,
+  };
+
+  // Returns the kernel that is currently used. By default this is the fastest one that the CPU supports.
+  static Kernel GetKernel();
+
+  // Allows to choose a different kernel, e.g. for benchmarking. Falls back to the best supported kernel, if the requested one is not available.
+  static void SetKernel(Kernel kernel);
+
+  // Returns a readable name for the given kernel.
+  static const char* GetKernelName(Kernel kernel);
+
+  xiiLineCountScanner();
+
+  // Sets the language of the text, which decides what counts as a comment. The default is xiiLineCountLanguage::None.
+  void SetLanguage(xiiLineCountLanguage language);
+
+  // Resets all counters and the state, so that the next file can be scanned.
+  void Reset();
+
+  // Scans the given text, which must be valid Utf-8.
+  void Process(xiiArrayPtr<const xiiUInt8> text);
+
+  // Finishes the last line and adds the counters of the scanned text to the given stats.
+  // uiCodePoints is the number of code points in the text, as counted by xiiLineCountUtf8Validator.
+  void Finish(FileStats& inout_stats, xiiUInt64 uiCodePoints);
+
+private:
+  void ProcessScalar(const char*& ref_szPos, const char* szEnd, const char* szStop);
+  void ProcessAsciiBlock(xiiUInt32 uiNewlines, xiiUInt32 uiBlanks, xiiUInt32 uiIdentifiers);
+  void ProcessSegment(xiiUInt32 uiStart, xiiUInt32 uiEnd, xiiUInt32 uiBlanks, xiiUInt32 uiIdentifiers);
+  void ProcessCharacter(bool bIsDelimiter);
+  void EndLine();
+
+  xiiUInt64 m_uiLines;
+  xiiUInt64 m_uiEmptyLines;
+  xiiUInt64 m_uiBytes;
+  xiiUInt64 m_uiCarriageReturns;
+  xiiUInt64 m_uiWords;
+
+  bool m_bLineHasContent;  // Whether a character other than a space or tab was found in the current line
+  bool m_bPendingBlank;    // Whether spaces or tabs were found after the last character, they only count if the line continues
+  bool m_bLastIsDelimiter; // Whether the last character (other than a space or tab) is a delimiter
+
+  xiiLineCountLanguage m_Language  = xiiLineCountLanguage::None;
+  bool                 m_bRunLexer = false; // Only for languages with comments, see SetLanguage()
+  xiiLineCountLexer    m_Lexer;
+};
+
+// Computes the stats of the given file content. szFile is only used for reporting errors.
+// If pTimings is given, the time spent on validating and counting is added to it.
+FileStats GetFileStats(xiiArrayPtr<const xiiUInt8> content, const char* szFile, xiiLineCountLanguage language, ScanTimings* pTimings = nullptr);
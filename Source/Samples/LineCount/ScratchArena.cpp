@@ -0,0 +1,113 @@
+#include <LineCount/ScratchArena.h>
+
+#include <Foundation/Math/Math.h>
+
+namespace
+{
+  // Blocks start at this size, so that small files don't cause a series of growing blocks
+  constexpr xiiUInt64 MinBlockSize = 64 * 1024;
+
+  // Rounds up to a power of two, so that files of similar sizes share a block size. Huge blocks are not kept anyway.
+  xiiUInt64 GetBlockSize(xiiUInt64 uiBytes)
+  {
+    xiiUInt64 uiSize = MinBlockSize;
+    while (uiSize < uiBytes && uiSize <= xiiLineCountScratchArena::MaxRetainedSize)
+    {
+      uiSize *= 2;
+    }
+
+    return xiiMath::Max(uiSize, uiBytes);
+  }
+} // namespace
+
+xiiUInt64 xiiLineCountScratchArena::FindSpace(const xiiDynamicArray<xiiUInt8>& block, xiiUInt64 uiUsed, xiiUInt64 uiSize, xiiUInt32 uiAlignment)
+{
+  // The alignment is relative to the address, not to the start of the block
+  const xiiUInt64 uiAddress = reinterpret_cast<xiiUInt64>(block.GetData()) + uiUsed;
+  const xiiUInt64 uiOffset  = uiUsed + ((uiAlignment - (uiAddress & (uiAlignment - 1))) & (uiAlignment - 1));
+
+  if (uiOffset + uiSize > block.GetCount())
+    return InvalidOffset;
+
+  return uiOffset;
+}
+
+void* xiiLineCountScratchArena::Allocate(xiiUInt64 uiSize, xiiUInt32 uiAlignment)
+{
+  XII_ASSERT_DEBUG(uiAlignment > 0 && (uiAlignment & (uiAlignment - 1)) == 0, "Alignment must be a power of two");
+  XII_ASSERT_DEV(uiSize < 0xFFFFFFFFu - uiAlignment, "Scratch allocations are limited to 4 GB");
+
+  ++m_Stats.m_uiAllocations;
+
+  // Zero-sized allocations still get a unique, aligned address
+  uiSize = xiiMath::Max<xiiUInt64>(uiSize, 1);
+
+  // Without a block (before the first file, or after a huge one), the first allocation decides the size of the block
+  if (m_Block.IsEmpty() && m_Overflow.IsEmpty())
+  {
+    ++m_Stats.m_uiHeapAllocations;
+    m_Block.SetCountUninitialized(static_cast<xiiUInt32>(GetBlockSize(uiSize + uiAlignment)));
+  }
+
+  xiiDynamicArray<xiiUInt8>* pBlock = &m_Block;
+  xiiUInt64*                 pUsed  = &m_uiUsed;
+
+  if (!m_Overflow.IsEmpty())
+  {
+    pBlock = &m_Overflow.PeekBack().m_Block;
+    pUsed  = &m_Overflow.PeekBack().m_uiUsed;
+  }
+
+  xiiUInt64 uiOffset = FindSpace(*pBlock, *pUsed, uiSize, uiAlignment);
+
+  if (uiOffset == InvalidOffset)
+  {
+    // Each overflow block is at least as large as everything before it, so there are only a few of them
+    ++m_Stats.m_uiHeapAllocations;
+
+    Overflow& overflow = m_Overflow.ExpandAndGetRef();
+    overflow.m_Block.SetCountUninitialized(static_cast<xiiUInt32>(xiiMath::Min<xiiUInt64>(xiiMath::Max(uiSize + uiAlignment, m_uiInUse), 0xFFFFFFFFu)));
+
+    pBlock   = &overflow.m_Block;
+    pUsed    = &overflow.m_uiUsed;
+    uiOffset = FindSpace(*pBlock, 0, uiSize, uiAlignment);
+  }
+
+  m_uiInUse += uiOffset + uiSize - *pUsed;
+  *pUsed = uiOffset + uiSize;
+
+  return pBlock->GetData() + uiOffset;
+}
+
+void xiiLineCountScratchArena::Reset()
+{
+  if (m_uiInUse == 0)
+    return;
+
+  ++m_Stats.m_uiResets;
+  m_Stats.m_uiPeakBytes = xiiMath::Max(m_Stats.m_uiPeakBytes, m_uiInUse);
+
+  if (!m_Overflow.IsEmpty())
+  {
+    // The next file of the same size should fit into a single block. The padding for the alignment is part of m_uiInUse.
+    const xiiUInt64 uiNeeded = GetBlockSize(m_uiInUse);
+
+    m_Overflow.Clear();
+    m_Block.Clear();
+    m_Block.Compact();
+
+    if (uiNeeded <= MaxRetainedSize)
+    {
+      ++m_Stats.m_uiHeapAllocations;
+      m_Block.SetCountUninitialized(static_cast<xiiUInt32>(uiNeeded));
+    }
+  }
+  else if (m_Block.GetCount() > MaxRetainedSize)
+  {
+    m_Block.Clear();
+    m_Block.Compact();
+  }
+
+  m_uiUsed  = 0;
+  m_uiInUse = 0;
+}
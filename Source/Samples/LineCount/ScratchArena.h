@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+// A linear allocator for the memory that a worker needs while it scans a single file (the file content, chunk buffers).
+//
+// Allocating only moves a pointer forward, and Reset() makes all memory available again at once. Memory comes from a
+// single block that is kept across files. If a file needs more than that, extra blocks are allocated for it, and at the
+// next Reset() they are replaced by one block that is large enough for all of it. So after the largest file was seen,
+// scanning does not touch the heap anymore. Blocks larger than MaxRetainedSize are released at the reset, so a single
+// huge file does not pin that much memory for the rest of the run.
+//
+// Not thread-safe, every worker has its own arena.
+class xiiLineCountScratchArena
+{
+public:
+  static constexpr xiiUInt64 MaxRetainedSize = 64 * 1024 * 1024;
+
+  struct Stats
+  {
+    void operator+=(const Stats& rhs)
+    {
+      m_uiAllocations += rhs.m_uiAllocations;
+      m_uiHeapAllocations += rhs.m_uiHeapAllocations;
+      m_uiResets += rhs.m_uiResets;
+      m_uiPeakBytes = m_uiPeakBytes > rhs.m_uiPeakBytes ? m_uiPeakBytes : rhs.m_uiPeakBytes;
+    }
+
+    xiiUInt64 m_uiAllocations     = 0; // Served by the arena
+    xiiUInt64 m_uiHeapAllocations = 0; // Blocks that the arena had to allocate for that
+    xiiUInt64 m_uiResets          = 0;
+    xiiUInt64 m_uiPeakBytes       = 0; // The most memory that was in use between two resets
+  };
+
+  // Returns uninitialized memory that stays valid until the next Reset(). uiAlignment must be a power of two.
+  void* Allocate(xiiUInt64 uiSize, xiiUInt32 uiAlignment = 16);
+
+  template <typename T>
+  xiiArrayPtr<T> AllocateArray(xiiUInt32 uiCount)
+  {
+    return xiiArrayPtr<T>(static_cast<T*>(Allocate((xiiUInt64)uiCount * sizeof(T), alignof(T) > 16 ? alignof(T) : 16)), uiCount);
+  }
+
+  // Makes all memory available again. Does nothing if nothing was allocated since the last reset.
+  void Reset();
+
+  const Stats& GetStats() const { return m_Stats; }
+
+private:
+  // Returns the offset at which uiSize bytes fit into the block, or InvalidOffset.
+  static constexpr xiiUInt64 InvalidOffset = 0xFFFFFFFFFFFFFFFFull;
+  static xiiUInt64           FindSpace(const xiiDynamicArray<xiiUInt8>& block, xiiUInt64 uiUsed, xiiUInt64 uiSize, xiiUInt32 uiAlignment);
+
+  xiiDynamicArray<xiiUInt8> m_Block;
+  xiiUInt64                 m_uiUsed = 0;
+
+  // Only used when a file needs more than m_Block, merged into it at the next reset
+  struct Overflow
+  {
+    xiiDynamicArray<xiiUInt8> m_Block;
+    xiiUInt64                 m_uiUsed = 0;
+  };
+
+  xiiHybridArray<Overflow, 4> m_Overflow;
+  xiiUInt64                   m_uiInUse = 0; // Over all blocks, including alignment padding
+
+  Stats m_Stats;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Foundation/Basics.h>
+
+// Helpers for the SIMD kernels of LineCount.
+// SSE2 is always available on x86-64, AVX2 is only used when IsAVX2Supported() returns true at runtime.
+
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+#  include <immintrin.h>
+#  if XII_ENABLED(XII_COMPILER_MSVC)
+#    include <intrin.h>
+#  endif
+
+// MSVC allows AVX2 intrinsics in any function, GCC and Clang need every function that uses them to be marked
+#  if XII_ENABLED(XII_COMPILER_MSVC)
+#    define XII_LINECOUNT_AVX2_FUNCTION
+#  else
+#    define XII_LINECOUNT_AVX2_FUNCTION __attribute__((target("avx2")))
+#  endif
+
+// Returns whether the CPU and the OS support AVX2.
+inline bool IsAVX2Supported()
+{
+#  if XII_ENABLED(XII_COMPILER_MSVC)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+
+  // The OS must save the AVX registers (OSXSAVE and XCR0 bits for SSE and AVX state)
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#  else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#  endif
+}
+
+#endif
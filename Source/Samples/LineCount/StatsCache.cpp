@@ -0,0 +1,142 @@
+#include <LineCount/CheckedReader.h>
+#include <LineCount/StatsCache.h>
+
+#include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/Strings/StringBuilder.h>
+
+namespace
+{
+  constexpr xiiUInt32 s_uiMagic = 0x4343434C; // 'LCCC'
+
+  // Must be increased whenever the format or the counting rules change, so that old caches are discarded
+  constexpr xiiUInt32 s_uiVersion = 4;
+
+  // The length of the path, size, modification time, content hash and the eight counters of the stats
+  constexpr xiiUInt32 s_uiMinEntrySize = sizeof(xiiUInt32) + 3 * sizeof(xiiUInt64) + 8 * sizeof(xiiUInt64);
+
+  void WriteStats(xiiStreamWriter& inout_stream, const FileStats& stats)
+  {
+    inout_stream << stats.m_uiLines;
+    inout_stream << stats.m_uiEmptyLines;
+    inout_stream << stats.m_uiBytes;
+    inout_stream << stats.m_uiCharacters;
+    inout_stream << stats.m_uiWords;
+    inout_stream << stats.m_uiCodeLines;
+    inout_stream << stats.m_uiCommentLines;
+    inout_stream << stats.m_uiMixedLines;
+  }
+
+  void ReadStats(xiiLineCountCheckedReader& inout_file, FileStats& out_stats)
+  {
+    inout_file.Read(out_stats.m_uiLines);
+    inout_file.Read(out_stats.m_uiEmptyLines);
+    inout_file.Read(out_stats.m_uiBytes);
+    inout_file.Read(out_stats.m_uiCharacters);
+    inout_file.Read(out_stats.m_uiWords);
+    inout_file.Read(out_stats.m_uiCodeLines);
+    inout_file.Read(out_stats.m_uiCommentLines);
+    inout_file.Read(out_stats.m_uiMixedLines);
+  }
+} // namespace
+
+xiiResult xiiLineCountStatsCache::Load(xiiStringView sCacheFile, xiiStringView sSearchDir, bool bClassified)
+{
+  Clear();
+  m_sSearchDir  = sSearchDir;
+  m_bClassified = bClassified;
+
+  xiiLineCountCheckedReader file;
+  if (file.Open(sCacheFile).Failed())
+    return XII_FAILURE;
+
+  xiiUInt32 uiMagic   = 0;
+  xiiUInt32 uiVersion = 0;
+  file.Read(uiMagic);
+  file.Read(uiVersion);
+
+  if (uiMagic != s_uiMagic || uiVersion != s_uiVersion)
+    return XII_FAILURE;
+
+  xiiStringBuilder sCachedSearchDir;
+  bool             bCachedClassified = false;
+  file.ReadString(sCachedSearchDir);
+  file.Read(bCachedClassified);
+
+  if (file.HasFailed() || sCachedSearchDir != sSearchDir || bCachedClassified != bClassified)
+    return XII_FAILURE;
+
+  const xiiUInt32 uiCount = file.ReadCount(s_uiMinEntrySize);
+  m_Entries.Reserve(uiCount);
+
+  xiiStringBuilder sPath;
+  for (xiiUInt32 i = 0; i < uiCount; ++i)
+  {
+    Entry entry;
+
+    file.ReadString(sPath);
+    file.Read(entry.m_uiFileSize);
+    file.Read(entry.m_iModificationTime);
+    file.Read(entry.m_uiContentHash);
+    ReadStats(file, entry.m_Stats);
+
+    // A damaged cache is not used at all, the files are scanned again and the cache is written anew
+    if (file.HasFailed())
+    {
+      Clear();
+      return XII_FAILURE;
+    }
+
+    m_Entries.Insert(sPath, entry);
+  }
+
+  return XII_SUCCESS;
+}
+
+xiiResult xiiLineCountStatsCache::Save(xiiStringView sCacheFile) const
+{
+  xiiFileWriter file;
+  XII_SUCCEED_OR_RETURN(file.Open(sCacheFile));
+
+  file << s_uiMagic;
+  file << s_uiVersion;
+  XII_SUCCEED_OR_RETURN(file.WriteString(m_sSearchDir));
+  file << m_bClassified;
+  file << m_Entries.GetCount();
+
+  for (auto it = m_Entries.GetIterator(); it.IsValid(); ++it)
+  {
+    const Entry& entry = it.Value();
+
+    XII_SUCCEED_OR_RETURN(file.WriteString(it.Key()));
+    file << entry.m_uiFileSize;
+    file << entry.m_iModificationTime;
+    file << entry.m_uiContentHash;
+    WriteStats(file, entry.m_Stats);
+  }
+
+  return XII_SUCCESS;
+}
+
+void xiiLineCountStatsCache::Clear()
+{
+  m_Entries.Clear();
+}
+
+const xiiLineCountStatsCache::Entry* xiiLineCountStatsCache::Find(xiiStringView sAbsolutePath) const
+{
+  return m_Entries.GetValue(GetRelativePath(sAbsolutePath));
+}
+
+void xiiLineCountStatsCache::Store(xiiStringView sAbsolutePath, const Entry& entry)
+{
+  m_Entries.Insert(GetRelativePath(sAbsolutePath), entry);
+}
+
+xiiStringView xiiLineCountStatsCache::GetRelativePath(xiiStringView sAbsolutePath) const
+{
+  // All files are found below the search directory, storing only the rest keeps the cache small
+  if (sAbsolutePath.StartsWith(m_sSearchDir))
+    sAbsolutePath.Shrink(m_sSearchDir.GetCharacterCount(), 0);
+
+  return sAbsolutePath;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <LineCount/FileStats.h>
+
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Strings/String.h>
+
+// Stores the stats of every scanned file on disk, so that a later run only has to scan the files that changed.
+//
+// Files are identified by their path relative to the search directory, their size and their modification time.
+// Optionally a hash of the content is stored as well. Then files whose modification time changed, but whose content
+// did not (e.g. after switching branches), can be answered from the cache too.
+class xiiLineCountStatsCache
+{
+public:
+  struct Entry
+  {
+    xiiUInt64 m_uiFileSize        = 0;
+    xiiInt64  m_iModificationTime = 0; // In microseconds
+    xiiUInt64 m_uiContentHash     = 0; // Zero if the content was not hashed
+    FileStats m_Stats;
+  };
+
+  // Loads the cache from the given file. Fails if the file does not exist, is outdated, damaged or was written for a different search directory.
+  // It also fails if the lines were classified into code and comments in one run, but not in the other ('-classify').
+  xiiResult Load(xiiStringView sCacheFile, xiiStringView sSearchDir, bool bClassified);
+
+  // Writes all entries to the given file.
+  xiiResult Save(xiiStringView sCacheFile) const;
+
+  // Removes all entries.
+  void Clear();
+
+  // Returns the entry for the given absolute path, or nullptr if the file is not in the cache.
+  // This may be called from multiple threads at the same time, as long as the cache is not modified.
+  const Entry* Find(xiiStringView sAbsolutePath) const;
+
+  // Adds or replaces the entry for the given absolute path. Must not be called while other threads access the cache.
+  void Store(xiiStringView sAbsolutePath, const Entry& entry);
+
+  // Sets the directory that all paths are relative to.
+  void SetSearchDir(xiiStringView sSearchDir) { m_sSearchDir = sSearchDir; }
+
+  // Sets whether the stats that are stored include the code, comment and mixed lines.
+  void SetClassified(bool bClassified) { m_bClassified = bClassified; }
+
+  xiiUInt32 GetCount() const { return m_Entries.GetCount(); }
+
+private:
+  xiiStringView GetRelativePath(xiiStringView sAbsolutePath) const;
+
+  xiiString                      m_sSearchDir;
+  bool                           m_bClassified = false;
+  xiiHashTable<xiiString, Entry> m_Entries;
+};
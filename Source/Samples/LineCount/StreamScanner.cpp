@@ -0,0 +1,128 @@
+#include <LineCount/StreamScanner.h>
+
+#include <Foundation/Math/Math.h>
+#include <Foundation/Profiling/Profiling.h>
+
+namespace
+{
+  // Returns how many bytes the Utf-8 sequence starting with the given byte spans, or 0 if it is not a valid start byte.
+  // These are the same rules by which xiiUnicodeUtils::DecodeUtf8ToUtf32() advances.
+  xiiUInt32 GetSequenceLength(xiiUInt8 uiByte)
+  {
+    if (uiByte < 0x80)
+      return 1;
+    if ((uiByte >> 5) == 0x06)
+      return 2;
+    if ((uiByte >> 4) == 0x0E)
+      return 3;
+    if ((uiByte >> 3) == 0x1E)
+      return 4;
+
+    return 0;
+  }
+
+  bool IsContinuationByte(xiiUInt8 uiByte)
+  {
+    return (uiByte & 0xC0) == 0x80;
+  }
+} // namespace
+
+xiiLineCountStreamScanner::xiiLineCountStreamScanner()
+{
+  Reset();
+}
+
+void xiiLineCountStreamScanner::Reset()
+{
+  m_Validator.Reset();
+  m_Scanner.Reset();
+  m_uiCarryCount = 0;
+}
+
+bool xiiLineCountStreamScanner::Process(xiiArrayPtr<const xiiUInt8> chunk, ScanTimings* pTimings)
+{
+  if (m_Validator.IsTerminated())
+    return false;
+
+  const xiiTime validateStartTime = pTimings ? xiiTime::Now() : xiiTime();
+
+  xiiArrayPtr<const xiiUInt8> text;
+
+  {
+    XII_PROFILE_SCOPE("Validate");
+    text = chunk.GetSubArray(0, m_Validator.Process(chunk));
+  }
+
+  const xiiTime countStartTime = pTimings ? xiiTime::Now() : xiiTime();
+
+  // Invalid text is not counted anyway
+  if (!m_Validator.HasError())
+  {
+    XII_PROFILE_SCOPE("Count");
+    ScanText(text);
+  }
+
+  if (pTimings)
+  {
+    pTimings->m_Validate += countStartTime - validateStartTime;
+    pTimings->m_Count += xiiTime::Now() - countStartTime;
+  }
+
+  return !m_Validator.IsTerminated();
+}
+
+void xiiLineCountStreamScanner::ScanText(xiiArrayPtr<const xiiUInt8> text)
+{
+  // Complete the sequence that was started in the previous chunk
+  if (m_uiCarryCount > 0)
+  {
+    const xiiUInt32 uiMissing = xiiMath::Min(GetSequenceLength(m_Carry[0]) - m_uiCarryCount, text.GetCount());
+
+    for (xiiUInt32 i = 0; i < uiMissing; ++i)
+    {
+      m_Carry[m_uiCarryCount++] = text[i];
+    }
+
+    text = text.GetSubArray(uiMissing);
+
+    if (m_uiCarryCount < GetSequenceLength(m_Carry[0]))
+      return;
+
+    m_Scanner.Process(xiiArrayPtr<const xiiUInt8>(m_Carry, m_uiCarryCount));
+    m_uiCarryCount = 0;
+  }
+
+  // Hold back a sequence that continues in the next chunk. Only a start byte within the last three bytes can do that.
+  // If there are several candidates (only possible in invalid text) the earliest one is held back,
+  // that way the scanner never decodes past the end of the chunk.
+  xiiUInt32 uiEnd = text.GetCount();
+
+  for (xiiUInt32 uiBack = 1; uiBack <= xiiMath::Min(3u, text.GetCount()); ++uiBack)
+  {
+    const xiiUInt8 uiByte = text[text.GetCount() - uiBack];
+
+    if (!IsContinuationByte(uiByte) && GetSequenceLength(uiByte) > uiBack)
+      uiEnd = text.GetCount() - uiBack;
+  }
+
+  m_Scanner.Process(text.GetSubArray(0, uiEnd));
+
+  for (xiiUInt32 i = uiEnd; i < text.GetCount(); ++i)
+  {
+    m_Carry[m_uiCarryCount++] = text[i];
+  }
+}
+
+bool xiiLineCountStreamScanner::Finish(FileStats& inout_stats)
+{
+  // A sequence that is still incomplete makes the validation fail as well
+  if (!m_Validator.Finish())
+  {
+    Reset();
+    return false;
+  }
+
+  m_Scanner.Finish(inout_stats, m_Validator.GetCodePointCount());
+  Reset();
+  return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <LineCount/Scanner.h>
+#include <LineCount/Utf8Validator.h>
+
+// Computes the stats of text that is passed in through chunks of arbitrary size, e.g. while reading a file piece by piece.
+// The memory usage only depends on the chunk size, not on the size of the text, and the results are identical to GetFileStats().
+//
+// xiiLineCountUtf8Validator and xiiLineCountScanner already keep their state (open lines, words, pending blanks and
+// carriage returns) across calls. The only thing that needs care are Utf-8 sequences that are split between two chunks,
+// since the scanner can only decode complete ones. Those few bytes are held back and completed with the next chunk.
+class xiiLineCountStreamScanner
+{
+public:
+  xiiLineCountStreamScanner();
+
+  // Sets the language of the text, see xiiLineCountScanner::SetLanguage().
+  void SetLanguage(xiiLineCountLanguage language) { m_Scanner.SetLanguage(language); }
+
+  // Resets the state, so that the next file can be scanned.
+  void Reset();
+
+  // Scans the next chunk. Returns false once the end of the text (a zero byte) was found, all further data is ignored.
+  // If pTimings is given, the time spent on validating and counting is added to it.
+  bool Process(xiiArrayPtr<const xiiUInt8> chunk, ScanTimings* pTimings = nullptr);
+
+  // Finishes the text. Returns false if it is not valid Utf-8, in that case the stats are left unchanged.
+  bool Finish(FileStats& inout_stats);
+
+private:
+  void ScanText(xiiArrayPtr<const xiiUInt8> text);
+
+  xiiLineCountUtf8Validator m_Validator;
+  xiiLineCountScanner       m_Scanner;
+
+  // The start of a Utf-8 sequence that continues in the next chunk
+  xiiUInt32 m_uiCarryCount;
+  xiiUInt8  m_Carry[4];
+};
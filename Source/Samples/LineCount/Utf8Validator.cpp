@@ -0,0 +1,362 @@
+#include <LineCount/Scanner.h>
+#include <LineCount/Simd.h>
+#include <LineCount/Utf8Validator.h>
+
+#include <Foundation/Math/Math.h>
+#include <Foundation/Memory/MemoryUtils.h>
+
+namespace
+{
+  constexpr xiiUInt32 s_uiBlockSize = 32;
+
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+
+  // Error classes of the lookup table algorithm, one bit each.
+  // The tables are indexed by the high and low nibble of the previous byte and the high nibble of the current byte,
+  // a pair of bytes is invalid if all three lookups share a bit.
+  constexpr xiiUInt8 TOO_SHORT      = 1 << 0; // 11______ 0_______ or 11______ 11______
+  constexpr xiiUInt8 TOO_LONG       = 1 << 1; // 0_______ 10______
+  constexpr xiiUInt8 OVERLONG_3     = 1 << 2; // 11100000 100_____
+  constexpr xiiUInt8 TOO_LARGE      = 1 << 3; // 11110100 1001____ and above
+  constexpr xiiUInt8 SURROGATE      = 1 << 4; // 11101101 101_____
+  constexpr xiiUInt8 OVERLONG_2     = 1 << 5; // 1100000_ 10______
+  constexpr xiiUInt8 TOO_LARGE_1000 = 1 << 6; // 11110101 1000____ and above
+  constexpr xiiUInt8 OVERLONG_4     = 1 << 6; // 11110000 1000____
+  constexpr xiiUInt8 TWO_CONTS      = 1 << 7; // 10______ 10______
+  constexpr xiiUInt8 CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+  alignas(16) constexpr xiiUInt8 s_Byte1High[16] = {
+    // 0_______ ________ <ASCII in byte 1>
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    // 10______ ________ <continuation in byte 1>
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    // 1100____ ________ <two byte lead in byte 1>
+    TOO_SHORT | OVERLONG_2,
+    // 1101____ ________ <two byte lead in byte 1>
+    TOO_SHORT,
+    // 1110____ ________ <three byte lead in byte 1>
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    // 1111____ ________ <four byte lead in byte 1>
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+
+  alignas(16) constexpr xiiUInt8 s_Byte1Low[16] = {
+    // ____0000 ________
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    // ____0001 ________
+    CARRY | OVERLONG_2,
+    // ____001_ ________
+    CARRY, CARRY,
+    // ____0100 ________
+    CARRY | TOO_LARGE,
+    // ____0101 ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    // ____011_ ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    // ____1___ ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    // ____1101 ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000};
+
+  alignas(16) constexpr xiiUInt8 s_Byte2High[16] = {
+    // ________ 0_______ <ASCII in byte 2>
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    // ________ 1000____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    // ________ 1001____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    // ________ 101_____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    // ________ 11______ <lead byte in byte 2>
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+
+  // Returns the input shifted by N bytes, with the last N bytes of the previous block shifted in
+  template <int N>
+  XII_LINECOUNT_AVX2_FUNCTION inline __m256i PreviousBytesAVX2(__m256i input, __m256i previousInput)
+  {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previousInput, input, 0x21), 16 - N);
+  }
+
+  XII_LINECOUNT_AVX2_FUNCTION inline __m256i LookupAVX2(const xiiUInt8* pTable, __m256i nibbles)
+  {
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(pTable))), nibbles);
+  }
+
+  // Returns a non-zero vector if the block is invalid, taking sequences into account that started in the previous block
+  XII_LINECOUNT_AVX2_FUNCTION inline __m256i CheckBlockAVX2(__m256i input, __m256i previousInput)
+  {
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+    const __m256i prev1      = PreviousBytesAVX2<1>(input, previousInput);
+
+    const __m256i byte1High    = LookupAVX2(s_Byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), lowNibbles));
+    const __m256i byte1Low     = LookupAVX2(s_Byte1Low, _mm256_and_si256(prev1, lowNibbles));
+    const __m256i byte2High    = LookupAVX2(s_Byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), lowNibbles));
+    const __m256i specialCases = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+    // The third and fourth byte of a sequence must be continuations, those are the only legal TWO_CONTS cases
+    const __m256i isThirdByte  = _mm256_subs_epu8(PreviousBytesAVX2<2>(input, previousInput), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    const __m256i isFourthByte = _mm256_subs_epu8(PreviousBytesAVX2<3>(input, previousInput), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    const __m256i mustBe23     = _mm256_and_si256(_mm256_or_si256(isThirdByte, isFourthByte), _mm256_set1_epi8((char)0x80));
+
+    return _mm256_xor_si256(mustBe23, specialCases);
+  }
+
+  // Validates one block and returns whether it contains an error
+  XII_LINECOUNT_AVX2_FUNCTION bool ValidateBlockAVX2(const xiiUInt8* pBlock, xiiUInt8* pPreviousBlock, xiiUInt64& inout_uiCodePoints)
+  {
+    const __m256i input         = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBlock));
+    const __m256i previousInput = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pPreviousBlock));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pPreviousBlock), input);
+
+    if (_mm256_movemask_epi8(input) == 0)
+    {
+      // Pure ASCII is only an error if the previous block ended in the middle of a sequence
+      inout_uiCodePoints += s_uiBlockSize;
+
+      const __m256i incompleteLimits = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+      const __m256i incomplete = _mm256_subs_epu8(previousInput, incompleteLimits);
+
+      return _mm256_testz_si256(incomplete, incomplete) == 0;
+    }
+
+    // Every byte that is not a continuation byte (0x80 - 0xBF, -128 to -65 as signed bytes) starts a code point
+    const xiiUInt32 uiContinuations = (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(-64), input));
+    inout_uiCodePoints += s_uiBlockSize - xiiMath::CountBits(uiContinuations);
+
+    const __m256i error = CheckBlockAVX2(input, previousInput);
+    return _mm256_testz_si256(error, error) == 0;
+  }
+
+  XII_LINECOUNT_AVX2_FUNCTION xiiUInt32 FindZeroAVX2(const xiiUInt8* pBlock)
+  {
+    const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBlock));
+    return (xiiUInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(input, _mm256_setzero_si256()));
+  }
+
+#endif
+} // namespace
+
+xiiLineCountUtf8Validator::xiiLineCountUtf8Validator()
+{
+  Reset();
+}
+
+void xiiLineCountUtf8Validator::Reset()
+{
+  m_bUseAVX2     = xiiLineCountScanner::GetKernel() == xiiLineCountScanner::Kernel::AVX2;
+  m_bUseSSE2     = xiiLineCountScanner::GetKernel() == xiiLineCountScanner::Kernel::SSE2;
+  m_bError       = false;
+  m_bTerminated  = false;
+  m_uiCodePoints = 0;
+
+  m_uiPendingContinuations = 0;
+  m_uiMinContinuation      = 0x80;
+  m_uiMaxContinuation      = 0xBF;
+
+  m_uiPartialCount = 0;
+  xiiMemoryUtils::ZeroFill(m_PreviousBlock, s_uiBlockSize);
+}
+
+xiiUInt32 xiiLineCountUtf8Validator::Process(xiiArrayPtr<const xiiUInt8> data)
+{
+  if (m_bTerminated)
+    return 0;
+
+  // Once the text is known to be invalid, only the end of the text is of interest
+  if (m_bError)
+  {
+    if (const void* pZero = memchr(data.GetPtr(), 0, data.GetCount()))
+    {
+      m_bTerminated = true;
+      return static_cast<xiiUInt32>(static_cast<const xiiUInt8*>(pZero) - data.GetPtr());
+    }
+
+    return data.GetCount();
+  }
+
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+  if (m_bUseAVX2)
+    return ProcessAVX2(data.GetPtr(), data.GetCount());
+#endif
+
+  return ProcessScalar(data.GetPtr(), data.GetCount(), m_bUseSSE2);
+}
+
+bool xiiLineCountUtf8Validator::Finish()
+{
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+  if (m_bUseAVX2 && !m_bError)
+  {
+    // Pad the last block with zeros. A sequence that is cut off is then followed by ASCII, which is an error.
+    // If there is nothing left, an all-zero block checks the end of the previous block.
+    const xiiUInt32 uiPadding = s_uiBlockSize - m_uiPartialCount;
+    xiiMemoryUtils::ZeroFill(m_PartialBlock + m_uiPartialCount, uiPadding);
+
+    m_bError |= ValidateBlockAVX2(m_PartialBlock, m_PreviousBlock, m_uiCodePoints);
+    m_uiCodePoints -= uiPadding;
+    m_uiPartialCount = 0;
+  }
+#endif
+
+  // A sequence that is cut off is an error as well
+  m_bError |= m_uiPendingContinuations != 0;
+
+  return !m_bError;
+}
+
+xiiUInt32 xiiLineCountUtf8Validator::ProcessScalar(const xiiUInt8* pData, xiiUInt32 uiCount, bool bSkipAsciiSSE2)
+{
+  xiiUInt32 i = 0;
+
+  while (i < uiCount)
+  {
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+    if (bSkipAsciiSSE2 && m_uiPendingContinuations == 0)
+    {
+      // Skip over blocks of ASCII without zero bytes, every byte is a code point of its own
+      while (uiCount - i >= 16)
+      {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i));
+
+        if ((_mm_movemask_epi8(input) | _mm_movemask_epi8(_mm_cmpeq_epi8(input, _mm_setzero_si128()))) != 0)
+          break;
+
+        m_uiCodePoints += 16;
+        i += 16;
+      }
+    }
+#endif
+
+    const xiiUInt32 uiStop = bSkipAsciiSSE2 ? xiiMath::Min(i + 16, uiCount) : uiCount;
+
+    for (; i < uiStop; ++i)
+    {
+      const xiiUInt8 c = pData[i];
+
+      if (m_uiPendingContinuations > 0)
+      {
+        if (c < m_uiMinContinuation || c > m_uiMaxContinuation)
+        {
+          m_bError = true;
+          return i + Process(xiiArrayPtr<const xiiUInt8>(pData + i, uiCount - i));
+        }
+
+        --m_uiPendingContinuations;
+        m_uiMinContinuation = 0x80;
+        m_uiMaxContinuation = 0xBF;
+        continue;
+      }
+
+      if (c == 0)
+      {
+        m_bTerminated = true;
+        return i;
+      }
+
+      ++m_uiCodePoints;
+
+      if (c < 0x80)
+        continue;
+
+      // Lead bytes determine the length of the sequence, some of them restrict the range of the following byte
+      // to rule out overlong encodings, surrogates and code points above U+10FFFF
+      if (c >= 0xC2 && c <= 0xDF)
+      {
+        m_uiPendingContinuations = 1;
+      }
+      else if (c >= 0xE0 && c <= 0xEF)
+      {
+        m_uiPendingContinuations = 2;
+        m_uiMinContinuation      = (c == 0xE0) ? 0xA0 : 0x80;
+        m_uiMaxContinuation      = (c == 0xED) ? 0x9F : 0xBF;
+      }
+      else if (c >= 0xF0 && c <= 0xF4)
+      {
+        m_uiPendingContinuations = 3;
+        m_uiMinContinuation      = (c == 0xF0) ? 0x90 : 0x80;
+        m_uiMaxContinuation      = (c == 0xF4) ? 0x8F : 0xBF;
+      }
+      else
+      {
+        m_bError = true;
+        return i + Process(xiiArrayPtr<const xiiUInt8>(pData + i, uiCount - i));
+      }
+    }
+  }
+
+  return uiCount;
+}
+
+#if XII_ENABLED(XII_PLATFORM_ARCH_X86)
+
+xiiUInt32 xiiLineCountUtf8Validator::ProcessAVX2(const xiiUInt8* pData, xiiUInt32 uiCount)
+{
+  xiiUInt32 i = 0;
+
+  // Complete the block that was started by the previous call
+  if (m_uiPartialCount > 0)
+  {
+    const xiiUInt32 uiTake = xiiMath::Min(s_uiBlockSize - m_uiPartialCount, uiCount);
+
+    if (const void* pZero = memchr(pData, 0, uiTake))
+    {
+      const xiiUInt32 uiLength = static_cast<xiiUInt32>(static_cast<const xiiUInt8*>(pZero) - pData);
+      xiiMemoryUtils::Copy(m_PartialBlock + m_uiPartialCount, pData, uiLength);
+      m_uiPartialCount += uiLength;
+      m_bTerminated = true;
+      return uiLength;
+    }
+
+    xiiMemoryUtils::Copy(m_PartialBlock + m_uiPartialCount, pData, uiTake);
+    m_uiPartialCount += uiTake;
+    i += uiTake;
+
+    if (m_uiPartialCount < s_uiBlockSize)
+      return uiCount;
+
+    m_bError |= ValidateBlockAVX2(m_PartialBlock, m_PreviousBlock, m_uiCodePoints);
+    m_uiPartialCount = 0;
+  }
+
+  while (uiCount - i >= s_uiBlockSize)
+  {
+    if (const xiiUInt32 uiZeros = FindZeroAVX2(pData + i))
+    {
+      // The text ends within this block, the rest is validated in Finish()
+      const xiiUInt32 uiLength = xiiMath::FirstBitLow(uiZeros);
+      xiiMemoryUtils::Copy(m_PartialBlock, pData + i, uiLength);
+      m_uiPartialCount = uiLength;
+      m_bTerminated    = true;
+      return i + uiLength;
+    }
+
+    m_bError |= ValidateBlockAVX2(pData + i, m_PreviousBlock, m_uiCodePoints);
+    i += s_uiBlockSize;
+  }
+
+  // Keep the remainder for the next call or for Finish()
+  const xiiUInt32 uiRemainder = uiCount - i;
+  xiiUInt32       uiLength    = uiRemainder;
+
+  if (const void* pZero = memchr(pData + i, 0, uiRemainder))
+  {
+    uiLength      = static_cast<xiiUInt32>(static_cast<const xiiUInt8*>(pZero) - (pData + i));
+    m_bTerminated = true;
+  }
+
+  xiiMemoryUtils::Copy(m_PartialBlock, pData + i, uiLength);
+  m_uiPartialCount = uiLength;
+
+  return i + uiLength;
+}
+
+#else
+
+xiiUInt32 xiiLineCountUtf8Validator::ProcessAVX2(const xiiUInt8* pData, xiiUInt32 uiCount)
+{
+  return ProcessScalar(pData, uiCount, false);
+}
+
+#endif
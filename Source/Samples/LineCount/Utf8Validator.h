@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Foundation/Types/ArrayPtr.h>
+
+// Validates Utf-8 text and counts its code points in a single pass.
+//
+// Like a C string, the text ends at the first zero byte, everything after it is ignored. The position of that zero
+// is found in the same pass as well, so the text doesn't need to be null-terminated or searched beforehand.
+//
+// With the AVX2 kernel, 32 bytes are validated at a time with the lookup table algorithm by Keiser and Lemire
+// ("Validating UTF-8 In Less Than One Instruction Per Byte"). The SSE2 kernel skips over ASCII 16 bytes at a time and
+// validates everything else with a scalar state machine. The kernel follows xiiLineCountScanner::GetKernel().
+//
+// The text may be passed in through several calls to Process(), Utf-8 sequences may be split across them.
+class xiiLineCountUtf8Validator
+{
+public:
+  xiiLineCountUtf8Validator();
+
+  // Resets the validator for the next text.
+  void Reset();
+
+  // Validates the next part of the text.
+  // Returns how many bytes of the given data belong to the text, which is less than its size if it contains the terminating zero.
+  xiiUInt32 Process(xiiArrayPtr<const xiiUInt8> data);
+
+  // Returns whether the terminating zero was found. All further data is ignored.
+  bool IsTerminated() const { return m_bTerminated; }
+
+  // Returns whether invalid Utf-8 was found so far. Errors may be detected up to one block after the invalid bytes were passed in.
+  bool HasError() const { return m_bError; }
+
+  // Validates the end of the text and returns whether all of it was valid Utf-8.
+  bool Finish();
+
+  // Returns the number of code points in the text so far. Only meaningful if the text is valid.
+  xiiUInt64 GetCodePointCount() const { return m_uiCodePoints; }
+
+private:
+  xiiUInt32 ProcessScalar(const xiiUInt8* pData, xiiUInt32 uiCount, bool bSkipAsciiSSE2);
+  xiiUInt32 ProcessAVX2(const xiiUInt8* pData, xiiUInt32 uiCount);
+
+  bool      m_bUseAVX2;
+  bool      m_bUseSSE2;
+  bool      m_bError;
+  bool      m_bTerminated;
+  xiiUInt64 m_uiCodePoints;
+
+  // State of the scalar kernels: how many continuation bytes still have to follow and the valid range for the next one
+  xiiUInt8 m_uiPendingContinuations;
+  xiiUInt8 m_uiMinContinuation;
+  xiiUInt8 m_uiMaxContinuation;
+
+  // State of the AVX2 kernel: the previously validated block and the incomplete block that is still being filled
+  xiiUInt32 m_uiPartialCount;
+  xiiUInt8  m_PreviousBlock[32];
+  xiiUInt8  m_PartialBlock[32];
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Core/Input/InputManager.h>
+
+// One input action of a sample, as it is registered with the input manager
+struct xiiSampleInputActionDesc
+{
+  const char* m_szName;
+  const char* m_szSlot;
+  bool        m_bApplyTimeScaling;
+};
+
+// Registers the input actions of a sample and queries their states when they are needed.
+//
+// Each sample lists its actions in a table, and an enum in the same order indexes both the table and the states. An
+// action is queried from the input manager the first time it is needed in a frame, so a sample doesn't pay for the
+// actions that it doesn't look at (e.g. mouse look while no button is held). Asking for it again in the same frame
+// reuses that state.
+template <xiiUInt32 ActionCount>
+class xiiSampleInput
+{
+  static_assert(ActionCount <= 32, "The queried actions are tracked in 32 bits");
+
+public:
+  xiiSampleInput(const char* szInputSet, const xiiSampleInputActionDesc (&actions)[ActionCount]) :
+    m_szInputSet(szInputSet),
+    m_pActions(actions)
+  {
+  }
+
+  // Registers all actions with their slot
+  void RegisterActions()
+  {
+    for (xiiUInt32 i = 0; i < ActionCount; ++i)
+    {
+      const xiiSampleInputActionDesc& action = m_pActions[i];
+
+      xiiInputActionConfig cfg   = xiiInputManager::GetInputActionConfig(m_szInputSet, action.m_szName);
+      cfg.m_sInputSlotTrigger[0] = action.m_szSlot;
+      cfg.m_bApplyTimeScaling    = action.m_bApplyTimeScaling;
+      xiiInputManager::SetInputActionConfig(m_szInputSet, action.m_szName, cfg, true);
+    }
+
+    m_uiQueried = 0;
+  }
+
+  // Forgets the states of the last frame, once per frame after xiiInputManager::Update()
+  void BeginFrame() { m_uiQueried = 0; }
+
+  xiiKeyState::Enum GetState(xiiUInt32 uiAction)
+  {
+    Query(uiAction);
+    return m_State[uiAction];
+  }
+
+  // The value of the action, or zero while it is up
+  float GetValue(xiiUInt32 uiAction)
+  {
+    Query(uiAction);
+    return m_State[uiAction] != xiiKeyState::Up ? m_fValue[uiAction] : 0.0f;
+  }
+
+  // Whether any of the actions that were queried in this frame is pressed, held or released
+  bool IsAnyActive() const
+  {
+    for (xiiUInt32 i = 0; i < ActionCount; ++i)
+    {
+      if ((m_uiQueried & (1u << i)) != 0 && m_State[i] != xiiKeyState::Up)
+        return true;
+    }
+
+    return false;
+  }
+
+private:
+  void Query(xiiUInt32 uiAction)
+  {
+    if ((m_uiQueried & (1u << uiAction)) != 0)
+      return;
+
+    m_uiQueried |= 1u << uiAction;
+    m_State[uiAction] = xiiInputManager::GetInputActionState(m_szInputSet, m_pActions[uiAction].m_szName, &m_fValue[uiAction]);
+  }
+
+  const char*                     m_szInputSet;
+  const xiiSampleInputActionDesc* m_pActions;
+  xiiUInt32                       m_uiQueried           = 0; // One bit per action that was queried since BeginFrame()
+  xiiKeyState::Enum               m_State[ActionCount]  = {};
+  float                           m_fValue[ActionCount] = {};
+};
+
+// The actions of the samples with a free camera: closing with escape, mouse look while the left button is held,
+// turning with the arrow keys and moving with WASD. In the order of g_SampleCameraActions.
+struct xiiSampleCameraAction
+{
+  enum Enum : xiiUInt8
+  {
+    CloseApp,
+    Look,
+    LookPosX,
+    LookNegX,
+    LookPosY,
+    LookNegY,
+    TurnPosX,
+    TurnNegX,
+    TurnPosY,
+    TurnNegY,
+    MovePosX,
+    MoveNegX,
+    MovePosY,
+    MoveNegY,
+    Count
+  };
+};
+
+inline constexpr xiiSampleInputActionDesc g_SampleCameraActions[xiiSampleCameraAction::Count] = {
+  {"CloseApp", xiiInputSlot_KeyEscape, true},
+  {"Look", xiiInputSlot_MouseButton0, false},
+  {"LookPosX", xiiInputSlot_MouseMovePosX, true},
+  {"LookNegX", xiiInputSlot_MouseMoveNegX, true},
+  {"LookPosY", xiiInputSlot_MouseMovePosY, true},
+  {"LookNegY", xiiInputSlot_MouseMoveNegY, true},
+  {"TurnPosX", xiiInputSlot_KeyRight, true},
+  {"TurnNegX", xiiInputSlot_KeyLeft, true},
+  {"TurnPosY", xiiInputSlot_KeyDown, true},
+  {"TurnNegY", xiiInputSlot_KeyUp, true},
+  {"MovePosX", xiiInputSlot_KeyD, true},
+  {"MoveNegX", xiiInputSlot_KeyA, true},
+  {"MovePosY", xiiInputSlot_KeyW, true},
+  {"MoveNegY", xiiInputSlot_KeyS, true},
+};
@@ -0,0 +1,192 @@
+#include <SampleWindow/FramePacer.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Threading/ThreadUtils.h>
+
+#if XII_ENABLED(XII_PLATFORM_WINDOWS)
+#  include <Foundation/Basics/Platform/Win/IncludeWindows.h>
+
+// Only declared by newer Windows SDKs, older versions of Windows fail to create such a timer
+#  ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#    define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#  endif
+#else
+#  include <time.h>
+#endif
+
+namespace
+{
+  // The CPU time of all threads of the process, in user and in kernel mode
+  xiiTime GetProcessCpuTime()
+  {
+#if XII_ENABLED(XII_PLATFORM_WINDOWS)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+      return xiiTime();
+
+    // Both are in units of 100 ns
+    const xiiUInt64 uiKernel = (static_cast<xiiUInt64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+    const xiiUInt64 uiUser   = (static_cast<xiiUInt64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+    return xiiTime::Nanoseconds(static_cast<double>(uiKernel + uiUser) * 100.0);
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+      return xiiTime();
+
+    return xiiTime::Seconds(static_cast<double>(time.tv_sec)) + xiiTime::Nanoseconds(static_cast<double>(time.tv_nsec));
+#endif
+  }
+} // namespace
+
+xiiSampleFramePacer::xiiSampleFramePacer()
+{
+#if XII_ENABLED(XII_PLATFORM_WINDOWS)
+  // Without it (before Windows 10 1803), sleeps end at the timer ticks of the system. Those are far apart, but the spin
+  // limit still keeps the CPU idle for most of the wait.
+  m_pTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+xiiSampleFramePacer::~xiiSampleFramePacer()
+{
+#if XII_ENABLED(XII_PLATFORM_WINDOWS)
+  if (m_pTimer != nullptr)
+  {
+    CloseHandle(m_pTimer);
+  }
+#endif
+}
+
+void xiiSampleFramePacer::Configure(xiiUInt32 uiTargetFps, bool bIdleMode)
+{
+  m_FrameTime = uiTargetFps > 0 ? xiiTime::Seconds(1.0 / uiTargetFps) : xiiTime();
+  m_bIdleMode = bIdleMode;
+  m_NextFrame = xiiTime::Now();
+
+  m_StartTime    = m_NextFrame;
+  m_StartCpuTime = GetProcessCpuTime();
+  m_uiFrames     = 0;
+  m_uiIdleFrames = 0;
+  m_SleepTime    = xiiTime();
+  m_SpinTime     = xiiTime();
+  m_IdleTime     = xiiTime();
+}
+
+void xiiSampleFramePacer::WaitForNextFrame(bool bIdle)
+{
+  ++m_uiFrames;
+
+  if (!m_FrameTime.IsZero())
+  {
+    m_NextFrame += m_FrameTime;
+
+    // A frame that took longer than a frame time is not made up for by starting the next ones early
+    const xiiTime now = xiiTime::Now();
+    if (m_NextFrame < now)
+    {
+      m_NextFrame = now;
+    }
+
+    // Even while idle, a burst of messages must not start frames faster than the target frame rate
+    WaitUntil(m_NextFrame);
+  }
+
+  if (m_bIdleMode && bIdle)
+  {
+    ++m_uiIdleFrames;
+    WaitForMessages();
+
+    // Whatever ended the wait is handled right away, the frame time counts from there
+    m_NextFrame = xiiTime::Now();
+  }
+}
+
+void xiiSampleFramePacer::WaitUntil(xiiTime nextFrame)
+{
+  // The spin covers a late wake-up, but it never takes up a large part of the frame
+  const xiiTime spinTime = xiiMath::Min(m_SleepLateness, xiiTime::Milliseconds(MaxSpinMilliseconds));
+
+  xiiTime now    = xiiTime::Now();
+  bool    bSlept = false;
+
+  while (nextFrame - now > spinTime)
+  {
+    const xiiTime requested = nextFrame - now - spinTime;
+    SleepFor(requested);
+
+    const xiiTime sleepStart = now;
+    now                      = xiiTime::Now();
+
+    const xiiTime slept = now - sleepStart;
+    m_SleepTime += slept;
+    bSlept = true;
+
+    // A late wake-up counts right away, after that the estimate only slowly goes down again
+    const xiiTime lateness = xiiMath::Max(slept - requested, xiiTime());
+    m_SleepLateness        = lateness > m_SleepLateness ? lateness : m_SleepLateness * 0.99 + lateness * 0.01;
+  }
+
+  // Frames that didn't sleep, e.g. because they took too long, tell nothing about the OS, so the estimate shouldn't
+  // stay at some outlier for good
+  if (!bSlept)
+  {
+    m_SleepLateness = m_SleepLateness * 0.9;
+  }
+
+  m_SleepLateness = xiiMath::Min(m_SleepLateness, m_FrameTime * 0.5);
+
+  const xiiTime spinStart = now;
+  while (now < nextFrame)
+  {
+    now = xiiTime::Now();
+  }
+
+  m_SpinTime += now - spinStart;
+}
+
+void xiiSampleFramePacer::SleepFor(xiiTime duration)
+{
+#if XII_ENABLED(XII_PLATFORM_WINDOWS)
+  if (m_pTimer != nullptr)
+  {
+    // Negative times are relative, in units of 100 ns
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -xiiMath::Max(static_cast<LONGLONG>(duration.GetNanoseconds() / 100.0), static_cast<LONGLONG>(1));
+
+    if (SetWaitableTimerEx(m_pTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+    {
+      WaitForSingleObject(m_pTimer, INFINITE);
+      return;
+    }
+  }
+#endif
+
+  xiiThreadUtils::Sleep(duration);
+}
+
+void xiiSampleFramePacer::WaitForMessages()
+{
+  const xiiTime waitStart = xiiTime::Now();
+
+#if XII_ENABLED(XII_PLATFORM_WINDOWS_DESKTOP)
+  // The window was created by this thread, so its messages arrive in the queue of this thread. Messages that are
+  // already in the queue end the wait right away, even if something has looked at them without removing them.
+  MsgWaitForMultipleObjectsEx(0, nullptr, static_cast<DWORD>(IdleTimeoutMilliseconds), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+#else
+  // There is nothing to wait on here, see IdleFallbackMilliseconds
+  xiiThreadUtils::Sleep(xiiTime::Milliseconds(IdleFallbackMilliseconds));
+#endif
+
+  m_IdleTime += xiiTime::Now() - waitStart;
+}
+
+void xiiSampleFramePacer::LogStats() const
+{
+  const double fWallSeconds = xiiMath::Max((xiiTime::Now() - m_StartTime).GetSeconds(), 0.001);
+  const double fCpuSeconds  = (GetProcessCpuTime() - m_StartCpuTime).GetSeconds();
+
+  xiiLog::Info("Frames: {0} ({1} idle) in {2} sec, {3} per sec", m_uiFrames, m_uiIdleFrames, xiiArgF(fWallSeconds, 2), xiiArgF(m_uiFrames / fWallSeconds, 1));
+  xiiLog::Info("CPU Time: {0} sec, {1}% of one core", xiiArgF(fCpuSeconds, 2), xiiArgF(fCpuSeconds / fWallSeconds * 100.0, 1));
+  xiiLog::Info("Waiting: {0} sec sleeping, {1} sec spinning, {2} sec idle", xiiArgF(m_SleepTime.GetSeconds(), 2), xiiArgF(m_SpinTime.GetSeconds(), 2), xiiArgF(m_IdleTime.GetSeconds(), 2));
+}
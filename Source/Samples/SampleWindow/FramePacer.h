@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Foundation/Time/Time.h>
+
+// Paces the frames of the sample, so that it doesn't keep a core busy while it has nothing to do.
+//
+// With a target frame rate, every frame starts one frame time after the previous one. The wait sleeps for most of that
+// time and only spins for the rest, since the OS may wake a sleeping thread later than requested. How much later is
+// measured while it runs, so the spinning stays as short as the OS allows, but never longer than MaxSpinMilliseconds.
+// If the OS oversleeps by more than that, the frame starts a little late instead of keeping the core busy. On Windows,
+// the sleeps use a high-resolution timer, otherwise they would only end at the next 15.6 ms timer tick.
+//
+// In idle mode, frames in which nothing is going on additionally wait for the next window message, at most for
+// IdleTimeoutMilliseconds. Only Windows lets the sample wait for the messages of its window. Elsewhere the window
+// doesn't expose anything to wait on, so the pacer sleeps for IdleFallbackMilliseconds instead, and the first input
+// after idling can take that long to show up.
+class xiiSampleFramePacer
+{
+public:
+  // The longest wait while idle, so that everything that is updated per frame still gets updated regularly
+  static constexpr double IdleTimeoutMilliseconds = 50.0;
+
+  // The wait while idle on platforms where the pacer can't wait for window messages
+  static constexpr double IdleFallbackMilliseconds = 10.0;
+
+  // The longest that a frame spins after sleeping
+  static constexpr double MaxSpinMilliseconds = 2.0;
+
+  xiiSampleFramePacer();
+  ~xiiSampleFramePacer();
+
+  // A target frame rate of zero doesn't limit the frame rate
+  void Configure(xiiUInt32 uiTargetFps, bool bIdleMode);
+
+  // Waits until the next frame should start, called once per frame. bIdle tells whether anything is going on in the
+  // frame that just ended, only then the idle mode waits for messages.
+  void WaitForNextFrame(bool bIdle);
+
+  // Logs how many frames there were, how long the process kept the CPU busy meanwhile and how the rest of the time was
+  // spent waiting
+  void LogStats() const;
+
+private:
+  void WaitUntil(xiiTime nextFrame);
+  void SleepFor(xiiTime duration);
+  void WaitForMessages();
+
+  xiiTime m_FrameTime;
+  bool    m_bIdleMode = false;
+
+  xiiTime m_NextFrame;
+  xiiTime m_SleepLateness = xiiTime::Milliseconds(1); // How much later than requested a sleep ends, at most
+  void*   m_pTimer        = nullptr;                  // The high-resolution timer on Windows
+
+  // Counters, from Configure() on
+  xiiTime   m_StartTime;
+  xiiTime   m_StartCpuTime;
+  xiiUInt64 m_uiFrames     = 0;
+  xiiUInt64 m_uiIdleFrames = 0;
+  xiiTime   m_SleepTime;
+  xiiTime   m_SpinTime;
+  xiiTime   m_IdleTime;
+};
@@ -1,4 +1,5 @@
 #include <SampleWindow/SampleWindow.h>
+#include <SampleShared/SampleInput.h>
 
 #include <Core/Graphics/Camera.h>
 #include <Core/Graphics/Geometry.h>
@@ -13,11 +14,56 @@
 #include <Foundation/Logging/Log.h>
 #include <Foundation/Logging/VisualStudioWriter.h>
 #include <Foundation/Time/Clock.h>
+#include <Foundation/Utilities/CommandLineUtils.h>
 
 static xiiUInt32 g_uiWindowWidth  = 960;
 static xiiUInt32 g_uiWindowHeight = 540;
 static bool      g_bWindowResized = false;
 
+static xiiSampleInput<xiiSampleCameraAction::Count> g_Input("Main", g_SampleCameraActions);
+
+// Measures the input queries of a frame with mouse look engaged, once the way Run() wrote them out before xiiSampleInput,
+// with a lookup by input set and name for every query, and once through xiiSampleInput. Both make the same lookups, so
+// this shows what the shared code costs on top of them. The input manager isn't updated in between, so this is only the
+// cost of the queries.
+static void RunInputBenchmark(xiiUInt32 uiFrames)
+{
+  float fSum = 0.0f;
+
+  const xiiTime byNameStart = xiiTime::Now();
+  for (xiiUInt32 uiFrame = 0; uiFrame < uiFrames; ++uiFrame)
+  {
+    float fValue = 0.0f;
+    fSum += xiiInputManager::GetInputActionState("Main", "CloseApp") == xiiKeyState::Pressed ? 1.0f : 0.0f;
+    fSum += xiiInputManager::GetInputActionState("Main", "Look") == xiiKeyState::Down ? 1.0f : 0.0f;
+
+    for (const char* szAction : {"LookPosX", "LookNegX", "LookPosY", "LookNegY", "TurnPosX", "TurnNegX", "TurnPosY", "TurnNegY", "MovePosX", "MoveNegX", "MovePosY", "MoveNegY"})
+    {
+      if (xiiInputManager::GetInputActionState("Main", szAction, &fValue) != xiiKeyState::Up)
+        fSum += fValue;
+    }
+  }
+  const xiiTime byNameTime = xiiTime::Now() - byNameStart;
+
+  xiiSampleInput<xiiSampleCameraAction::Count> input("Main", g_SampleCameraActions);
+
+  const xiiTime sampleInputStart = xiiTime::Now();
+  for (xiiUInt32 uiFrame = 0; uiFrame < uiFrames; ++uiFrame)
+  {
+    fSum += input.GetState(xiiSampleCameraAction::CloseApp) == xiiKeyState::Pressed ? 1.0f : 0.0f;
+    input.BeginFrame();
+    fSum += input.GetState(xiiSampleCameraAction::Look) == xiiKeyState::Down ? 1.0f : 0.0f;
+
+    for (xiiUInt32 i = xiiSampleCameraAction::LookPosX; i < xiiSampleCameraAction::Count; ++i)
+    {
+      fSum += input.GetValue(i);
+    }
+  }
+  const xiiTime sampleInputTime = xiiTime::Now() - sampleInputStart;
+
+  xiiLog::Info("Input benchmark: {0} frames, by name {1} ns per frame, xiiSampleInput {2} ns per frame (checksum {3})", uiFrames, xiiArgF(byNameTime.GetNanoseconds() / uiFrames, 1), xiiArgF(sampleInputTime.GetNanoseconds() / uiFrames, 1), fSum);
+}
+
 class xiiSampleWindow : public xiiWindow
 {
 public:
@@ -56,7 +102,8 @@ xiiApplication::Execution xiiSampleWindowApp::Run()
     g_bWindowResized = false;
   }
 
-  if (m_pWindow->m_bCloseRequested || xiiInputManager::GetInputActionState("Main", "CloseApp") == xiiKeyState::Pressed)
+  // The states are from the last frame, since the input is only updated below
+  if (m_pWindow->m_bCloseRequested || g_Input.GetState(xiiSampleCameraAction::CloseApp) == xiiKeyState::Pressed)
     return Execution::Quit;
 
   // Make sure time goes on
@@ -64,26 +111,22 @@ xiiApplication::Execution xiiSampleWindowApp::Run()
 
   // Update all input state
   xiiInputManager::Update(xiiClock::GetGlobalClock()->GetTimeDiff());
+  g_Input.BeginFrame();
 
   // Engage mouse look
-  if (xiiInputManager::GetInputActionState("Main", "Look") == xiiKeyState::Down)
+  if (g_Input.GetState(xiiSampleCameraAction::Look) == xiiKeyState::Down)
   {
     m_pWindow->GetInputDevice()->SetShowMouseCursor(false);
     m_pWindow->GetInputDevice()->SetClipMouseCursor(xiiMouseCursorClipMode::ClipToPosition);
 
-    float       fInputValue = 0.0f;
     const float fMouseSpeed = 0.01f;
 
     xiiVec3 mouseMotion(0.0f);
 
-    if (xiiInputManager::GetInputActionState("Main", "LookPosX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x += fInputValue * fMouseSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "LookNegX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x -= fInputValue * fMouseSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "LookPosY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y -= fInputValue * fMouseSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "LookNegY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y += fInputValue * fMouseSpeed;
+    mouseMotion.x += g_Input.GetValue(xiiSampleCameraAction::LookPosX) * fMouseSpeed;
+    mouseMotion.x -= g_Input.GetValue(xiiSampleCameraAction::LookNegX) * fMouseSpeed;
+    mouseMotion.y -= g_Input.GetValue(xiiSampleCameraAction::LookPosY) * fMouseSpeed;
+    mouseMotion.y += g_Input.GetValue(xiiSampleCameraAction::LookNegY) * fMouseSpeed;
   }
   else
   {
@@ -93,34 +136,24 @@ xiiApplication::Execution xiiSampleWindowApp::Run()
 
   // Turn camera with arrow keys
   {
-    float       fInputValue = 0.0f;
-    const float fTurnSpeed  = 1.0f;
+    const float fTurnSpeed = 1.0f;
 
     xiiVec3 mouseMotion(0.0f);
 
-    if (xiiInputManager::GetInputActionState("Main", "TurnPosX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x += fInputValue * fTurnSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "TurnNegX", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.x -= fInputValue * fTurnSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "TurnPosY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y += fInputValue * fTurnSpeed;
-    if (xiiInputManager::GetInputActionState("Main", "TurnNegY", &fInputValue) != xiiKeyState::Up)
-      mouseMotion.y -= fInputValue * fTurnSpeed;
+    mouseMotion.x += g_Input.GetValue(xiiSampleCameraAction::TurnPosX) * fTurnSpeed;
+    mouseMotion.x -= g_Input.GetValue(xiiSampleCameraAction::TurnNegX) * fTurnSpeed;
+    mouseMotion.y += g_Input.GetValue(xiiSampleCameraAction::TurnPosY) * fTurnSpeed;
+    mouseMotion.y -= g_Input.GetValue(xiiSampleCameraAction::TurnNegY) * fTurnSpeed;
   }
 
   // Apply translation
   {
-    float   fInputValue = 0.0f;
     xiiVec3 cameraMotion(0.0f);
 
-    if (xiiInputManager::GetInputActionState("Main", "MovePosX", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.x += fInputValue;
-    if (xiiInputManager::GetInputActionState("Main", "MoveNegX", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.x -= fInputValue;
-    if (xiiInputManager::GetInputActionState("Main", "MovePosY", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.y += fInputValue;
-    if (xiiInputManager::GetInputActionState("Main", "MoveNegY", &fInputValue) != xiiKeyState::Up)
-      cameraMotion.y -= fInputValue;
+    cameraMotion.x += g_Input.GetValue(xiiSampleCameraAction::MovePosX);
+    cameraMotion.x -= g_Input.GetValue(xiiSampleCameraAction::MoveNegX);
+    cameraMotion.y += g_Input.GetValue(xiiSampleCameraAction::MovePosY);
+    cameraMotion.y -= g_Input.GetValue(xiiSampleCameraAction::MoveNegY);
   }
 
   // Make sure telemetry is sent out regularly.
@@ -134,6 +167,9 @@ xiiApplication::Execution xiiSampleWindowApp::Run()
   // uploading GPU data etc.
   xiiTaskSystem::FinishFrameTasks();
 
+  // Nothing moves in this sample unless there is input, so it is idle whenever no action is active
+  m_FramePacer.WaitForNextFrame(!g_Input.IsAnyActive());
+
   return xiiApplication::Execution::Continue;
 }
 
@@ -163,78 +199,13 @@ void xiiSampleWindowApp::AfterCoreSystemsStartup()
   xiiPlugin::LoadPlugin("xiiInspectorPlugin").IgnoreResult();
 #endif
 
-  // Register Input
+  g_Input.RegisterActions();
+
+  // Pass '-inputbenchmark <frames>' to compare what querying the input actions costs per frame, by name and through xiiSampleInput
+  const xiiInt32 iBenchmarkFrames = xiiCommandLineUtils::GetGlobalInstance()->GetIntOption("-inputbenchmark", 0);
+  if (iBenchmarkFrames > 0)
   {
-    xiiInputActionConfig cfg;
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "CloseApp");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyEscape;
-    xiiInputManager::SetInputActionConfig("Main", "CloseApp", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookPosX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMovePosX;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookPosX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookNegX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMoveNegX;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookNegX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookPosY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMovePosY;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookPosY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "LookNegY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMoveNegY;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "LookNegY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnPosX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyRight;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnPosX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnNegX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyLeft;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnNegX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnPosY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyDown;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnPosY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "TurnNegY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyUp;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "TurnNegY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "Look");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseButton0;
-    cfg.m_bApplyTimeScaling    = false;
-    xiiInputManager::SetInputActionConfig("Main", "Look", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MovePosX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyD;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MovePosX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MoveNegX");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyA;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MoveNegX", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MovePosY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyW;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MovePosY", cfg, true);
-
-    cfg                        = xiiInputManager::GetInputActionConfig("Main", "MoveNegY");
-    cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyS;
-    cfg.m_bApplyTimeScaling    = true;
-    xiiInputManager::SetInputActionConfig("Main", "MoveNegY", cfg, true);
+    RunInputBenchmark(static_cast<xiiUInt32>(iBenchmarkFrames));
   }
 
   // Create a window for rendering
@@ -252,6 +223,14 @@ void xiiSampleWindowApp::AfterCoreSystemsStartup()
 
   // Now that we have a window and device, tell the engine to initialize the rendering infrastructure
   xiiStartup::StartupHighLevelSystems();
+
+  // Limit the frame rate, 0 for no limit, and with -idle wait for input while there is nothing to do
+  {
+    const xiiInt32 iTargetFps = xiiCommandLineUtils::GetGlobalInstance()->GetIntOption("-fps", 60);
+    const bool     bIdleMode  = xiiCommandLineUtils::GetGlobalInstance()->GetBoolOption("-idle");
+
+    m_FramePacer.Configure(static_cast<xiiUInt32>(xiiMath::Max(iTargetFps, 0)), bIdleMode);
+  }
 }
 
 void xiiSampleWindowApp::BeforeCoreSystemsShutdown()
@@ -266,6 +245,8 @@ void xiiSampleWindowApp::BeforeCoreSystemsShutdown()
 
 void xiiSampleWindowApp::BeforeHighLevelSystemsShutdown()
 {
+  m_FramePacer.LogStats();
+
   // Tell the engine that we are about to destroy window and graphics device,
   // and that it therefore needs to cleanup anything that depends on that
   xiiStartup::ShutdownHighLevelSystems();
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <SampleWindow/FramePacer.h>
+
 #include <Foundation/Application/Application.h>
 #include <Foundation/Types/UniquePtr.h>
 
@@ -22,5 +24,6 @@ public:
   virtual void BeforeCoreSystemsShutdown() override;
 
 private:
-  xiiSampleWindow* m_pWindow = nullptr;
+  xiiSampleWindow*    m_pWindow = nullptr;
+  xiiSampleFramePacer m_FramePacer;
 };
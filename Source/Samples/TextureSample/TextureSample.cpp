@@ -18,6 +18,8 @@
 #include <Core/ResourceManager/ResourceManager.h>
 #include <Core/System/Window.h>
 
+#include <SampleShared/SampleInput.h>
+
 #include <GraphicsFoundation/Device/Device.h>
 #include <GraphicsFoundation/Device/DeviceFactory.h>
 #include <GraphicsFoundation/Device/SwapChain.h>
@@ -37,6 +39,32 @@ static xiiUInt32 g_uiWindowWidth  = 960;
 static xiiUInt32 g_uiWindowHeight = 540;
 static bool      g_bWindowResized = false;
 
+// The input actions of the sample, in the order of g_InputActions
+struct xiiSampleInputAction
+{
+  enum Enum : xiiUInt8
+  {
+    CloseApp,
+    MouseDown,
+    MovePosX,
+    MoveNegX,
+    MovePosY,
+    MoveNegY,
+    Count
+  };
+};
+
+static const xiiSampleInputActionDesc g_InputActions[xiiSampleInputAction::Count] = {
+  {"CloseApp", xiiInputSlot_KeyEscape, true},
+  {"MouseDown", xiiInputSlot_MouseButton0, false},
+  {"MovePosX", xiiInputSlot_MouseMovePosX, false},
+  {"MoveNegX", xiiInputSlot_MouseMoveNegX, false},
+  {"MovePosY", xiiInputSlot_MouseMovePosY, false},
+  {"MoveNegY", xiiInputSlot_MouseMoveNegY, false},
+};
+
+static xiiSampleInput<xiiSampleInputAction::Count> g_Input("Main", g_InputActions);
+
 class xiiTextureSample : public xiiWindow
 {
 public:
@@ -93,7 +121,8 @@ public:
       UpdateSwapChain();
     }
 
-    if (m_pWindow->m_bCloseRequested || xiiInputManager::GetInputActionState("Main", "CloseApp") == xiiKeyState::Pressed)
+    // The states are from the last frame, since the input is only updated below
+    if (m_pWindow->m_bCloseRequested || g_Input.GetState(xiiSampleInputAction::CloseApp) == xiiKeyState::Pressed)
       return Execution::Quit;
 
     // Make sure time goes on
@@ -101,24 +130,20 @@ public:
 
     // Update all input state
     xiiInputManager::Update(xiiClock::GetGlobalClock()->GetTimeDiff());
+    g_Input.BeginFrame();
 
     // Engage mouse look
-    if (xiiInputManager::GetInputActionState("Main", "MouseDown") == xiiKeyState::Down)
+    if (g_Input.GetState(xiiSampleInputAction::MouseDown) == xiiKeyState::Down)
     {
       m_pWindow->GetInputDevice()->SetShowMouseCursor(false);
       m_pWindow->GetInputDevice()->SetClipMouseCursor(xiiMouseCursorClipMode::ClipToPosition);
 
-      float       fInputValue = 0.0f;
       const float fMouseSpeed = 0.5f;
 
-      if (xiiInputManager::GetInputActionState("Main", "MovePosX", &fInputValue) != xiiKeyState::Up)
-        m_vCameraPosition.x -= fInputValue * fMouseSpeed;
-      if (xiiInputManager::GetInputActionState("Main", "MoveNegX", &fInputValue) != xiiKeyState::Up)
-        m_vCameraPosition.x += fInputValue * fMouseSpeed;
-      if (xiiInputManager::GetInputActionState("Main", "MovePosY", &fInputValue) != xiiKeyState::Up)
-        m_vCameraPosition.y += fInputValue * fMouseSpeed;
-      if (xiiInputManager::GetInputActionState("Main", "MoveNegY", &fInputValue) != xiiKeyState::Up)
-        m_vCameraPosition.y -= fInputValue * fMouseSpeed;
+      m_vCameraPosition.x -= g_Input.GetValue(xiiSampleInputAction::MovePosX) * fMouseSpeed;
+      m_vCameraPosition.x += g_Input.GetValue(xiiSampleInputAction::MoveNegX) * fMouseSpeed;
+      m_vCameraPosition.y += g_Input.GetValue(xiiSampleInputAction::MovePosY) * fMouseSpeed;
+      m_vCameraPosition.y -= g_Input.GetValue(xiiSampleInputAction::MoveNegY) * fMouseSpeed;
     }
     else
     {
@@ -293,39 +318,7 @@ public:
     constexpr const char* szDefaultGraphicsAPI = "Null";
 #endif
 
-    // Register Input
-    {
-      xiiInputActionConfig cfg;
-
-      cfg                        = xiiInputManager::GetInputActionConfig("Main", "CloseApp");
-      cfg.m_sInputSlotTrigger[0] = xiiInputSlot_KeyEscape;
-      xiiInputManager::SetInputActionConfig("Main", "CloseApp", cfg, true);
-
-      cfg                        = xiiInputManager::GetInputActionConfig("Main", "MovePosX");
-      cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMovePosX;
-      cfg.m_bApplyTimeScaling    = false;
-      xiiInputManager::SetInputActionConfig("Main", "MovePosX", cfg, true);
-
-      cfg                        = xiiInputManager::GetInputActionConfig("Main", "MoveNegX");
-      cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMoveNegX;
-      cfg.m_bApplyTimeScaling    = false;
-      xiiInputManager::SetInputActionConfig("Main", "MoveNegX", cfg, true);
-
-      cfg                        = xiiInputManager::GetInputActionConfig("Main", "MovePosY");
-      cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMovePosY;
-      cfg.m_bApplyTimeScaling    = false;
-      xiiInputManager::SetInputActionConfig("Main", "MovePosY", cfg, true);
-
-      cfg                        = xiiInputManager::GetInputActionConfig("Main", "MoveNegY");
-      cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseMoveNegY;
-      cfg.m_bApplyTimeScaling    = false;
-      xiiInputManager::SetInputActionConfig("Main", "MoveNegY", cfg, true);
-
-      cfg                        = xiiInputManager::GetInputActionConfig("Main", "MouseDown");
-      cfg.m_sInputSlotTrigger[0] = xiiInputSlot_MouseButton0;
-      cfg.m_bApplyTimeScaling    = false;
-      xiiInputManager::SetInputActionConfig("Main", "MouseDown", cfg, true);
-    }
+    g_Input.RegisterActions();
 
     // Create a window for rendering
     {